@@ -14,6 +14,9 @@ sub debugf {
     printf @_ if $debug;
 }
 
+# directory where sliced layers are cached across runs (see Slic3r::Print::Object)
+our $slice_cache_dir;
+
 # load threads before Moo as required by it
 our $have_threads;
 BEGIN {
@@ -54,6 +57,7 @@ use Slic3r::GCode::Layer;
 use Slic3r::GCode::MotionPlanner;
 use Slic3r::GCode::Reader;
 use Slic3r::GCode::SpiralVase;
+use Slic3r::GCode::StreamWriter;
 use Slic3r::GCode::VibrationLimit;
 use Slic3r::Geometry qw(PI);
 use Slic3r::Geometry::Clipper;
@@ -66,6 +70,7 @@ use Slic3r::Polygon;
 use Slic3r::Polyline;
 use Slic3r::Print;
 use Slic3r::Print::Object;
+use Slic3r::Print::Profiler;
 use Slic3r::Print::Region;
 use Slic3r::Print::Simple;
 use Slic3r::Print::SupportMaterial;
@@ -130,6 +135,7 @@ sub parallelize {
 sub thread_cleanup {
     # prevent destruction of shared objects
     no warnings 'redefine';
+    *Slic3r::BridgeDetector::DESTROY        = sub {};
     *Slic3r::Config::DESTROY                = sub {};
     *Slic3r::Config::Full::DESTROY          = sub {};
     *Slic3r::Config::Print::DESTROY         = sub {};
@@ -141,18 +147,31 @@ sub thread_cleanup {
     *Slic3r::ExtrusionPath::DESTROY         = sub {};
     *Slic3r::ExtrusionPath::Collection::DESTROY = sub {};
     *Slic3r::Flow::DESTROY                  = sub {};
+    *Slic3r::GCode::TimeEstimator::DESTROY  = sub {};
+    *Slic3r::Geometry::Arranger::DESTROY    = sub {};
     *Slic3r::Geometry::BoundingBox::DESTROY = sub {};
     *Slic3r::Geometry::BoundingBoxf3::DESTROY = sub {};
     *Slic3r::Line::DESTROY                  = sub {};
     *Slic3r::Point::DESTROY                 = sub {};
     *Slic3r::Pointf3::DESTROY               = sub {};
     *Slic3r::Polygon::DESTROY               = sub {};
+    *Slic3r::Polygon::Collection::DESTROY   = sub {};
     *Slic3r::Polyline::DESTROY              = sub {};
     *Slic3r::Polyline::Collection::DESTROY  = sub {};
+    *Slic3r::Print::Object::HorizontalShells::DESTROY = sub {};
+    *Slic3r::Print::Object::InfillCombiner::DESTROY = sub {};
+    *Slic3r::Print::Object::Native::DESTROY = sub {};
+    *Slic3r::Profiler::Counts::DESTROY      = sub {};
+    *Slic3r::Profiler::Sample::DESTROY      = sub {};
     *Slic3r::Print::State::DESTROY          = sub {};
+    *Slic3r::Print::SkirtBrim::DESTROY      = sub {};
+    *Slic3r::Print::SupportMaterial::Generator::DESTROY = sub {};
+    *Slic3r::Print::SupportMaterial::ContactDetector::DESTROY = sub {};
     *Slic3r::Surface::DESTROY               = sub {};
     *Slic3r::Surface::Collection::DESTROY   = sub {};
+    *Slic3r::ThreadPool::DESTROY            = sub {};
     *Slic3r::TriangleMesh::DESTROY          = sub {};
+    *Slic3r::TriangleMesh::View::DESTROY    = sub {};
     return undef;  # this prevents a "Scalars leaked" warning
 }
 
@@ -20,6 +20,7 @@ has 'region'             => (is => 'rw');
 has '_layer_islands'     => (is => 'rw');
 has '_upper_layer_islands'  => (is => 'rw');
 has '_layer_overhangs'   => (is => 'ro', default => sub { Slic3r::ExPolygon::Collection->new });
+has 'seams'              => (is => 'rw');  # Slic3r::GCode::Seams computed in advance for the upcoming layers
 has 'shift_x'            => (is => 'rw', default => sub {0} );
 has 'shift_y'            => (is => 'rw', default => sub {0} );
 has 'z'                  => (is => 'rw');
@@ -33,7 +34,6 @@ has 'external_mp'        => (is => 'rw');
 has 'layer_mp'           => (is => 'rw');
 has 'new_object'         => (is => 'rw', default => sub {0});
 has 'straight_once'      => (is => 'rw', default => sub {1});
-has 'elapsed_time'       => (is => 'rw', default => sub {0} );  # seconds
 has 'lifted'             => (is => 'rw', default => sub {0} );
 has 'last_pos'           => (is => 'rw', default => sub { Slic3r::Point->new(0,0) } );
 has 'last_speed'         => (is => 'rw', default => sub {""});
@@ -192,27 +192,32 @@ sub extrude_loop {
     my $was_clockwise = $loop->make_counter_clockwise;
     my $polygon = $loop->polygon;
     
-    # find candidate starting points
-    # start looking for concave vertices not being overhangs
-    my @concave = ();
-    if ($self->print_config->start_perimeters_at_concave_points) {
-        @concave = $polygon->concave_points;
-    }
+    # find candidate starting points, unless they were computed in advance
+    # with the rest of the layer (they don't depend on the extruder position)
     my @candidates = ();
-    if ($self->print_config->start_perimeters_at_non_overhang) {
-        @candidates = grep !$self->_layer_overhangs->contains_point($_), @concave;
-    }
-    if (!@candidates) {
-        # if none, look for any concave vertex
-        @candidates = @concave;
+    if (my $seam_candidates = defined $self->seams && $self->seams->candidates($loop)) {
+        @candidates = @$seam_candidates;
+    } else {
+        # start looking for concave vertices not being overhangs
+        my @concave = ();
+        if ($self->print_config->start_perimeters_at_concave_points) {
+            @concave = $polygon->concave_points;
+        }
+        if ($self->print_config->start_perimeters_at_non_overhang) {
+            @candidates = grep !$self->_layer_overhangs->contains_point($_), @concave;
+        }
         if (!@candidates) {
-            # if none, look for any non-overhang vertex
-            if ($self->print_config->start_perimeters_at_non_overhang) {
-                @candidates = grep !$self->_layer_overhangs->contains_point($_), @$polygon;
-            }
+            # if none, look for any concave vertex
+            @candidates = @concave;
             if (!@candidates) {
-                # if none, all points are valid candidates
-                @candidates = @{$polygon};
+                # if none, look for any non-overhang vertex
+                if ($self->print_config->start_perimeters_at_non_overhang) {
+                    @candidates = grep !$self->_layer_overhangs->contains_point($_), @$polygon;
+                }
+                if (!@candidates) {
+                    # if none, all points are valid candidates
+                    @candidates = @{$polygon};
+                }
             }
         }
     }
@@ -335,11 +340,10 @@ sub extrude_path {
     
     # extrude arc or line
     $gcode .= ";_BRIDGE_FAN_START\n" if $path->is_bridge;
-    my $path_length = 0;
     {
         my $local_F = $F;
         foreach my $line (@{$path->lines}) {
-            $path_length += my $line_length = unscale $line->length;
+            my $line_length = unscale $line->length;
             
             # calculate extrusion length for this line
             my $E = 0;
@@ -369,11 +373,6 @@ sub extrude_path {
     $gcode .= ";_BRIDGE_FAN_END\n" if $path->is_bridge;
     $self->last_pos($path->last_point);
     
-    if ($self->print_config->cooling) {
-        my $path_time = $path_length / $F * 60;
-        $self->elapsed_time($self->elapsed_time + $path_time);
-    }
-    
     # reset acceleration
     $gcode .= $self->set_acceleration($self->print_config->default_acceleration)
         if $acceleration && $self->print_config->default_acceleration;
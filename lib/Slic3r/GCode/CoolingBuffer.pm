@@ -3,12 +3,22 @@ use Moo;
 
 has 'config'    => (is => 'ro', required => 1);  # Slic3r::Config::Print
 has 'gcodegen'  => (is => 'ro', required => 1);
-has 'gcode'     => (is => 'rw', default => sub {""});
-has 'elapsed_time' => (is => 'rw', default => sub {0});
+has 'estimator' => (is => 'lazy');  # Slic3r::GCode::TimeEstimator holding the buffered G-code
 has 'layer_id'  => (is => 'rw');
 has 'last_z'    => (is => 'rw', default => sub { {} });  # obj_id => z (basically a 'last seen' table)
+has 'layer_times' => (is => 'ro', default => sub { [] });  # [ layer_id, seconds ] for each flushed layer
 has 'min_print_speed' => (is => 'lazy');
 
+sub _build_estimator {
+    my $self = shift;
+    
+    my $estimator = Slic3r::GCode::TimeEstimator->new;
+    $estimator->set_default_acceleration($self->config->default_acceleration);
+    $estimator->set_extrusion_axis($self->config->get_extrusion_axis);
+    $estimator->set_relative_e($self->config->use_relative_e_distances);
+    return $estimator;
+}
+
 sub _build_min_print_speed {
     my $self = shift;
     return 60 * $self->config->min_print_speed;
@@ -25,9 +35,7 @@ sub append {
     
     $self->layer_id($layer_id);
     $self->last_z->{$obj_id} = $print_z;
-    $self->gcode($self->gcode . $gcode);
-    $self->elapsed_time($self->elapsed_time + $self->gcodegen->elapsed_time);
-    $self->gcodegen->elapsed_time(0);
+    $self->estimator->append($gcode);
     
     return $return;
 }
@@ -35,10 +43,7 @@ sub append {
 sub flush {
     my $self = shift;
     
-    my $gcode = $self->gcode;
-    my $elapsed = $self->elapsed_time;
-    $self->gcode("");
-    $self->elapsed_time(0);
+    my $elapsed = $self->estimator->time;
     $self->last_z({});  # reset the whole table otherwise we would compute overlapping times
     
     my $fan_speed = $self->config->fan_always_on ? $self->config->min_fan_speed : 0;
@@ -55,26 +60,23 @@ sub flush {
         }
         Slic3r::debugf "  fan = %d%%, speed = %d%%\n", $fan_speed, $speed_factor * 100;
         
-        if ($speed_factor < 1) {
-            $gcode =~ s/^(?=.*? [XY])(?=.*? E)(?!;_WIPE)(?<!;_BRIDGE_FAN_START\n)(G1 .*?F)(\d+(?:\.\d+)?)/
-                my $new_speed = $2 * $speed_factor;
-                $1 . sprintf("%.3f", $new_speed < $self->min_print_speed ? $self->min_print_speed : $new_speed)
-                /gexm;
-        }
+        # rewrite the feedrate of the buffered extrusion moves in place
+        $self->estimator->slow_down($speed_factor, $self->min_print_speed)
+            if $speed_factor < 1;
     }
     $fan_speed = 0 if $self->layer_id < $self->config->disable_fan_first_layers;
-    $gcode = $self->gcodegen->set_fan($fan_speed) . $gcode;
+    push @{$self->layer_times}, [ $self->layer_id, $self->estimator->time ]
+        if defined $self->layer_id;
+    my $gcode = $self->gcodegen->set_fan($fan_speed);
     
     # bridge fan speed
-    if (!$self->config->cooling || $self->config->bridge_fan_speed == 0 || $self->layer_id < $self->config->disable_fan_first_layers) {
-        $gcode =~ s/^;_BRIDGE_FAN_(?:START|END)\n//gm;
-    } else {
-        $gcode =~ s/^;_BRIDGE_FAN_START\n/ $self->gcodegen->set_fan($self->config->bridge_fan_speed, 1) /gmex;
-        $gcode =~ s/^;_BRIDGE_FAN_END\n/ $self->gcodegen->set_fan($fan_speed, 1) /gmex;
+    my ($bridge_fan_start, $bridge_fan_end) = ("", "");
+    if ($self->config->cooling && $self->config->bridge_fan_speed > 0 && $self->layer_id >= $self->config->disable_fan_first_layers) {
+        $bridge_fan_start   = $self->gcodegen->set_fan($self->config->bridge_fan_speed, 1);
+        $bridge_fan_end     = $self->gcodegen->set_fan($fan_speed, 1);
     }
-    $gcode =~ s/;_WIPE//g;
     
-    return $gcode;
+    return $gcode . $self->estimator->flush($bridge_fan_start, $bridge_fan_end);
 }
 
 1;
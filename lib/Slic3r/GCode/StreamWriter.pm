@@ -0,0 +1,198 @@
+package Slic3r::GCode::StreamWriter;
+use strict;
+use warnings;
+
+# A filehandle (to be used with tie) which collects the G-code in fixed-size
+# chunks and writes them out as soon as they are full, optionally gzip'ing
+# them on the fly. When threads are available and the output doesn't fit in
+# a single chunk, the chunks are written by a background thread so that G-code
+# generation doesn't wait for the disk; at most QUEUE_SIZE chunks are ever
+# waiting, so memory usage doesn't depend on the size of the print.
+# Write errors are fatal: PRINT dies as soon as one is detected and CLOSE dies
+# if the file could not be completely written.
+#
+#   my $fh = Slic3r::GCode::StreamWriter->open(file => $file, threads => 2);
+#   print $fh "G1 X10\n";
+#   close $fh;
+
+use Symbol ();
+
+use constant CHUNK_SIZE => 256 * 1024;  # bytes
+use constant QUEUE_SIZE => 2;           # chunks
+
+# returns a new filehandle tied to this class
+sub open {
+    my ($class, %params) = @_;
+    
+    my $fh = Symbol::gensym();
+    tie *$fh, $class, %params;
+    return $fh;
+}
+
+sub TIEHANDLE {
+    my ($class, %params) = @_;
+    
+    my $self = bless {
+        file    => $params{file},
+        gzip    => $params{gzip} // ($params{file} =~ /\.gz$/i ? 1 : 0),
+        async   => ($Slic3r::have_threads && ($params{threads} // 1) > 1),
+        buffer  => "",
+        tid     => ($Slic3r::have_threads ? threads->tid : 0),
+    }, $class;
+    
+    Slic3r::open(\my $fh, ">", $self->{file})
+        or die "Failed to open $self->{file} for writing\n";
+    binmode $fh if $self->{gzip};
+    $self->{fh} = $fh;
+    
+    return $self;
+}
+
+sub PRINT {
+    my $self = shift;
+    
+    $self->{buffer} .= join(defined $, ? $, : "", @_) . (defined $\ ? $\ : "");
+    $self->_flush_chunk if length($self->{buffer}) >= CHUNK_SIZE;
+    return 1;
+}
+
+sub PRINTF {
+    my $self = shift;
+    my $format = shift;
+    
+    local $\;
+    return $self->PRINT(sprintf $format, @_);
+}
+
+sub CLOSE {
+    my $self = shift;
+    
+    return 1 if !$self->{fh};
+    my $error;
+    if ($self->{thread}) {
+        $self->_flush_chunk if !$self->{state}{error};
+        $error = $self->_stop_writer_thread;
+        close $self->{fh};
+    } else {
+        # output fitting in a single chunk isn't worth starting a thread for
+        my $out = $self->{out} // ($self->{gzip} ? _wrap_gzip($self->{fh}) : $self->{fh});
+        $error = _error($self->{gzip}) if !print {$out} $self->{buffer};
+        $error //= _error($self->{gzip}) if !close $out;
+        $self->{buffer} = "";
+    }
+    delete $self->{fh};
+    die "Failed to write $self->{file}: $error\n" if $error;
+    return 1;
+}
+
+sub UNTIE {
+    my $self = shift;
+    $self->CLOSE;
+}
+
+sub DESTROY {
+    my $self = shift;
+    
+    # the clone living in the writer thread must not touch the file
+    return if $Slic3r::have_threads && threads->tid != $self->{tid};
+    # don't die while unwinding from another error
+    eval { $self->CLOSE };
+}
+
+# hands a full chunk to the writer thread, or writes it out directly
+sub _flush_chunk {
+    my $self = shift;
+    
+    return if $self->{buffer} eq '';
+    if ($self->{async} && !$self->{thread}) {
+        # nothing was written yet, so the file can be handed over to the thread;
+        # the writer thread inherits a clone of $fh, so it's the only one writing to it
+        $self->{state} = threads::shared::shared_clone({ queue => [], error => undef });
+        $self->{thread} = threads->create(\&_writer_thread, $self->{state}, $self->{fh}, $self->{gzip});
+    }
+    if ($self->{thread}) {
+        $self->_enqueue($self->{buffer});
+        if (defined $self->{state}{error}) {
+            my $error = $self->_stop_writer_thread;
+            close $self->{fh};
+            delete $self->{fh};
+            die "Failed to write $self->{file}: $error\n";
+        }
+    } else {
+        $self->{out} //= $self->{gzip} ? _wrap_gzip($self->{fh}) : $self->{fh};
+        if (!print {$self->{out}} $self->{buffer}) {
+            my $error = _error($self->{gzip});
+            close $self->{out};
+            delete $self->{fh};
+            die "Failed to write $self->{file}: $error\n";
+        }
+    }
+    $self->{buffer} = "";
+}
+
+# wait for room in the queue, so that we never hold more than QUEUE_SIZE chunks
+sub _enqueue {
+    my ($self, $chunk) = @_;
+    
+    my $state = $self->{state};
+    lock $state;
+    threads::shared::cond_wait($state) while @{$state->{queue}} >= QUEUE_SIZE;
+    push @{$state->{queue}}, $chunk;
+    threads::shared::cond_signal($state);
+}
+
+# tells the writer thread we're done and returns its error, if any
+sub _stop_writer_thread {
+    my $self = shift;
+    
+    $self->_enqueue(undef);
+    my $error = $self->{thread}->join;
+    delete $self->{thread};
+    return $error;
+}
+
+# returns the error message on failure, or an empty string
+sub _writer_thread {
+    my ($state, $fh, $gzip) = @_;
+    
+    my $error;
+    $fh = _wrap_gzip($fh) if $gzip;
+    while (1) {
+        my $chunk;
+        {
+            lock $state;
+            threads::shared::cond_wait($state) while !@{$state->{queue}};
+            $chunk = shift @{$state->{queue}};
+            threads::shared::cond_signal($state);
+        }
+        last if !defined $chunk;
+        # after an error keep consuming the queue so that the main thread never blocks
+        next if defined $error;
+        if (!print $fh $chunk) {
+            $error = _error($gzip);
+            lock $state;
+            $state->{error} = $error;
+        }
+    }
+    $error //= _error($gzip) if !close $fh;
+    
+    Slic3r::thread_cleanup();
+    return $error // "";
+}
+
+# describes the last I/O error
+sub _error {
+    my ($gzip) = @_;
+    return ($gzip && $IO::Compress::Gzip::GzipError) || "$!" || "unknown error";
+}
+
+sub _wrap_gzip {
+    my ($fh) = @_;
+    
+    require IO::Compress::Gzip;
+    my $gz = IO::Compress::Gzip->new($fh, AutoClose => 1)
+        or die "Failed to compress G-code: $IO::Compress::Gzip::GzipError\n";
+    return $gz;
+}
+
+1;
@@ -597,7 +597,8 @@ sub arrange {
     ]);
     
     eval {
-        $self->{model}->arrange_objects($self->skeinpanel->config->min_object_distance, $bb);
+        $self->{model}->arrange_objects($self->skeinpanel->config->min_object_distance, $bb, 1,
+            Slic3r::ThreadPool->new($self->skeinpanel->config->threads));
     };
     # ignore arrange failures on purpose: user has visual feedback and we don't need to warn him
     # when parts don't fit in print bed
@@ -690,6 +691,24 @@ sub export_gcode {
         $dlg->Destroy;
     }
     
+    # apply the config here rather than in the export thread: the export thread
+    # shares the native layers with our print, so the steps it completes are
+    # reused by the next export, as long as the objects (which are re-added when
+    # regions need to be merged) are the ones owned by this thread
+    {
+        my $print = $self->{print};
+        eval {
+            # this will throw errors if config is not valid
+            $config->validate;
+            
+            $print->apply_config($config);
+            $print->apply_extra_variables($extra_variables);
+            
+            $print->validate;
+        };
+        return if Slic3r::GUI::catch_error($self);
+    }
+    
     $self->statusbar->StartBusy;
     
     # It looks like declaring a local $SIG{__WARN__} prevents the ugly
@@ -704,8 +723,6 @@ sub export_gcode {
         
         $self->{export_thread} = threads->create(sub {
             $_thread_self->export_gcode2(
-                $config,
-                $extra_variables,
                 $_thread_self->{output_file},
                 progressbar     => sub { Wx::PostEvent($_thread_self, Wx::PlThreadEvent->new(-1, $PROGRESS_BAR_EVENT, shared_clone([@_]))) },
                 message_dialog  => sub { Wx::PostEvent($_thread_self, Wx::PlThreadEvent->new(-1, $MESSAGE_DIALOG_EVENT, shared_clone([@_]))) },
@@ -727,8 +744,6 @@ sub export_gcode {
         });
     } else {
         $self->export_gcode2(
-            $config,
-            $extra_variables,
             $self->{output_file},
             progressbar => sub {
                 my ($percent, $message) = @_;
@@ -747,7 +762,7 @@ sub export_gcode {
 
 sub export_gcode2 {
     my $self = shift;
-    my ($config, $extra_variables, $output_file, %params) = @_;
+    my ($output_file, %params) = @_;
     local $SIG{'KILL'} = sub {
         Slic3r::debugf "Exporting cancelled; exiting thread...\n";
         Slic3r::thread_cleanup();
@@ -756,16 +771,7 @@ sub export_gcode2 {
     
     my $print = $self->{print};
     
-    
     eval {
-        # this will throw errors if config is not valid
-        $config->validate;
-        
-        $print->apply_config($config);
-        $print->apply_extra_variables($extra_variables);
-        
-        $print->validate;
-        
         {
             my @warnings = ();
             local $SIG{__WARN__} = sub { push @warnings, $_[0] };
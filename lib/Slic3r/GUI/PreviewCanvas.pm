@@ -72,7 +72,7 @@ sub new {
 sub load_object {
     my ($self, $object) = @_;
     
-    my $bb = $object->raw_mesh->bounding_box;
+    my $bb = $object->raw_bounding_box;
     my $center = $bb->center;
     $self->object_shift(Slic3r::Pointf3->new(-$center->x, -$center->y, -$bb->z_min));  #,,
     $bb->translate(@{ $self->object_shift });
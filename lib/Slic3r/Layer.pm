@@ -3,26 +3,20 @@ use Moo;
 
 use List::Util qw(first);
 use Slic3r::Geometry qw(scale);
-use Slic3r::Geometry::Clipper qw(union_ex);
 
-has 'id'                => (is => 'rw', required => 1, trigger => 1); # sequential number of layer, 0-based
 has 'object'            => (is => 'ro', weak_ref => 1, required => 1, handles => [qw(print config)]);
 has 'upper_layer'       => (is => 'rw', weak_ref => 1);
 has 'regions'           => (is => 'ro', default => sub { [] });
 has 'slicing_errors'    => (is => 'rw');
 
-has 'slice_z'           => (is => 'ro', required => 1); # Z used for slicing in unscaled coordinates
-has 'print_z'           => (is => 'ro', required => 1); # Z used for printing in unscaled coordinates
-has 'height'            => (is => 'ro', required => 1); # layer height in unscaled coordinates
-
-# collection of expolygons generated by slicing the original geometry;
-# also known as 'islands' (all regions and surface types are merged here)
-has 'slices'            => (is => 'rw', default => sub { Slic3r::ExPolygon::Collection->new });
-
-sub _trigger_id {
-    my $self = shift;
-    $_->_trigger_layer for @{$self->regions || []};
-}
+# the layer data (id, slice_z, print_z, height and the merged slices, also
+# known as 'islands') is stored in the Slic3r::Layer::Native owned by the
+# object, so that C++ code can walk the whole layer stack
+has '_native'           => (
+    is          => 'ro',
+    required    => 1,
+    handles     => [qw(id slice_z print_z height slices)],
+);
 
 # the purpose of this method is to be overridden for ::Support layers
 sub islands {
@@ -38,6 +32,7 @@ sub region {
         $self->regions->[$i] //= Slic3r::Layer::Region->new(
             layer   => $self,
             region  => $self->object->print->regions->[$i],
+            _native => $self->_native->add_region,
         );
     }
     
@@ -47,10 +42,7 @@ sub region {
 # merge all regions' slices to get islands
 sub make_slices {
     my $self = shift;
-    
-    my $slices = union_ex([ map $_->p, map @{$_->slices}, @{$self->regions} ]);
-    $self->slices->clear;
-    $self->slices->append(@$slices);
+    $self->_native->make_slices;
 }
 
 sub make_perimeters {
@@ -63,10 +55,10 @@ package Slic3r::Layer::Support;
 use Moo;
 extends 'Slic3r::Layer';
 
-# ordered collection of extrusion paths to fill surfaces for support material
-has 'support_islands'           => (is => 'rw', default => sub { Slic3r::ExPolygon::Collection->new });
-has 'support_fills'             => (is => 'rw', default => sub { Slic3r::ExtrusionPath::Collection->new });
-has 'support_interface_fills'   => (is => 'rw', default => sub { Slic3r::ExtrusionPath::Collection->new });
+# support islands and the ordered collections of extrusion paths to fill
+# them are stored in the Slic3r::Layer::Support::Native
+has '+_native'  => (handles => [qw(id slice_z print_z height slices
+    support_islands support_fills support_interface_fills)]);
 
 sub islands {
     my $self = shift;
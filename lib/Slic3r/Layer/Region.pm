@@ -4,10 +4,10 @@ use Moo;
 use List::Util qw(sum first);
 use Slic3r::ExtrusionPath ':roles';
 use Slic3r::Flow ':roles';
-use Slic3r::Geometry qw(PI A B scale unscale chained_path points_coincide);
+use Slic3r::Geometry qw(PI A B scale unscale chained_path);
 use Slic3r::Geometry::Clipper qw(union_ex diff_ex intersection_ex 
     offset offset2 offset2_ex union_pt diff intersection
-    union diff intersection_pl);
+    union diff);
 use Slic3r::Surface ':types';
 
 has 'layer' => (
@@ -17,24 +17,18 @@ has 'layer' => (
     handles     => [qw(id slice_z print_z height object print)],
 );
 has 'region'            => (is => 'ro', required => 1, handles => [qw(config)]);
-has 'infill_area_threshold' => (is => 'lazy');
-has 'overhang_width'    => (is => 'lazy');
+has 'infill_area_threshold' => (is => 'lazy', clearer => 1);
+has 'overhang_width'    => (is => 'lazy', clearer => 1);
 
-# collection of surfaces generated by slicing the original geometry
-# divided by type top/bottom/internal
-has 'slices' => (is => 'rw', default => sub { Slic3r::Surface::Collection->new });
-
-# collection of extrusion paths/loops filling gaps
-has 'thin_fills' => (is => 'rw', default => sub { Slic3r::ExtrusionPath::Collection->new });
-
-# collection of surfaces for infill generation
-has 'fill_surfaces' => (is => 'rw', default => sub { Slic3r::Surface::Collection->new });
-
-# ordered collection of extrusion paths/loops to build all perimeters
-has 'perimeters' => (is => 'rw', default => sub { Slic3r::ExtrusionPath::Collection->new });
-
-# ordered collection of extrusion paths to fill surfaces
-has 'fills' => (is => 'rw', default => sub { Slic3r::ExtrusionPath::Collection->new });
+# the surface collections (slices divided by type top/bottom/internal and
+# the fill_surfaces for infill generation) and the extrusion collections
+# (thin_fills, perimeters and fills) are stored in the native layer region
+has '_native' => (
+    is          => 'ro',
+    required    => 1,
+    handles     => [qw(slices raw_slices thin_fills fill_surfaces perimeters fills
+        backup_slices restore_slices)],
+);
 
 sub _build_overhang_width {
     my $self = shift;
@@ -61,6 +55,10 @@ sub flow {
 sub make_perimeters {
     my $self = shift;
     
+    # these are derived from flows, which might have changed since a previous run
+    $self->clear_infill_area_threshold;
+    $self->clear_overhang_width;
+    
     my $perimeter_flow      = $self->flow(FLOW_ROLE_PERIMETER);
     my $mm3_per_mm          = $perimeter_flow->mm3_per_mm($self->height);
     my $pwidth              = $perimeter_flow->scaled_width;
@@ -334,202 +332,30 @@ sub _fill_gaps {
     }
 }
 
+# if no solid layers are requested, turn top/bottom surfaces to internal;
+# turn too small internal regions into solid regions according to the user setting
 sub prepare_fill_surfaces {
     my $self = shift;
     
-    # if no solid layers are requested, turn top/bottom surfaces to internal
-    if ($self->config->top_solid_layers == 0) {
-        $_->surface_type(S_TYPE_INTERNAL) for @{$self->fill_surfaces->filter_by_type(S_TYPE_TOP)};
-    }
-    if ($self->config->bottom_solid_layers == 0) {
-        $_->surface_type(S_TYPE_INTERNAL) for @{$self->fill_surfaces->filter_by_type(S_TYPE_BOTTOM)};
-    }
-        
-    # turn too small internal regions into solid regions according to the user setting
-    if ($self->config->fill_density > 0) {
-        my $min_area = scale scale $self->config->solid_infill_below_area; # scaling an area requires two calls!
-        $_->surface_type(S_TYPE_INTERNALSOLID)
-            for grep { $_->area <= $min_area } @{$self->fill_surfaces->filter_by_type(S_TYPE_INTERNAL)};
-    }
+    $self->_native->prepare_fill_surfaces(
+        $self->config->top_solid_layers > 0 ? 1 : 0,
+        $self->config->bottom_solid_layers > 0 ? 1 : 0,
+        $self->config->fill_density > 0 ? 1 : 0,
+        scale scale $self->config->solid_infill_below_area, # scaling an area requires two calls!
+    );
 }
 
+# grow the top and bottom surfaces over the fill boundaries; $bridge_angles
+# holds the directions (in radians, or undef) detected for the bottom surfaces,
+# in their order, as returned by the native detect_bridge_angles()
 sub process_external_surfaces {
-    my ($self, $lower_layer) = @_;
-    
-    my @surfaces = @{$self->fill_surfaces};
-    my $margin = scale &Slic3r::EXTERNAL_INFILL_MARGIN;
-    
-    my @bottom = ();
-    foreach my $surface (grep $_->surface_type == S_TYPE_BOTTOM, @surfaces) {
-        my $grown = $surface->expolygon->offset_ex(+$margin);
-        
-        # detect bridge direction before merging grown surfaces otherwise adjacent bridges
-        # would get merged into a single one while they need different directions
-        # also, supply the original expolygon instead of the grown one, because in case
-        # of very thin (but still working) anchors, the grown expolygon would go beyond them
-        my $angle = $lower_layer
-            ? $self->_detect_bridge_direction($surface->expolygon, $lower_layer)
-            : undef;
-        
-        push @bottom, map $surface->clone(expolygon => $_, bridge_angle => $angle), @$grown;
-    }
-    
-    my @top = ();
-    foreach my $surface (grep $_->surface_type == S_TYPE_TOP, @surfaces) {
-        # give priority to bottom surfaces
-        my $grown = diff_ex(
-            $surface->expolygon->offset(+$margin),
-            [ map $_->p, @bottom ],
-        );
-        push @top, map $surface->clone(expolygon => $_), @$grown;
-    }
-    
-    # if we're slicing with no infill, we can't extend external surfaces
-    # over non-existent infill
-    my @fill_boundaries = $self->config->fill_density > 0
-        ? @surfaces
-        : grep $_->surface_type != S_TYPE_INTERNAL, @surfaces;
-    
-    # intersect the grown surfaces with the actual fill boundaries
-    my @new_surfaces = ();
-    foreach my $group (@{Slic3r::Surface::Collection->new(@top, @bottom)->group}) {
-        push @new_surfaces,
-            map $group->[0]->clone(expolygon => $_),
-            @{intersection_ex(
-                [ map $_->p, @$group ],
-                [ map $_->p, @fill_boundaries ],
-                1,  # to ensure adjacent expolygons are unified
-            )};
-    }
-    
-    # subtract the new top surfaces from the other non-top surfaces and re-add them
-    my @other = grep $_->surface_type != S_TYPE_TOP && $_->surface_type != S_TYPE_BOTTOM, @surfaces;
-    foreach my $group (@{Slic3r::Surface::Collection->new(@other)->group}) {
-        push @new_surfaces, map $group->[0]->clone(expolygon => $_), @{diff_ex(
-            [ map $_->p, @$group ],
-            [ map $_->p, @new_surfaces ],
-        )};
-    }
-    $self->fill_surfaces->clear;
-    $self->fill_surfaces->append(@new_surfaces);
-}
-
-sub _detect_bridge_direction {
-    my ($self, $expolygon, $lower_layer) = @_;
+    my ($self, $bridge_angles) = @_;
     
-    my $perimeter_flow  = $self->flow(FLOW_ROLE_PERIMETER);
-    my $infill_flow     = $self->flow(FLOW_ROLE_INFILL);
-    
-    my $grown = $expolygon->offset(+$perimeter_flow->scaled_width);
-    my @lower = @{$lower_layer->slices};       # expolygons
-    
-    # detect what edges lie on lower slices
-    my @edges = (); # polylines
-    foreach my $lower (@lower) {
-        # turn bridge contour and holes into polylines and then clip them
-        # with each lower slice's contour
-        my @clipped = @{intersection_pl([ map $_->split_at_first_point, @$grown ], [$lower->contour])};
-        if (@clipped == 2) {
-            # If the split_at_first_point() call above happens to split the polygon inside the clipping area
-            # we would get two consecutive polylines instead of a single one, so we use this ugly hack to 
-            # recombine them back into a single one in order to trigger the @edges == 2 logic below.
-            # This needs to be replaced with something way better.
-            if (points_coincide($clipped[0][0], $clipped[-1][-1])) {
-                @clipped = (Slic3r::Polyline->new(@{$clipped[-1]}, @{$clipped[0]}));
-            }
-            if (points_coincide($clipped[-1][0], $clipped[0][-1])) {
-                @clipped = (Slic3r::Polyline->new(@{$clipped[0]}, @{$clipped[1]}));
-            }
-        }
-        push @edges, @clipped;
-    }
-    
-    Slic3r::debugf "Found bridge on layer %d with %d support(s)\n", $self->id, scalar(@edges);
-    return undef if !@edges;
-    
-    my $bridge_angle = undef;
-    
-    if (0) {
-        require "Slic3r/SVG.pm";
-        Slic3r::SVG::output("bridge_$expolygon.svg",
-            expolygons      => [ $expolygon ],
-            red_expolygons  => [ @lower ],
-            polylines       => [ @edges ],
-        );
-    }
-    
-    if (@edges == 2) {
-        my @chords = map Slic3r::Line->new($_->[0], $_->[-1]), @edges;
-        my @midpoints = map $_->midpoint, @chords;
-        my $line_between_midpoints = Slic3r::Line->new(@midpoints);
-        $bridge_angle = Slic3r::Geometry::rad2deg_dir($line_between_midpoints->direction);
-    } elsif (@edges == 1) {
-        # TODO: this case includes both U-shaped bridges and plain overhangs;
-        # we need a trapezoidation algorithm to detect the actual bridged area
-        # and separate it from the overhang area.
-        # in the mean time, we're treating as overhangs all cases where
-        # our supporting edge is a straight line
-        if (@{$edges[0]} > 2) {
-            my $line = Slic3r::Line->new($edges[0]->[0], $edges[0]->[-1]);
-            $bridge_angle = Slic3r::Geometry::rad2deg_dir($line->direction);
-        }
-    } elsif (@edges) {
-        # inset the bridge expolygon; we'll use this one to clip our test lines
-        my $inset = $expolygon->offset_ex($infill_flow->scaled_width);
-        
-        # detect anchors as intersection between our bridge expolygon and the lower slices
-        my $anchors = intersection_ex(
-            $grown,
-            [ map @$_, @lower ],
-            1,  # safety offset required to avoid Clipper from detecting empty intersection while Boost actually found some @edges
-        );
-        
-        if (@$anchors) {
-            # we'll now try several directions using a rudimentary visibility check:
-            # bridge in several directions and then sum the length of lines having both
-            # endpoints within anchors
-            my %directions = ();  # angle => score
-            my $angle_increment = PI/36; # 5°
-            my $line_increment = $infill_flow->scaled_width;
-            for (my $angle = 0; $angle <= PI; $angle += $angle_increment) {
-                # rotate everything - the center point doesn't matter
-                $_->rotate($angle, [0,0]) for @$inset, @$anchors;
-            
-                # generate lines in this direction
-                my $bounding_box = Slic3r::Geometry::BoundingBox->new_from_points([ map @$_, map @$_, @$anchors ]);
-            
-                my @lines = ();
-                for (my $x = $bounding_box->x_min; $x <= $bounding_box->x_max; $x += $line_increment) {
-                    push @lines, Slic3r::Polyline->new([$x, $bounding_box->y_min], [$x, $bounding_box->y_max]);
-                }
-            
-                my @clipped_lines = map Slic3r::Line->new(@$_), @{ intersection_pl(\@lines, [ map @$_, @$inset ]) };
-            
-                # remove any line not having both endpoints within anchors
-                # NOTE: these calls to contains_point() probably need to check whether the point 
-                # is on the anchor boundaries too
-                @clipped_lines = grep {
-                    my $line = $_;
-                    !(first { $_->contains_point($line->a) } @$anchors)
-                        && !(first { $_->contains_point($line->b) } @$anchors);
-                } @clipped_lines;
-            
-                # sum length of bridged lines
-                $directions{-$angle} = sum(map $_->length, @clipped_lines) // 0;
-            }
-        
-            # this could be slightly optimized with a max search instead of the sort
-            my @sorted_directions = sort { $directions{$a} <=> $directions{$b} } keys %directions;
-    
-            # the best direction is the one causing most lines to be bridged
-            $bridge_angle = Slic3r::Geometry::rad2deg_dir($sorted_directions[-1]);
-        }
-    }
-    
-    Slic3r::debugf "  Optimal infill angle of bridge on layer %d is %d degrees\n",
-        $self->id, $bridge_angle if defined $bridge_angle;
-    
-    return $bridge_angle;
+    $self->_native->process_external_surfaces(
+        [ map $_ // -1, @{ $bridge_angles // [] } ],
+        scale &Slic3r::EXTERNAL_INFILL_MARGIN,
+        $self->config->fill_density > 0 ? 1 : 0,
+    );
 }
 
 1;
@@ -1,8 +1,8 @@
 package Slic3r::Model;
 use Moo;
 
-use List::Util qw(first max);
-use Slic3r::Geometry qw(X Y Z MIN move_points);
+use List::Util qw(first);
+use Slic3r::Geometry qw(X Y Z MIN move_points rad2deg scale unscale convex_hull);
 
 has 'materials' => (is => 'ro', default => sub { {} });
 has 'objects'   => (is => 'ro', default => sub { [] });
@@ -107,7 +107,7 @@ sub duplicate_objects_grid {
 # this will append more instances to each object
 # and then automatically rearrange everything
 sub duplicate_objects {
-    my ($self, $copies_num, $distance, $bb) = @_;
+    my ($self, $copies_num, $distance, $bb, $rotations, $pool) = @_;
     
     foreach my $object (@{$self->objects}) {
         my @instances = @{$object->instances};
@@ -121,40 +121,50 @@ sub duplicate_objects {
         }
     }
     
-    $self->arrange_objects($distance, $bb);
+    $self->arrange_objects($distance, $bb, $rotations, $pool);
 }
 
 # arrange objects preserving their instance count
-# but altering their instance positions
+# but altering their instance positions (and rotations, if
+# more than one rotation step is allowed)
 sub arrange_objects {
-    my ($self, $distance, $bb) = @_;
+    my ($self, $distance, $bb, $rotations, $pool) = @_;
     
-    # get the (transformed) size of each instance so that we take
-    # into account their different transformations when packing
-    my @instance_sizes = ();
+    # get the (transformed) convex hull of each instance so that we take
+    # into account their actual shape and transformations when packing
+    my @instance_hulls = ();
     foreach my $object (@{$self->objects}) {
-        push @instance_sizes, map $object->instance_bounding_box($_)->size, 0..$#{$object->instances};
+        foreach my $instance_idx (0..$#{$object->instances}) {
+            my $hull = $object->instance_convex_hull($instance_idx);
+            $hull->translate(map -scale($_), @{$object->instances->[$instance_idx]->offset});
+            push @instance_hulls, $hull;
+        }
     }
     
-    my @positions = $self->_arrange(\@instance_sizes, $distance, $bb);
+    my @positions = $self->_arrange(\@instance_hulls, $distance, $bb, $rotations, $pool);
     
     foreach my $object (@{$self->objects}) {
-        $_->offset([ @{shift @positions} ]) for @{$object->instances};
+        foreach my $instance (@{$object->instances}) {
+            my $pos = shift @positions;
+            $instance->offset([ @$pos[X,Y] ]);
+            $instance->rotation($instance->rotation + $pos->[2]);
+        }
         $object->update_bounding_box;
     }
 }
 
 # duplicate the entire model preserving instance relative positions
 sub duplicate {
-    my ($self, $copies_num, $distance, $bb) = @_;
+    my ($self, $copies_num, $distance, $bb, $pool) = @_;
     
-    my $model_size = $self->bounding_box->size;
-    my @positions = $self->_arrange([ map $model_size, 2..$copies_num ], $distance, $bb);
+    # the whole model is packed as a single part, including the original copy
+    my $model_hull = convex_hull([ map @{$_->convex_hull->pp}, @{$self->objects} ]);
+    my ($origin, @positions) = $self->_arrange([ map $model_hull, 1..$copies_num ], $distance, $bb, 1, $pool);
     
     # note that this will leave the object count unaltered
     
     foreach my $object (@{$self->objects}) {
-        my @instances = @{$object->instances};  # store separately to avoid recursion from add_instance() below
+        my @instances = @{$object->instances};  # store separately to avoid recursion from add_instance() below
         foreach my $instance (@instances) {
             foreach my $pos (@positions) {
                 ### $object->add_instance($instance->clone);  if we had clone()
@@ -164,21 +174,36 @@ sub duplicate {
                     scaling_factor  => $instance->scaling_factor,
                 );
             }
+            $instance->offset->[X] += $origin->[X];
+            $instance->offset->[Y] += $origin->[Y];
         }
         $object->update_bounding_box;
     }
 }
 
+# packs the supplied convex hulls (in scaled coordinates) and returns
+# the unscaled position and the rotation (in degrees) of each one;
+# candidate placements are evaluated on $pool if supplied
 sub _arrange {
-    my ($self, $sizes, $distance, $bb) = @_;
-    
-    return Slic3r::Geometry::arrange(
-        scalar(@$sizes),                # number of parts
-        max(map $_->x, @$sizes),        # cell width
-        max(map $_->y, @$sizes),        # cell height ,
-        $distance,                      # distance between cells
-        $bb,                            # bounding box of the area to fill (can be undef)
-    );
+    my ($self, $hulls, $distance, $bb, $rotations, $pool) = @_;
+    
+    my $arranger = Slic3r::Geometry::Arranger->new(scale $distance, $rotations // 1);
+    $arranger->set_time_budget(1);
+    if (defined $bb) {
+        my $bed = $bb->clone;
+        $bed->scale(1 / &Slic3r::SCALING_FACTOR);
+        $arranger->set_bed($bed);
+    }
+    $arranger->add_part($_) for @$hulls;
+    $arranger->arrange($pool // Slic3r::ThreadPool->new(1))
+        or die scalar(@$hulls) . " parts won't fit in your print area!\n";
+    
+    my @positions = ();
+    foreach my $i (0..$#$hulls) {
+        my $pos = $arranger->position($i);
+        push @positions, [ unscale($pos->x), unscale($pos->y), rad2deg($arranger->rotation($i)) ];
+    }
+    return @positions;
 }
 
 sub has_objects_with_no_instances {
@@ -309,6 +334,8 @@ has 'instances'             => (is => 'rw');
 has 'config'                => (is => 'rw', default => sub { Slic3r::Config->new });
 has 'layer_height_ranges'   => (is => 'rw', default => sub { [] }); # [ z_min, z_max, layer_height ]
 has '_bounding_box'         => (is => 'rw');
+has '_raw_mesh_view'        => (is => 'rw');  # cached until volumes are mutated
+has '_instance_cache'       => (is => 'ro', default => sub { [] });  # [ transform key, bounding box, convex hull ] for each instance
 
 sub add_volume {
     my $self = shift;
@@ -345,8 +372,8 @@ sub add_volume {
     
     push @{$self->volumes}, $new_volume;
     
-    # invalidate cached bounding box
-    $self->_bounding_box(undef);
+    # invalidate cached bounding boxes and convex hulls
+    $self->invalidate_mesh_cache;
     
     return $new_volume;
 }
@@ -354,6 +381,16 @@ sub add_volume {
 sub delete_volume {
     my ($self, $i) = @_;
     splice @{$self->volumes}, $i, 1;
+    $self->invalidate_mesh_cache;
+}
+
+# must be called whenever the meshes of the volumes are altered
+sub invalidate_mesh_cache {
+    my ($self) = @_;
+    
+    $self->_raw_mesh_view(undef);
+    @{$self->_instance_cache} = ();
+    $self->_bounding_box(undef);
 }
 
 sub add_instance {
@@ -369,6 +406,7 @@ sub add_instance {
 sub delete_last_instance {
     my ($self) = @_;
     pop @{$self->instances};
+    splice @{$self->_instance_cache}, scalar(@{$self->instances});
     $self->_bounding_box(undef);
 }
 
@@ -403,9 +441,55 @@ sub mesh {
     return $full_mesh;
 }
 
+# returns a view of the instances of this object which answers bounding box
+# and convex hull queries without transforming or merging any mesh
+sub mesh_view {
+    my ($self, $with_projection) = @_;
+    
+    my $view = Slic3r::TriangleMesh::View->new($with_projection ? 1 : 0);
+    $view->add_mesh($_->mesh) for grep !$_->modifier, @{ $self->volumes };
+    $view->add_instance($_->rotation, $_->scaling_factor, @{$_->offset}) for @{ $self->instances // [] };
+    return $view;
+}
+
+# returns a view of the raw meshes, cached until they're mutated
+sub _cached_raw_mesh_view {
+    my ($self) = @_;
+    
+    if (!defined $self->_raw_mesh_view) {
+        my $view = Slic3r::TriangleMesh::View->new;
+        $view->add_mesh($_->mesh) for grep !$_->modifier, @{ $self->volumes };
+        $self->_raw_mesh_view($view);
+    }
+    $self->_raw_mesh_view->clear_instances;
+    return $self->_raw_mesh_view;
+}
+
+# returns the cached bounding box and convex hull of the given instance;
+# they're computed again only if the instance transformation was changed
+# or the meshes were mutated
+sub _instance_cache_entry {
+    my ($self, $instance_idx) = @_;
+    
+    my $instance = $self->instances->[$instance_idx];
+    my $key = join ',', $instance->rotation, $instance->scaling_factor, @{$instance->offset};
+    my $entry = $self->_instance_cache->[$instance_idx];
+    if (!defined $entry || $entry->[0] ne $key) {
+        my $view = $self->_cached_raw_mesh_view;
+        $view->add_instance($instance->rotation, $instance->scaling_factor, @{$instance->offset});
+        $entry = $self->_instance_cache->[$instance_idx]
+            = [ $key, $view->instance_bounding_box(0), $view->instance_convex_hull(0) ];
+    }
+    return $entry;
+}
+
 sub update_bounding_box {
     my ($self) = @_;
-    $self->_bounding_box($self->mesh->bounding_box);
+    
+    my @bb = map $self->_instance_cache_entry($_)->[1], 0..$#{ $self->instances // [] };
+    my $bb = @bb ? $bb[0]->clone : $self->_cached_raw_mesh_view->bounding_box;  # empty
+    $bb->merge($_) for @bb[1..$#bb];
+    $self->_bounding_box($bb);
 }
 
 # this returns the bounding box of the *transformed* instances
@@ -419,10 +503,27 @@ sub bounding_box {
 # this returns the bounding box of the *transformed* given instance
 sub instance_bounding_box {
     my ($self, $instance_idx) = @_;
-    
-    my $mesh = $self->raw_mesh;
-    $self->instances->[$instance_idx]->transform_mesh($mesh);
-    return $mesh->bounding_box;
+    return $self->_instance_cache_entry($instance_idx)->[1]->clone;
+}
+
+# this returns the convex hull of the *transformed* given instance
+sub instance_convex_hull {
+    my ($self, $instance_idx) = @_;
+    return $self->_instance_cache_entry($instance_idx)->[2]->clone;
+}
+
+# this returns the convex hull of the *transformed* instances
+sub convex_hull {
+    my $self = shift;
+    return Slic3r::Geometry::convex_hull([
+        map @{$self->_instance_cache_entry($_)->[2]}, 0..$#{ $self->instances // [] }
+    ]);
+}
+
+# this returns the bounding box of the untransformed object
+sub raw_bounding_box {
+    my $self = shift;
+    return $self->_cached_raw_mesh_view->raw_bounding_box;
 }
 
 sub center_around_origin {
@@ -430,7 +531,7 @@ sub center_around_origin {
     
     # calculate the displacements needed to 
     # center this object around the origin
-    my $bb = $self->raw_mesh->bounding_box;
+    my $bb = $self->raw_bounding_box;
     
     # first align to origin on XY
     my @shift = (
@@ -462,7 +563,7 @@ sub translate {
     my @shift = @_;
     
     $_->mesh->translate(@shift) for @{$self->volumes};
-    $self->_bounding_box->translate(@shift) if defined $self->_bounding_box;
+    $self->invalidate_mesh_cache;
 }
 
 sub materials_count {
@@ -502,7 +603,7 @@ sub print_info {
     my $self = shift;
     
     printf "Info about %s:\n", basename($self->input_file);
-    printf "  size:              x=%.3f y=%.3f z=%.3f\n", @{$self->raw_mesh->bounding_box->size};
+    printf "  size:              x=%.3f y=%.3f z=%.3f\n", @{$self->raw_bounding_box->size};
     if (my $stats = $self->mesh_stats) {
         printf "  number of facets:  %d\n", $stats->{number_of_facets};
         printf "  number of shells:  %d\n", $stats->{number_of_parts};
@@ -528,8 +629,13 @@ use Moo;
 
 has 'object'            => (is => 'ro', weak_ref => 1, required => 1);
 has 'material_id'       => (is => 'rw');
-has 'mesh'              => (is => 'rw', required => 1);
-has 'modifier'          => (is => 'rw', defualt => sub { 0 });
+has 'mesh'              => (is => 'rw', required => 1, trigger => \&_invalidate_object_cache);
+has 'modifier'          => (is => 'rw', defualt => sub { 0 }, trigger => \&_invalidate_object_cache);
+
+sub _invalidate_object_cache {
+    my ($self) = @_;
+    $self->object->invalidate_mesh_cache if defined $self->object;
+}
 
 sub assign_unique_material {
     my ($self) = @_;
@@ -551,9 +657,9 @@ has 'offset'            => (is => 'rw');  # must be arrayref in *unscaled* coord
 sub transform_mesh {
     my ($self, $mesh, $dont_translate) = @_;
     
-    $mesh->rotate($self->rotation, Slic3r::Point->new(0,0));   # rotate around mesh origin
-    $mesh->scale($self->scaling_factor);                       # scale around mesh origin
-    $mesh->translate(@{$self->offset}, 0) unless $dont_translate;
+    # rotate and scale around mesh origin, then translate, in a single pass
+    $mesh->transform($self->rotation, $self->scaling_factor,
+        ($dont_translate ? (0, 0) : @{$self->offset}), 0);
 }
 
 sub transform_polygon {
@@ -9,7 +9,7 @@ use Slic3r::Flow ':roles';
 use Slic3r::Geometry qw(X Y Z X1 Y1 X2 Y2 MIN MAX PI scale unscale move_points chained_path
     convex_hull);
 use Slic3r::Geometry::Clipper qw(diff_ex union_ex union_pt intersection_ex intersection offset
-    offset2 union union_pt_chained JT_ROUND JT_SQUARE);
+    union JT_ROUND JT_SQUARE);
 use Slic3r::Print::State ':steps';
 
 has 'config'                 => (is => 'ro', default => sub { Slic3r::Config::Print->new });
@@ -21,7 +21,10 @@ has 'status_cb'              => (is => 'rw');
 has 'regions'                => (is => 'rw', default => sub {[]});
 has 'total_used_filament'    => (is => 'rw');
 has 'total_extruded_volume'  => (is => 'rw');
+has 'estimated_print_time'   => (is => 'rw');  # seconds
 has '_state'                 => (is => 'ro', default => sub { Slic3r::Print::State->new });
+has 'thread_pool'            => (is => 'rw');    # native threads, started once and reused by all steps
+has 'profiler'               => (is => 'rw');    # Slic3r::Print::Profiler measuring each stage, if any
 
 # ordered collection of extrusion paths to build skirt loops
 has 'skirt' => (is => 'rw', default => sub { Slic3r::ExtrusionPath::Collection->new });
@@ -29,6 +32,15 @@ has 'skirt' => (is => 'rw', default => sub { Slic3r::ExtrusionPath::Collection->
 # ordered collection of extrusion paths to build a brim
 has 'brim' => (is => 'rw', default => sub { Slic3r::ExtrusionPath::Collection->new });
 
+# The pool is started here, in the thread creating the print, and not lazily:
+# the GUI processes the print in an export thread, whose copies of the Perl
+# objects don't free the native ones (see Slic3r::thread_cleanup()), so a pool
+# started there would never be stopped. Export threads just use this one.
+sub BUILD {
+    my $self = shift;
+    $self->thread_pool(Slic3r::ThreadPool->new($self->config->threads));
+}
+
 sub apply_config {
     my ($self, $config) = @_;
     
@@ -36,14 +48,17 @@ sub apply_config {
     my $print_diff = $self->config->diff($config);
     if (@$print_diff) {
         $self->config->apply_dynamic($config);
+        $self->invalidate_state_by_config_options($print_diff);
         
-        # TODO: only invalidate changed steps
-        $self->_state->invalidate_all;
+        $self->thread_pool(Slic3r::ThreadPool->new($self->config->threads))
+            if first { $_ eq 'threads' } @$print_diff;
     }
     
     # handle changes to object config defaults
     $self->default_object_config->apply_dynamic($config);
-    foreach my $object (@{$self->objects}) {
+    foreach my $obj_idx (0..$#{$self->objects}) {
+        my $object = $self->objects->[$obj_idx];
+        
         # we don't assume that $config contains a full ObjectConfig,
         # so we base it on the current print-wise default
         my $new = $self->default_object_config->clone;
@@ -55,8 +70,7 @@ sub apply_config {
         my $diff = $object->config->diff($new);
         if (@$diff) {
             $object->config->apply($new);
-            # TODO: only invalidate changed steps
-            $object->_state->invalidate_all;
+            $self->invalidate_state_by_config_options($diff, $obj_idx);
         }
     }
     
@@ -98,7 +112,7 @@ sub apply_config {
     if ($have_identical_configs) {
         # okay, the current subdivision of regions does not make sense anymore.
         # we need to remove all objects and re-add them
-        my @model_objects = map $_->model_object, @{$self->object};
+        my @model_objects = map $_->model_object, @{$self->objects};
         $self->delete_all_objects;
         $self->add_model_object($_) for @model_objects;
     } elsif (@$region_diff > 0) {
@@ -109,9 +123,7 @@ sub apply_config {
         foreach my $region_id (0..$#{$self->regions}) {
             $self->regions->[$region_id]->config->apply($new_region_configs[$region_id]);
         }
-        
-        # TODO: only invalidate changed steps
-        $_->_state->invalidate_all for @{$self->objects};
+        $self->invalidate_state_by_config_options($region_diff);
     }
 }
 
@@ -225,17 +237,15 @@ sub validate {
         {
             my @a = ();
             foreach my $object (@{$self->objects}) {
-                # get convex hulls of all meshes assigned to this print object
-                my @mesh_convex_hulls = map $object->model_object->volumes->[$_]->mesh->convex_hull,
-                    map @$_,
-                    grep defined $_,
-                    @{$object->region_volumes};
-                
-                # make a single convex hull for all of them
-                my $convex_hull = convex_hull([ map @$_, @mesh_convex_hulls ]);
+                # make a single convex hull for all meshes assigned to this print object
+                my $view = Slic3r::TriangleMesh::View->new;
+                $view->add_mesh($object->model_object->volumes->[$_]->mesh)
+                    for map @$_, grep defined $_, @{$object->region_volumes};
                 
                 # apply the same transformations we apply to the actual meshes when slicing them
-                $object->model_object->instances->[0]->transform_polygon($convex_hull, 1);
+                my $instance = $object->model_object->instances->[0];
+                $view->add_instance($instance->rotation, $instance->scaling_factor, 0, 0);
+                my $convex_hull = $view->instance_convex_hull(0);
         
                 # align object to Z = 0 and apply XY shift
                 $convex_hull->translate(@{$object->_copies_shift});
@@ -361,147 +371,177 @@ sub process {
     
     my $status_cb = $self->status_cb // sub {};
     
+    foreach my $obj_idx (0..$#{$self->objects}) {
+        my $object = $self->objects->[$obj_idx];
+        
+        # the steps might have been run by a clone of this print in another thread
+        $object->sync_layers;
+        
+        # prepare_infill works in place on the fill surfaces generated along with
+        # perimeters, so if it was interrupted they must be generated again
+        $self->invalidate_step(STEP_PERIMETERS, $obj_idx)
+            if $object->_state->started(STEP_PREPARE_INFILL) && !$object->_state->done(STEP_PREPARE_INFILL);
+    }
+    
+    # the work done by each step, either once (print steps) or for each
+    # object (object steps, which receive the object index); steps are run
+    # in order, each one for all objects before the next one starts
+    my %step_cb = (
+        STEP_INIT_EXTRUDERS() => sub {
+            $self->init_extruders;
+        },
+        
+        # skein the STL into layers
+        # each layer has surfaces with holes
+        STEP_SLICE() => sub {
+            $self->objects->[$_[0]]->slice;
+        },
+        
+        # make perimeters
+        # this will add a set of extrusion loops to each layer
+        # as well as generate infill boundaries
+        STEP_PERIMETERS() => sub {
+            $self->objects->[$_[0]]->make_perimeters;
+        },
+        
+        STEP_PREPARE_INFILL() => sub {
+            my $object = $self->objects->[$_[0]];
+            
+            # this will assign a type (top/bottom/internal) to $layerm->slices
+            # and $layerm->fill_surfaces, detect bridges and reverse bridges
+            # and split the fill surfaces near external layers in internal and
+            # internal-solid surfaces
+            $object->prepare_fill_surfaces;
+            $object->clip_fill_surfaces;
+            
+            # the following step needs to be done before combination because it may need
+            # to remove only half of the combined infill
+            $object->bridge_over_infill;
+            
+            # combine fill surfaces to honor the "infill every N layers" option
+            $object->combine_infill;
+        },
+        
+        # this will generate extrusion paths for each layer
+        STEP_INFILL() => sub {
+            my $object = $self->objects->[$_[0]];
+            
+            # fills are appended below, so drop the ones of a previous run
+            $_->fills->clear for map @{$_->regions}, @{$object->layers};
+            
+            Slic3r::parallelize(
+                threads => $self->config->threads,
+                items => sub {
+                    my @items = ();  # [layer_id, region_id]
+                    for my $region_id (0 .. ($self->regions_count-1)) {
+                        push @items, map [$_, $region_id], 0..$#{$object->layers};
+                    }
+                    @items;
+                },
+                thread_cb => sub {
+                    my $q = shift;
+                    while (defined (my $obj_layer = $q->dequeue)) {
+                        my ($i, $region_id) = @$obj_layer;
+                        my $layerm = $object->layers->[$i]->regions->[$region_id];
+                        $layerm->fills->append( $object->fill_maker->make_fill($layerm) );
+                    }
+                },
+                collect_cb => sub {},
+                no_threads_cb => sub {
+                    foreach my $layerm (map @{$_->regions}, @{$object->layers}) {
+                        $layerm->fills->append($object->fill_maker->make_fill($layerm));
+                    }
+                },
+            );
+            
+            ### we could free memory now, but this would make this step not idempotent
+            ### $_->fill_surfaces->clear for map @{$_->regions}, @{$object->layers};
+        },
+        
+        # generate support material
+        STEP_SUPPORTMATERIAL() => sub {
+            $self->objects->[$_[0]]->generate_support_material;
+        },
+        
+        # make skirt
+        STEP_SKIRT() => sub {
+            $self->make_skirt;
+        },
+        STEP_BRIM() => sub {
+            $self->make_brim;  # must come after make_skirt
+        },
+    );
+    
     my $print_step = sub {
-        my ($step, $cb) = @_;
+        my ($step) = @_;
         if (!$self->_state->done($step)) {
             $self->_state->set_started($step);
-            $cb->();
-            ### Re-enable this for step-based slicing:
-            ### $self->_state->set_done($step);
+            $self->_profile_step($step, undef, $step_cb{$step});
+            $self->_state->set_done($step);
         }
     };
     my $object_step = sub {
-        my ($step, $cb) = @_;
+        my ($step) = @_;
         for my $obj_idx (0..$#{$self->objects}) {
             my $object = $self->objects->[$obj_idx];
             if (!$object->_state->done($step)) {
                 $object->_state->set_started($step);
-                $cb->($obj_idx);
-                ### Re-enable this for step-based slicing:
-                ### $object->_state->set_done($step);
+                $self->_profile_step($step, $obj_idx, $step_cb{$step});
+                $object->_state->set_done($step);
             }
         }
     };
     
-    # STEP_INIT_EXTRUDERS
-    $print_step->(STEP_INIT_EXTRUDERS, sub {
-        $self->init_extruders;
-    });
+    $print_step->(STEP_INIT_EXTRUDERS);
     
-    # STEP_SLICE
-    # skein the STL into layers
-    # each layer has surfaces with holes
     $status_cb->(10, "Processing triangulated mesh");
-    $object_step->(STEP_SLICE, sub {
-        $self->objects->[$_[0]]->slice;
-    });
+    $object_step->(STEP_SLICE);
     
     die "No layers were detected. You might want to repair your STL file(s) or check their size and retry.\n"
         if !grep @{$_->layers}, @{$self->objects};
     
-    # make perimeters
-    # this will add a set of extrusion loops to each layer
-    # as well as generate infill boundaries
     $status_cb->(20, "Generating perimeters");
-    $object_step->(STEP_PERIMETERS, sub {
-        $self->objects->[$_[0]]->make_perimeters;
-    });
+    $object_step->(STEP_PERIMETERS);
     
     $status_cb->(30, "Preparing infill");
-    $object_step->(STEP_PREPARE_INFILL, sub {
-        my $object = $self->objects->[$_[0]];
-        
-        # this will assign a type (top/bottom/internal) to $layerm->slices
-        # and transform $layerm->fill_surfaces from expolygon 
-        # to typed top/bottom/internal surfaces;
-        $object->detect_surfaces_type;
-    
-        # decide what surfaces are to be filled
-        $_->prepare_fill_surfaces for map @{$_->regions}, @{$object->layers};
-    
-        # this will detect bridges and reverse bridges
-        # and rearrange top/bottom/internal surfaces
-        $object->process_external_surfaces;
-    
-        # detect which fill surfaces are near external layers
-        # they will be split in internal and internal-solid surfaces
-        $object->discover_horizontal_shells;
-        $object->clip_fill_surfaces;
-        
-        # the following step needs to be done before combination because it may need
-        # to remove only half of the combined infill
-        $object->bridge_over_infill;
-    
-        # combine fill surfaces to honor the "infill every N layers" option
-        $object->combine_infill;
-    });
+    $object_step->(STEP_PREPARE_INFILL);
     
-    # this will generate extrusion paths for each layer
     $status_cb->(70, "Infilling layers");
-    $object_step->(STEP_INFILL, sub {
-        my $object = $self->objects->[$_[0]];
-        
-        Slic3r::parallelize(
-            threads => $self->config->threads,
-            items => sub {
-                my @items = ();  # [layer_id, region_id]
-                for my $region_id (0 .. ($self->regions_count-1)) {
-                    push @items, map [$_, $region_id], 0..$#{$object->layers};
-                }
-                @items;
-            },
-            thread_cb => sub {
-                my $q = shift;
-                while (defined (my $obj_layer = $q->dequeue)) {
-                    my ($i, $region_id) = @$obj_layer;
-                    my $layerm = $object->layers->[$i]->regions->[$region_id];
-                    $layerm->fills->append( $object->fill_maker->make_fill($layerm) );
-                }
-            },
-            collect_cb => sub {},
-            no_threads_cb => sub {
-                foreach my $layerm (map @{$_->regions}, @{$object->layers}) {
-                    $layerm->fills->append($object->fill_maker->make_fill($layerm));
-                }
-            },
-        );
+    $object_step->(STEP_INFILL);
     
-        ### we could free memory now, but this would make this step not idempotent
-        ### $_->fill_surfaces->clear for map @{$_->regions}, @{$object->layers};
-    });
-    
-    # generate support material
     $status_cb->(85, "Generating support material") if $self->has_support_material;
-    $object_step->(STEP_SUPPORTMATERIAL, sub {
-        $self->objects->[$_[0]]->generate_support_material;
-    });
+    $object_step->(STEP_SUPPORTMATERIAL);
     
-    # make skirt
     $status_cb->(88, "Generating skirt/brim");
-    $print_step->(STEP_SKIRT, sub {
-        $self->make_skirt;
-    });
-    $print_step->(STEP_BRIM, sub {
-        $self->make_brim;  # must come after make_skirt
-    });
-    
-    # time to make some statistics
-    if (0) {
-        eval "use Devel::Size";
-        print  "MEMORY USAGE:\n";
-        printf "  meshes        = %.1fMb\n", List::Util::sum(map Devel::Size::total_size($_->meshes), @{$self->objects})/1024/1024;
-        printf "  layer slices  = %.1fMb\n", List::Util::sum(map Devel::Size::total_size($_->slices), map @{$_->layers}, @{$self->objects})/1024/1024;
-        printf "  region slices = %.1fMb\n", List::Util::sum(map Devel::Size::total_size($_->slices), map @{$_->regions}, map @{$_->layers}, @{$self->objects})/1024/1024;
-        printf "  perimeters    = %.1fMb\n", List::Util::sum(map Devel::Size::total_size($_->perimeters), map @{$_->regions}, map @{$_->layers}, @{$self->objects})/1024/1024;
-        printf "  fills         = %.1fMb\n", List::Util::sum(map Devel::Size::total_size($_->fills), map @{$_->regions}, map @{$_->layers}, @{$self->objects})/1024/1024;
-        printf "  print object  = %.1fMb\n", Devel::Size::total_size($self)/1024/1024;
-    }
+    $print_step->(STEP_SKIRT);
+    $print_step->(STEP_BRIM);
+    
     if (0) {
         eval "use Slic3r::Test::SectionCut";
         Slic3r::Test::SectionCut->new(print => $self)->export_svg("section_cut.svg");
     }
 }
 
+# runs the callback of a step, measuring it if we have a profiler
+sub _profile_step {
+    my ($self, $step, $obj_idx, $cb) = @_;
+    
+    return $cb->($obj_idx) if !$self->profiler;
+    $self->profiler->measure(
+        $Slic3r::Print::State::step_names{$step}, $obj_idx, sub { $cb->($obj_idx) },
+        sub {
+            my ($counts) = @_;
+            if (defined $obj_idx) {
+                $counts->add_object($self->objects->[$obj_idx]->_native);
+            } elsif ($step == STEP_SKIRT) {
+                $counts->add_collection($self->skirt);
+            } elsif ($step == STEP_BRIM) {
+                $counts->add_collection($self->brim);
+            }
+        },
+    );
+}
+
 sub export_gcode {
     my $self = shift;
     my %params = @_;
@@ -531,6 +571,8 @@ sub export_svg {
     # is this needed?
     $self->init_extruders;
     
+    # slicing again discards the results of the following steps
+    $self->invalidate_step(STEP_SLICE);
     $_->slice for @{$self->objects};
     
     my $fh = $params{output_fh};
@@ -617,10 +659,10 @@ EOF
 
 sub make_skirt {
     my $self = shift;
-    return unless $self->config->skirts > 0
-        || ($self->config->ooze_prevention && @{$self->extruders} > 1);
     
     $self->skirt->clear;  # method must be idempotent
+    return unless $self->config->skirts > 0
+        || ($self->config->ooze_prevention && @{$self->extruders} > 1);
     
     # First off we need to decide how tall the skirt must be.
     # The skirt_height option from config is expressed in layers, but our
@@ -643,36 +685,24 @@ sub make_skirt {
     }
     
     # collect points from all layers contained in skirt height
-    my @points = ();
+    my $skirt_brim = Slic3r::Print::SkirtBrim->new;
     foreach my $object (@{$self->objects}) {
-        my @object_points = ();
-        
         # get object layers up to $skirt_height_z
         foreach my $layer (@{$object->layers}) {
             last if $layer->print_z > $skirt_height_z;
-            push @object_points, map @$_, map @$_, @{$layer->slices};
+            $skirt_brim->add_skirt_slices($layer->slices);
         }
         
         # get support layers up to $skirt_height_z
         foreach my $layer (@{$object->support_layers}) {
             last if $layer->print_z > $skirt_height_z;
-            push @object_points, map @{$_->polyline}, @{$layer->support_fills} if $layer->support_fills;
-            push @object_points, map @{$_->polyline}, @{$layer->support_interface_fills} if $layer->support_interface_fills;
+            $skirt_brim->add_skirt_paths($layer->support_fills) if $layer->support_fills;
+            $skirt_brim->add_skirt_paths($layer->support_interface_fills) if $layer->support_interface_fills;
         }
         
-        # repeat points for each object copy
-        foreach my $copy (@{$object->_shifted_copies}) {
-            my @copy_points = map $_->clone, @object_points;
-            $_->translate(@$copy) for @copy_points;
-            push @points, @copy_points;
-        }
+        # repeat the object hull for each object copy
+        $skirt_brim->add_skirt_copies($object->_shifted_copies);
     }
-    return if @points < 3;  # at least three points required for a convex hull
-    
-    # find out convex hull
-    my $convex_hull = convex_hull(\@points);
-    
-    my @extruded_length = ();  # for each extruder
     
     # skirt may be printed on several layers, having distinct layer heights,
     # but loops must be aligned so can't vary width/spacing
@@ -685,49 +715,32 @@ sub make_skirt {
         layer_height        => $first_layer_height,
         bridge_flow_ratio   => 0,
     );
-    my $spacing = $flow->spacing;
     my $mm3_per_mm = $flow->mm3_per_mm($first_layer_height);
     
     my @extruders_e_per_mm = ();
-    my $extruder_idx = 0;
+    if ($self->config->min_skirt_length > 0) {
+        @extruders_e_per_mm = map Slic3r::Extruder->new_from_config($self->config, $_)->e_per_mm($mm3_per_mm),
+            0 .. $#{$self->extruders};
+    }
     
     # draw outlines from outside to inside
     # loop while we have less skirts than required or any extruder hasn't reached the min length if any
-    my $distance = scale $self->config->skirt_distance;
-    for (my $i = $self->config->skirts; $i > 0; $i--) {
-        $distance += scale $spacing;
-        my $loop = offset([$convex_hull], $distance, 1, JT_ROUND, scale(0.1))->[0];
-        $self->skirt->append(Slic3r::ExtrusionLoop->new(
-            polygon         => Slic3r::Polygon->new(@$loop),
-            role            => EXTR_ROLE_SKIRT,
-            mm3_per_mm      => $mm3_per_mm,
-        ));
-        
-        if ($self->config->min_skirt_length > 0) {
-            $extruded_length[$extruder_idx] ||= 0;
-            if (!$extruders_e_per_mm[$extruder_idx]) {
-                my $extruder = Slic3r::Extruder->new_from_config($self->config, $extruder_idx);
-                $extruders_e_per_mm[$extruder_idx] = $extruder->e_per_mm($mm3_per_mm);
-            }
-            $extruded_length[$extruder_idx] += unscale $loop->length * $extruders_e_per_mm[$extruder_idx];
-            $i++ if defined first { ($extruded_length[$_] // 0) < $self->config->min_skirt_length } 0 .. $#{$self->extruders};
-            if ($extruded_length[$extruder_idx] >= $self->config->min_skirt_length) {
-                if ($extruder_idx < $#{$self->extruders}) {
-                    $extruder_idx++;
-                    next;
-                }
-            }
-        }
-    }
-    
-    $self->skirt->reverse;
+    $skirt_brim->make_skirt(
+        $self->skirt,
+        $self->config->skirts,
+        scale $self->config->skirt_distance,
+        scale $flow->spacing,
+        $mm3_per_mm,
+        $self->config->min_skirt_length,
+        \@extruders_e_per_mm,
+    );
 }
 
 sub make_brim {
     my $self = shift;
-    return unless $self->config->brim_width > 0;
     
     $self->brim->clear;  # method must be idempotent
+    return unless $self->config->brim_width > 0;
     
     # brim is only printed on first layer and uses support material extruder
     my $first_layer_height = $self->objects->[0]->config->get_abs_value('first_layer_height');
@@ -741,63 +754,48 @@ sub make_brim {
     my $mm3_per_mm = $flow->mm3_per_mm($first_layer_height);
     
     my $grow_distance = $flow->scaled_width / 2;
-    my @islands = (); # array of polygons
-    foreach my $obj_idx (0 .. $#{$self->objects}) {
-        my $object = $self->objects->[$obj_idx];
-        my $layer0 = $object->layers->[0];
-        my @object_islands = (
-            (map $_->contour, @{$layer0->slices}),
-        );
+    my $skirt_brim = Slic3r::Print::SkirtBrim->new;
+    foreach my $object (@{$self->objects}) {
+        $skirt_brim->add_brim_slices($object->layers->[0]->slices);
         if (@{ $object->support_layers }) {
             my $support_layer0 = $object->support_layers->[0];
-            push @object_islands,
-                (map @{$_->polyline->grow($grow_distance)}, @{$support_layer0->support_fills})
+            $skirt_brim->add_brim_paths($support_layer0->support_fills, $grow_distance)
                 if $support_layer0->support_fills;
-            push @object_islands,
-                (map @{$_->polyline->grow($grow_distance)}, @{$support_layer0->support_interface_fills})
+            $skirt_brim->add_brim_paths($support_layer0->support_interface_fills, $grow_distance)
                 if $support_layer0->support_interface_fills;
         }
-        foreach my $copy (@{$object->_shifted_copies}) {
-            push @islands, map { $_->translate(@$copy); $_ } map $_->clone, @object_islands;
-        }
+        $skirt_brim->add_brim_copies($object->_shifted_copies);
     }
     
     # if brim touches skirt, make it around skirt too
     # TODO: calculate actual skirt width (using each extruder's flow in multi-extruder setups)
     if ($self->config->skirt_distance + (($self->config->skirts - 1) * $flow->spacing) <= $self->config->brim_width) {
-        push @islands, map @{$_->split_at_first_point->polyline->grow($grow_distance)}, @{$self->skirt};
+        $skirt_brim->add_brim_loops($self->skirt, $grow_distance);
     }
     
-    my @loops = ();
     my $num_loops = sprintf "%.0f", $self->config->brim_width / $flow->width;
-    for my $i (reverse 1 .. $num_loops) {
-        # JT_SQUARE ensures no vertex is outside the given offset distance
-        # -0.5 because islands are not represented by their centerlines
-        # (first offset more, then step back - reverse order than the one used for 
-        # perimeters because here we're offsetting outwards)
-        push @loops, @{offset2(\@islands, ($i + 0.5) * $flow->scaled_spacing, -1.0 * $flow->scaled_spacing, 100000, JT_SQUARE)};
-    }
-    
-    $self->brim->append(map Slic3r::ExtrusionLoop->new(
-        polygon         => Slic3r::Polygon->new(@$_),
-        role            => EXTR_ROLE_SKIRT,
-        mm3_per_mm      => $mm3_per_mm,
-    ), reverse @{union_pt_chained(\@loops)});
+    $skirt_brim->make_brim($self->brim, $num_loops, $flow->scaled_spacing, $mm3_per_mm);
 }
 
 sub write_gcode {
     my $self = shift;
     my ($file) = @_;
     
+    my $profiler_start = $self->profiler && $self->profiler->start;
+    
     # open output gcode file if we weren't supplied a file-handle
     my $fh;
     if (ref $file eq 'IO::Scalar') {
         $fh = $file;
     } else {
-        Slic3r::open(\$fh, ">", $file)
-            or die "Failed to open $file for writing\n";
+        $fh = Slic3r::GCode::StreamWriter->open(
+            file    => $file,
+            threads => $self->config->threads,
+        );
     }
     
+    $self->estimated_print_time(0);
+    
     # write some information
     my @lt = localtime;
     printf $fh "; generated by Slic3r $Slic3r::VERSION on %04d-%02d-%02d at %02d:%02d:%02d\n\n",
@@ -912,6 +910,24 @@ sub write_gcode {
         gcodegen    => $gcodegen,
     );
     
+    # the seam candidates of the perimeter loops don't depend on the extruder
+    # position, so they're computed natively on the pool for a batch of layers
+    # before the G-code of those layers is emitted in order; when neither option
+    # is set every point of the loop is a candidate and there's nothing to compute
+    my $seams_batch = 8 * $self->thread_pool->size;
+    my $prepare_seams;
+    if ($self->config->start_perimeters_at_concave_points || $self->config->start_perimeters_at_non_overhang) {
+        $prepare_seams = sub {
+            my $seams = Slic3r::GCode::Seams->new(
+                $self->config->start_perimeters_at_concave_points,
+                $self->config->start_perimeters_at_non_overhang,
+            );
+            $seams->add_layer($_->_native) for grep !$_->isa('Slic3r::Layer::Support'), @_;
+            $seams->process($self->thread_pool);
+            $gcodegen->seams($seams);
+        };
+    }
+    
     # set initial extruder only after custom start G-code
     print $fh $gcodegen->set_extruder($self->extruders->[0]);
     
@@ -940,7 +956,11 @@ sub write_gcode {
                 
                 my $object = $self->objects->[$obj_idx];
                 my @layers = sort { $a->print_z <=> $b->print_z } @{$object->layers}, @{$object->support_layers};
-                for my $layer (@layers) {
+                for my $i (0 .. $#layers) {
+                    my $layer = $layers[$i];
+                    $prepare_seams->(@layers[$i .. min($i+$seams_batch, scalar @layers)-1])
+                        if $prepare_seams && $i % $seams_batch == 0;
+                    
                     # if we are printing the bottom layer of an object, and we have already finished
                     # another one, set first layer temperatures. this happens before the Z move
                     # is triggered, so machine has more time to reach such temperatures
@@ -957,6 +977,7 @@ sub write_gcode {
                     );
                 }
                 print $fh $buffer->flush;
+                $self->estimated_print_time($self->estimated_print_time + $buffer->estimator->total_time);
                 $finished_objects++;
             }
         }
@@ -979,7 +1000,12 @@ sub write_gcode {
             config      => $self->config,
             gcodegen    => $gcodegen,
         );
-        foreach my $print_z (sort { $a <=> $b } keys %layers) {
+        my @print_z = sort { $a <=> $b } keys %layers;
+        foreach my $i (0 .. $#print_z) {
+            my $print_z = $print_z[$i];
+            $prepare_seams->(map @{$_ // []}, map @{$layers{$_}}, @print_z[$i .. min($i+$seams_batch, scalar @print_z)-1])
+                if $prepare_seams && $i % $seams_batch == 0;
+            
             foreach my $obj_idx (@obj_idx) {
                 foreach my $layer (@{ $layers{$print_z}[$obj_idx] // [] }) {
                     print $fh $buffer->append(
@@ -992,6 +1018,7 @@ sub write_gcode {
             }
         }
         print $fh $buffer->flush;
+        $self->estimated_print_time($buffer->estimator->total_time);
     }
     
     # write end commands to file
@@ -1013,6 +1040,11 @@ sub write_gcode {
         $self->total_used_filament($self->total_used_filament + $used_filament);
         $self->total_extruded_volume($self->total_extruded_volume + $extruded_volume);
     }
+    {
+        my $time = int($self->estimated_print_time + 0.5);
+        printf $fh "; estimated printing time = %dh %dm %ds\n",
+            int($time / 3600), int(($time % 3600) / 60), $time % 60;
+    }
     
     # append full config
     print $fh "\n";
@@ -1021,6 +1053,14 @@ sub write_gcode {
         printf $fh "; %s = %s\n", $opt_key, $self->config->serialize($opt_key);
     }
     
+    if ($self->profiler) {
+        $self->profiler->stop($profiler_start, 'export');
+        if ($self->profiler->gcode_comments) {
+            print $fh "\n";
+            print $fh $self->profiler->as_gcode_comments;
+        }
+    }
+    
     # close our gcode file
     close $fh;
 }
@@ -1071,7 +1111,7 @@ sub invalidate_step {
     my ($self, $step, $obj_idx) = @_;
     
     # invalidate $step in the correct state object
-    if ($Slic3r::Print::State::print_step->{$step}) {
+    if ($Slic3r::Print::State::print_steps{$step}) {
         $self->_state->invalidate($step);
     } else {
         # object step
@@ -1083,11 +1123,32 @@ sub invalidate_step {
     }
     
     # recursively invalidate steps depending on $step
-    $self->invalidate_step($_)
+    $self->invalidate_step($_, $obj_idx)
         for grep { grep { $_ == $step } @{$Slic3r::Print::State::prereqs{$_}} }
             keys %Slic3r::Print::State::prereqs;
 }
 
+sub invalidate_all_steps {
+    my ($self) = @_;
+    
+    $self->_state->invalidate_all;
+    $_->_state->invalidate_all for @{$self->objects};
+}
+
+# invalidate the steps whose results depend on the given config options;
+# object steps are only invalidated for $obj_idx, if supplied
+sub invalidate_state_by_config_options {
+    my ($self, $opt_keys, $obj_idx) = @_;
+    
+    my %steps = ();
+    foreach my $opt_key (@$opt_keys) {
+        my $steps = $Slic3r::Print::State::option_steps{$opt_key}
+            // [ keys %Slic3r::Print::State::prereqs ];
+        $steps{$_} = 1 for @$steps;
+    }
+    $self->invalidate_step($_, $obj_idx) for keys %steps;
+}
+
 # This method assigns extruders to the volumes having a material
 # but not having extruders set in the material config.
 sub auto_assign_extruders {
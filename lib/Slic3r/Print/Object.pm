@@ -19,8 +19,9 @@ has 'layer_height_ranges' => (is => 'rw', default => sub { [] }); # [ z_min, z_m
 has 'size'              => (is => 'rw'); # XYZ in scaled coordinates
 has '_copies_shift'     => (is => 'rw');  # scaled coordinates to add to copies (to compensate for the alignment operated when creating the object but still preserving a coherent API for external callers)
 has '_shifted_copies'   => (is => 'rw');  # Slic3r::Point objects in scaled G-code coordinates in our coordinates
-has 'layers'            => (is => 'rw', default => sub { [] });
-has 'support_layers'    => (is => 'rw', default => sub { [] });
+has 'layers'            => (is => 'ro', default => sub { [] });
+has 'support_layers'    => (is => 'ro', default => sub { [] });
+has '_native'           => (is => 'ro', default => sub { Slic3r::Print::Object::Native->new });  # owns the layer data
 has 'fill_maker'        => (is => 'lazy');
 has '_state'            => (is => 'ro', default => sub { Slic3r::Print::State->new });
 
@@ -116,6 +117,82 @@ sub bounding_box {
     ]);
 }
 
+# layers are created and removed only through the following methods,
+# which keep the Perl objects in sync with the native storage
+sub add_layer {
+    my ($self, %args) = @_;
+    
+    my $layer = Slic3r::Layer->new(
+        object  => $self,
+        _native => $self->_native->add_layer(@args{qw(id height print_z slice_z)}),
+    );
+    push @{$self->layers}, $layer;
+    return $layer;
+}
+
+sub delete_layer {
+    my ($self, $idx) = @_;
+    
+    splice @{$self->layers}, $idx, 1;
+    $self->_native->delete_layer($idx);
+    $self->layers->[$idx-1]->upper_layer($self->layers->[$idx])
+        if $idx > 0;
+}
+
+sub clear_layers {
+    my $self = shift;
+    
+    @{$self->layers} = ();
+    $self->_native->clear_layers;
+}
+
+sub add_support_layer {
+    my ($self, %args) = @_;
+    
+    my $layer = Slic3r::Layer::Support->new(
+        object  => $self,
+        _native => $self->_native->add_support_layer(@args{qw(id height print_z slice_z)}),
+    );
+    push @{$self->support_layers}, $layer;
+    return $layer;
+}
+
+sub clear_support_layers {
+    my $self = shift;
+    
+    @{$self->support_layers} = ();
+    $self->_native->clear_support_layers;
+}
+
+# rebuilds the Perl objects from the native storage; a clone of this object
+# living in another thread (such as the plater's export thread) shares the
+# native layers with us, but not the Perl objects wrapping them
+sub sync_layers {
+    my $self = shift;
+    
+    @{$self->layers} = ();
+    for my $i (0 .. $self->_native->layer_count-1) {
+        my $layer = Slic3r::Layer->new(
+            object  => $self,
+            _native => $self->_native->get_layer($i),
+        );
+        for my $region_id (0 .. $layer->_native->region_count-1) {
+            $layer->regions->[$region_id] = Slic3r::Layer::Region->new(
+                layer   => $layer,
+                region  => $self->print->regions->[$region_id],
+                _native => $layer->_native->get_region($region_id),
+            );
+        }
+        $self->layers->[-1]->upper_layer($layer) if @{$self->layers};
+        push @{$self->layers}, $layer;
+    }
+    
+    @{$self->support_layers} = map Slic3r::Layer::Support->new(
+        object  => $self,
+        _native => $self->_native->get_support_layer($_),
+    ), 0 .. $self->_native->support_layer_count-1;
+}
+
 # this should be idempotent
 sub slice {
     my $self = shift;
@@ -123,7 +200,7 @@ sub slice {
     
     # init layers
     {
-        @{$self->layers} = ();
+        $self->clear_layers;
     
         # make layers taking custom heights into account
         my $print_z = my $slice_z = my $height = my $id = 0;
@@ -176,8 +253,7 @@ sub slice {
         
             ### Slic3r::debugf "Layer %d: height = %s; slice_z = %s; print_z = %s\n", $id, $height, $slice_z, $print_z;
         
-            push @{$self->layers}, Slic3r::Layer->new(
-                object  => $self,
+            $self->add_layer(
                 id      => $id,
                 height  => $height,
                 print_z => $print_z,
@@ -253,12 +329,11 @@ sub slice {
     }
     
     # remove last layer(s) if empty
-    pop @{$self->layers} while @{$self->layers} && (!map @{$_->slices}, @{$self->layers->[-1]->regions});
+    $self->delete_layer($#{$self->layers})
+        while @{$self->layers} && (!map @{$_->slices}, @{$self->layers->[-1]->regions});
     
-    foreach my $layer (@{ $self->layers }) {
-        # merge all regions' slices to get islands
-        $layer->make_slices;
-    }
+    # merge all regions' slices to get islands
+    $self->_native->make_slices($self->print->thread_pool);
     
     # detect slicing errors
     my $warning_thrown = 0;
@@ -315,7 +390,7 @@ sub slice {
     # remove empty layers from bottom
     my $first_object_layer_id = $self->config->raft_layers;
     while (@{$self->layers} && !@{$self->layers->[$first_object_layer_id]->slices}) {
-        splice @{$self->layers}, $first_object_layer_id, 1;
+        $self->delete_layer($first_object_layer_id);
         for (my $i = $first_object_layer_id; $i <= $#{$self->layers}; $i++) {
             $self->layers->[$i]->id($i);
         }
@@ -325,6 +400,9 @@ sub slice {
     if ($self->print->config->resolution) {
         $self->_simplify_slices(scale($self->print->config->resolution));
     }
+    
+    # keep the untyped slices, so that the following steps can be repeated without reslicing
+    $_->backup_slices for map @{$_->regions}, @{$self->layers};
 }
 
 sub _slice_region {
@@ -349,19 +427,26 @@ sub _slice_region {
 
     # transform mesh
     # we ignore the per-instance transformations currently and only 
-    # consider the first one
-    $self->model_object->instances->[0]->transform_mesh($mesh, 1);
-
-    # align mesh to Z = 0 and apply XY shift
-    $mesh->translate((map unscale(-$_), @{$self->_copies_shift}), -$self->model_object->bounding_box->z_min);
-    
-    # perform actual slicing
-    return $mesh->slice($z);
+    # consider the first one; the same pass aligns mesh to Z = 0 and 
+    # applies XY shift
+    my $instance = $self->model_object->instances->[0];
+    $mesh->transform($instance->rotation, $instance->scaling_factor,
+        (map unscale(-$_), @{$self->_copies_shift}), -$self->model_object->bounding_box->z_min);
+    
+    # perform actual slicing, unless the same mesh was already sliced
+    # at the same heights and the result is in the cache
+    return defined $Slic3r::slice_cache_dir
+        ? $mesh->slice($z, $Slic3r::slice_cache_dir)
+        : $mesh->slice($z);
 }
 
 sub make_perimeters {
     my $self = shift;
     
+    # start from the slices as they were sliced, as a previous run of
+    # prepare_infill might have split them into types
+    $_->restore_slices for map @{$_->regions}, @{$self->layers};
+    
     # compare each layer to the one below, and mark those slices needing
     # one additional inner perimeter, like the top of domed objects-
     
@@ -446,100 +531,23 @@ sub detect_surfaces_type {
     my $self = shift;
     Slic3r::debugf "Detecting solid surfaces...\n";
     
+    # classify slices into bottom, top and internal surfaces and clip them to the
+    # fill boundaries; layers are processed in parallel on the native thread pool,
+    # comparing each layer against
+    # the *full* slices (considering all regions) of its neighbours; very narrow
+    # parts are collapsed (using the safety offset in the diff is not enough)
     for my $region_id (0 .. ($self->print->regions_count-1)) {
-        for my $i (0 .. $#{$self->layers}) {
-            my $layerm = $self->layers->[$i]->regions->[$region_id];
-        
-            # prepare a reusable subroutine to make surface differences
-            my $difference = sub {
-                my ($subject, $clip, $result_type) = @_;
-                my $diff = diff(
-                    [ map @$_, @$subject ],
-                    [ map @$_, @$clip ],
-                );
-                
-                # collapse very narrow parts (using the safety offset in the diff is not enough)
-                my $offset = $layerm->flow(FLOW_ROLE_PERIMETER)->scaled_width / 10;
-                return map Slic3r::Surface->new(expolygon => $_, surface_type => $result_type),
-                    @{ offset2_ex($diff, -$offset, +$offset) };
-            };
-            
-            # comparison happens against the *full* slices (considering all regions)
-            my $upper_layer = $self->layers->[$i+1];
-            my $lower_layer = $i > 0 ? $self->layers->[$i-1] : undef;
-            
-            my (@bottom, @top, @internal) = ();
-            
-            # find top surfaces (difference between current surfaces
-            # of current layer and upper one)
-            if ($upper_layer) {
-                @top = $difference->(
-                    [ map $_->expolygon, @{$layerm->slices} ],
-                    $upper_layer->slices,
-                    S_TYPE_TOP,
-                );
-            } else {
-                # if no upper layer, all surfaces of this one are solid
-                # we clone surfaces because we're going to clear the slices collection
-                @top = map $_->clone, @{$layerm->slices};
-                $_->surface_type(S_TYPE_TOP) for @top;
-            }
-            
-            # find bottom surfaces (difference between current surfaces
-            # of current layer and lower one)
-            if ($lower_layer) {
-                # lower layer's slices are already Surface objects
-                @bottom = $difference->(
-                    [ map $_->expolygon, @{$layerm->slices} ],
-                    $lower_layer->slices,
-                    S_TYPE_BOTTOM,
-                );
-            } else {
-                # if no lower layer, all surfaces of this one are solid
-                # we clone surfaces because we're going to clear the slices collection
-                @bottom = map $_->clone, @{$layerm->slices};
-                $_->surface_type(S_TYPE_BOTTOM) for @bottom;
-            }
-            
-            # now, if the object contained a thin membrane, we could have overlapping bottom
-            # and top surfaces; let's do an intersection to discover them and consider them
-            # as bottom surfaces (to allow for bridge detection)
-            if (@top && @bottom) {
-                my $overlapping = intersection_ex([ map $_->p, @top ], [ map $_->p, @bottom ]);
-                Slic3r::debugf "  layer %d contains %d membrane(s)\n", $layerm->id, scalar(@$overlapping)
-                    if $Slic3r::debug;
-                @top = $difference->([map $_->expolygon, @top], $overlapping, S_TYPE_TOP);
-            }
-            
-            # find internal surfaces (difference between top/bottom surfaces and others)
-            @internal = $difference->(
-                [ map $_->expolygon, @{$layerm->slices} ],
-                [ map $_->expolygon, @top, @bottom ],
-                S_TYPE_INTERNAL,
-            );
-            
-            # save surfaces to layer
-            $layerm->slices->clear;
-            $layerm->slices->append(@bottom, @top, @internal);
-            
+        $self->_native->detect_surfaces_type(
+            $region_id,
+            [ map $_->region($region_id)->flow(FLOW_ROLE_PERIMETER)->scaled_width / 10, @{$self->layers} ],
+            $self->print->thread_pool,
+        );
+    }
+    
+    if ($Slic3r::debug) {
+        foreach my $layerm (map @{$_->regions}, @{$self->layers}) {
             Slic3r::debugf "  layer %d has %d bottom, %d top and %d internal surfaces\n",
-                $layerm->id, scalar(@bottom), scalar(@top), scalar(@internal) if $Slic3r::debug;
-        }
-        
-        # clip surfaces to the fill boundaries
-        foreach my $layer (@{$self->layers}) {
-            my $layerm = $layer->regions->[$region_id];
-            my $fill_boundaries = [ map $_->clone->p, @{$layerm->fill_surfaces} ];
-            $layerm->fill_surfaces->clear;
-            foreach my $surface (@{$layerm->slices}) {
-                my $intersection = intersection_ex(
-                    [ $surface->p ],
-                    $fill_boundaries,
-                );
-                $layerm->fill_surfaces->append(map Slic3r::Surface->new
-                    (expolygon => $_, surface_type => $surface->surface_type),
-                    @$intersection);
-            }
+                $layerm->id, (map scalar(@{$layerm->slices->filter_by_type($_)}), S_TYPE_BOTTOM, S_TYPE_TOP, S_TYPE_INTERNAL);
         }
     }
 }
@@ -675,15 +683,37 @@ sub bridge_over_infill {
     }
 }
 
-sub process_external_surfaces {
-    my ($self) = @_;
+# does the work of detect_surfaces_type(), of prepare_fill_surfaces() and
+# process_external_surfaces() of each layer region and of
+# discover_horizontal_shells() as a single task graph on the native thread
+# pool: each layer region goes through these stages with no barrier between
+# them, and the shells of a region start as soon as all its layers are done
+sub prepare_fill_surfaces {
+    my $self = shift;
+    Slic3r::debugf "Preparing fill surfaces...\n";
     
+    my $preparer = Slic3r::Print::Object::InfillPreparer->new(scale &Slic3r::EXTERNAL_INFILL_MARGIN);
     for my $region_id (0 .. ($self->print->regions_count-1)) {
-        $self->layers->[0]->regions->[$region_id]->process_external_surfaces(undef);
-        for my $i (1 .. $#{$self->layers}) {
-            $self->layers->[$i]->regions->[$region_id]->process_external_surfaces($self->layers->[$i-1]);
+        my $config = $self->print->regions->[$region_id]->config;
+        $preparer->add_region(
+            $config->top_solid_layers,
+            $config->bottom_solid_layers,
+            $config->solid_infill_every_layers,
+            $config->fill_density > 0 ? 1 : 0,
+            scale scale $config->solid_infill_below_area,  # scaling an area requires two calls!
+        );
+        foreach my $layer (@{$self->layers}) {
+            my $layerm = $layer->region($region_id);
+            $preparer->add_layer(
+                $region_id,
+                $layerm->_native,
+                $layerm->flow(FLOW_ROLE_PERIMETER)->scaled_width,
+                $layerm->flow(FLOW_ROLE_INFILL)->scaled_width,
+                $layerm->flow(FLOW_ROLE_SOLID_INFILL)->scaled_width,
+            );
         }
     }
+    $preparer->process($self->print->thread_pool);
 }
 
 sub discover_horizontal_shells {
@@ -691,146 +721,29 @@ sub discover_horizontal_shells {
     
     Slic3r::debugf "==> DISCOVERING HORIZONTAL SHELLS\n";
     
+    # Shells are propagated natively; regions don't share any surface, so they
+    # are processed in parallel on the native thread pool.
+    my @shells = ();
     for my $region_id (0 .. ($self->print->regions_count-1)) {
-        for (my $i = 0; $i <= $#{$self->layers}; $i++) {
-            my $layerm = $self->layers->[$i]->regions->[$region_id];
-            
-            if ($layerm->config->solid_infill_every_layers && $layerm->config->fill_density > 0
-                && ($i % $layerm->config->solid_infill_every_layers) == 0) {
-                $_->surface_type(S_TYPE_INTERNALSOLID) for @{$layerm->fill_surfaces->filter_by_type(S_TYPE_INTERNAL)};
-            }
-            
-            EXTERNAL: foreach my $type (S_TYPE_TOP, S_TYPE_BOTTOM) {
-                # find slices of current type for current layer
-                # use slices instead of fill_surfaces because they also include the perimeter area
-                # which needs to be propagated in shells; we need to grow slices like we did for
-                # fill_surfaces though.  Using both ungrown slices and grown fill_surfaces will
-                # not work in some situations, as there won't be any grown region in the perimeter 
-                # area (this was seen in a model where the top layer had one extra perimeter, thus
-                # its fill_surfaces were thinner than the lower layer's infill), however it's the best
-                # solution so far. Growing the external slices by EXTERNAL_INFILL_MARGIN will put
-                # too much solid infill inside nearly-vertical slopes.
-                my $solid = [
-                    (map $_->p, @{$layerm->slices->filter_by_type($type)}),
-                    (map $_->p, @{$layerm->fill_surfaces->filter_by_type($type)}),
-                ];
-                next if !@$solid;
-                Slic3r::debugf "Layer %d has %s surfaces\n", $i, ($type == S_TYPE_TOP) ? 'top' : 'bottom';
-                
-                my $solid_layers = ($type == S_TYPE_TOP)
-                    ? $layerm->config->top_solid_layers
-                    : $layerm->config->bottom_solid_layers;
-                NEIGHBOR: for (my $n = ($type == S_TYPE_TOP) ? $i-1 : $i+1; 
-                        abs($n - $i) <= $solid_layers-1; 
-                        ($type == S_TYPE_TOP) ? $n-- : $n++) {
-                    
-                    next if $n < 0 || $n > $#{$self->layers};
-                    Slic3r::debugf "  looking for neighbors on layer %d...\n", $n;
-                    
-                    my $neighbor_layerm = $self->layers->[$n]->regions->[$region_id];
-                    my $neighbor_fill_surfaces = $neighbor_layerm->fill_surfaces;
-                    my @neighbor_fill_surfaces = map $_->clone, @$neighbor_fill_surfaces;  # clone because we will use these surfaces even after clearing the collection
-                    
-                    # find intersection between neighbor and current layer's surfaces
-                    # intersections have contours and holes
-                    # we update $solid so that we limit the next neighbor layer to the areas that were
-                    # found on this one - in other words, solid shells on one layer (for a given external surface)
-                    # are always a subset of the shells found on the previous shell layer
-                    # this approach allows for DWIM in hollow sloping vases, where we want bottom
-                    # shells to be generated in the base but not in the walls (where there are many
-                    # narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the 
-                    # upper perimeter as an obstacle and shell will not be propagated to more upper layers
-                    my $new_internal_solid = $solid = intersection(
-                        $solid,
-                        [ map $_->p, grep { ($_->surface_type == S_TYPE_INTERNAL) || ($_->surface_type == S_TYPE_INTERNALSOLID) } @neighbor_fill_surfaces ],
-                        1,
-                    );
-                    next EXTERNAL if !@$new_internal_solid;
-                    
-                    if ($layerm->config->fill_density == 0) {
-                        # if we're printing a hollow object we discard any solid shell thinner
-                        # than a perimeter width, since it's probably just crossing a sloping wall
-                        # and it's not wanted in a hollow print even if it would make sense when
-                        # obeying the solid shell count option strictly (DWIM!)
-                        my $margin = $neighbor_layerm->flow(FLOW_ROLE_PERIMETER)->scaled_width;
-                        my $too_narrow = diff(
-                            $new_internal_solid,
-                            offset2($new_internal_solid, -$margin, +$margin, CLIPPER_OFFSET_SCALE, JT_MITER, 5),
-                            1,
-                        );
-                        $new_internal_solid = $solid = diff(
-                            $new_internal_solid,
-                            $too_narrow,
-                        ) if @$too_narrow;
-                    }
-                    
-                    # make sure the new internal solid is wide enough, as it might get collapsed
-                    # when spacing is added in Fill.pm
-                    {
-                        my $margin = 3 * $layerm->flow(FLOW_ROLE_SOLID_INFILL)->scaled_width; # require at least this size
-                        # we use a higher miterLimit here to handle areas with acute angles
-                        # in those cases, the default miterLimit would cut the corner and we'd
-                        # get a triangle in $too_narrow; if we grow it below then the shell
-                        # would have a different shape from the external surface and we'd still
-                        # have the same angle, so the next shell would be grown even more and so on.
-                        my $too_narrow = diff(
-                            $new_internal_solid,
-                            offset2($new_internal_solid, -$margin, +$margin, CLIPPER_OFFSET_SCALE, JT_MITER, 5),
-                            1,
-                        );
-                        
-                        if (@$too_narrow) {
-                            # grow the collapsing parts and add the extra area to  the neighbor layer 
-                            # as well as to our original surfaces so that we support this 
-                            # additional area in the next shell too
-                        
-                            # make sure our grown surfaces don't exceed the fill area
-                            my @grown = @{intersection(
-                                offset($too_narrow, +$margin),
-                                [ map $_->p, @neighbor_fill_surfaces ],
-                            )};
-                            $new_internal_solid = $solid = [ @grown, @$new_internal_solid ];
-                        }
-                    }
-                    
-                    # internal-solid are the union of the existing internal-solid surfaces
-                    # and new ones
-                    my $internal_solid = union_ex([
-                        ( map $_->p, grep $_->surface_type == S_TYPE_INTERNALSOLID, @neighbor_fill_surfaces ),
-                        @$new_internal_solid,
-                    ]);
-                    
-                    # subtract intersections from layer surfaces to get resulting internal surfaces
-                    my $internal = diff_ex(
-                        [ map $_->p, grep $_->surface_type == S_TYPE_INTERNAL, @neighbor_fill_surfaces ],
-                        [ map @$_, @$internal_solid ],
-                        1,
-                    );
-                    Slic3r::debugf "    %d internal-solid and %d internal surfaces found\n",
-                        scalar(@$internal_solid), scalar(@$internal);
-                    
-                    # assign resulting internal surfaces to layer
-                    $neighbor_fill_surfaces->clear;
-                    $neighbor_fill_surfaces->append(map Slic3r::Surface->new
-                        (expolygon => $_, surface_type => S_TYPE_INTERNAL), @$internal);
-                    
-                    # assign new internal-solid surfaces to layer
-                    $neighbor_fill_surfaces->append(map Slic3r::Surface->new
-                        (expolygon => $_, surface_type => S_TYPE_INTERNALSOLID), @$internal_solid);
-                    
-                    # assign top and bottom surfaces to layer
-                    foreach my $s (@{Slic3r::Surface::Collection->new(grep { ($_->surface_type == S_TYPE_TOP) || ($_->surface_type == S_TYPE_BOTTOM) } @neighbor_fill_surfaces)->group}) {
-                        my $solid_surfaces = diff_ex(
-                            [ map $_->p, @$s ],
-                            [ map @$_, @$internal_solid, @$internal ],
-                            1,
-                        );
-                        $neighbor_fill_surfaces->append(map $s->[0]->clone(expolygon => $_), @$solid_surfaces);
-                    }
-                }
-            }
+        my $config = $self->print->regions->[$region_id]->config;
+        my $shells = Slic3r::Print::Object::HorizontalShells->new(
+            $config->top_solid_layers,
+            $config->bottom_solid_layers,
+            $config->solid_infill_every_layers,
+            $config->fill_density == 0 ? 1 : 0,
+        );
+        foreach my $layer (@{$self->layers}) {
+            my $layerm = $layer->regions->[$region_id];
+            $shells->add_layer(
+                $layerm->slices,
+                $layerm->fill_surfaces,
+                $layerm->flow(FLOW_ROLE_PERIMETER)->scaled_width,
+                $layerm->flow(FLOW_ROLE_SOLID_INFILL)->scaled_width,
+            );
         }
+        push @shells, $shells;
     }
+    $self->print->thread_pool->process_horizontal_shells(@shells);
 }
 
 # combine fill surfaces across layers
@@ -841,6 +754,8 @@ sub combine_infill {
     
     my @layer_heights = map $_->height, @{$self->layers};
     
+    # define the groups of layers to combine
+    my @groups = ();  # [ region_id, first layer_id, last layer_id ]
     for my $region_id (0 .. ($self->print->regions_count-1)) {
         my $region = $self->print->regions->[$region_id];
         my $every = $region->config->infill_every_layers;
@@ -868,86 +783,42 @@ sub combine_infill {
         # skip bottom layer
         for my $layer_id (1 .. $#combine) {
             next unless ($combine[$layer_id] // 1) > 1;
-            my @layerms = map $self->layers->[$_]->regions->[$region_id],
-                ($layer_id - ($combine[$layer_id]-1) .. $layer_id);
-            
-            # only combine internal infill
-            for my $type (S_TYPE_INTERNAL) {
-                # we need to perform a multi-layer intersection, so let's split it in pairs
-                
-                # initialize the intersection with the candidates of the lowest layer
-                my $intersection = [ map $_->expolygon, @{$layerms[0]->fill_surfaces->filter_by_type($type)} ];
-                
-                # start looping from the second layer and intersect the current intersection with it
-                for my $layerm (@layerms[1 .. $#layerms]) {
-                    $intersection = intersection_ex(
-                        [ map @$_, @$intersection ],
-                        [ map @{$_->expolygon}, @{$layerm->fill_surfaces->filter_by_type($type)} ],
-                    );
-                }
-                
-                my $area_threshold = $layerms[0]->infill_area_threshold;
-                @$intersection = grep $_->area > $area_threshold, @$intersection;
-                next if !@$intersection;
-                Slic3r::debugf "  combining %d %s regions from layers %d-%d\n",
-                    scalar(@$intersection),
-                    ($type == S_TYPE_INTERNAL ? 'internal' : 'internal-solid'),
-                    $layer_id-($every-1), $layer_id;
-                
-                # $intersection now contains the regions that can be combined across the full amount of layers
-                # so let's remove those areas from all layers
-                
-                 my @intersection_with_clearance = map @{$_->offset(
-                       $layerms[-1]->flow(FLOW_ROLE_SOLID_INFILL)->scaled_width    / 2
-                     + $layerms[-1]->flow(FLOW_ROLE_PERIMETER)->scaled_width / 2
-                     # Because fill areas for rectilinear and honeycomb are grown 
-                     # later to overlap perimeters, we need to counteract that too.
-                     + (($type == S_TYPE_INTERNALSOLID || $region->config->fill_pattern =~ /(rectilinear|honeycomb)/)
-                       ? $layerms[-1]->flow(FLOW_ROLE_SOLID_INFILL)->scaled_width * &Slic3r::INFILL_OVERLAP_OVER_SPACING
-                       : 0)
-                     )}, @$intersection;
-
-                
-                foreach my $layerm (@layerms) {
-                    my @this_type   = @{$layerm->fill_surfaces->filter_by_type($type)};
-                    my @other_types = map $_->clone, grep $_->surface_type != $type, @{$layerm->fill_surfaces};
-                    
-                    my @new_this_type = map Slic3r::Surface->new(expolygon => $_, surface_type => $type),
-                        @{diff_ex(
-                            [ map $_->p, @this_type ],
-                            [ @intersection_with_clearance ],
-                        )};
-                    
-                    # apply surfaces back with adjusted depth to the uppermost layer
-                    if ($layerm->id == $layer_id) {
-                        push @new_this_type,
-                            map Slic3r::Surface->new(
-                                expolygon        => $_,
-                                surface_type     => $type,
-                                thickness        => sum(map $_->height, @layerms),
-                                thickness_layers => scalar(@layerms),
-                            ),
-                            @$intersection;
-                    } else {
-                        # save void surfaces
-                        push @this_type,
-                            map Slic3r::Surface->new(expolygon => $_, surface_type => S_TYPE_INTERNALVOID),
-                            @{intersection_ex(
-                                [ map @{$_->expolygon}, @this_type ],
-                                [ @intersection_with_clearance ],
-                            )};
-                    }
-                    
-                    $layerm->fill_surfaces->clear;
-                    $layerm->fill_surfaces->append(@new_this_type, @other_types);
-                }
-            }
+            push @groups, [ $region_id, $layer_id - ($combine[$layer_id]-1), $layer_id ];
         }
     }
+    
+    # groups never share a layer region, so they are combined in parallel
+    # on the native thread pool
+    my @combiners = ();
+    foreach my $group (@groups) {
+        my ($region_id, $first_layer_id, $last_layer_id) = @$group;
+        
+        my $region = $self->print->regions->[$region_id];
+        my @layerms = map $self->layers->[$_]->regions->[$region_id], $first_layer_id .. $last_layer_id;
+        
+        # only internal infill is combined; the combined regions are removed from
+        # all layers with some clearance
+        my $clearance =
+              $layerms[-1]->flow(FLOW_ROLE_SOLID_INFILL)->scaled_width    / 2
+            + $layerms[-1]->flow(FLOW_ROLE_PERIMETER)->scaled_width / 2
+            # Because fill areas for rectilinear and honeycomb are grown 
+            # later to overlap perimeters, we need to counteract that too.
+            + (($region->config->fill_pattern =~ /(rectilinear|honeycomb)/)
+              ? $layerms[-1]->flow(FLOW_ROLE_SOLID_INFILL)->scaled_width * &Slic3r::INFILL_OVERLAP_OVER_SPACING
+              : 0);
+        
+        my $combiner = Slic3r::Print::Object::InfillCombiner->new($layerms[0]->infill_area_threshold, $clearance);
+        $combiner->add_layer($_->fill_surfaces, $_->height) for @layerms;
+        push @combiners, $combiner;
+    }
+    my $combined = $self->print->thread_pool->combine_infill(@combiners);
+    Slic3r::debugf "  combined internal regions of %d groups of layers\n", $combined;
 }
 
 sub generate_support_material {
     my $self = shift;
+    
+    $self->clear_support_layers;  # method must be idempotent
     return unless ($self->config->support_material || $self->config->raft_layers > 0)
         && scalar(@{$self->layers}) >= 2;
     
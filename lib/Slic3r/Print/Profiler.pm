@@ -0,0 +1,107 @@
+package Slic3r::Print::Profiler;
+use Moo;
+
+# Collects the wall time, CPU time and peak RSS growth of each stage of a
+# print (every step of every object, then the G-code export) along with
+# the amount of data available after it. Samples and counts are taken
+# natively (see Slic3r::Profiler::Sample and Slic3r::Profiler::Counts),
+# so profiling is cheap enough to be left on for production jobs.
+#
+#   my $profiler = Slic3r::Print::Profiler->new;
+#   $print->profiler($profiler);
+#   $print->process;
+#   print $profiler->as_json;
+
+has 'stages'            => (is => 'ro', default => sub { [] });  # recorded stages, in execution order
+has 'gcode_comments'    => (is => 'rw', default => sub { 0 });   # append the stages to the G-code
+has 'input_file'        => (is => 'rw');                         # stored along with the stages being recorded
+
+use constant COUNTS => qw(layers polygons points paths);
+
+# returns an opaque value to be passed to stop()
+sub start {
+    my ($self) = @_;
+    return Slic3r::Profiler::Sample->new;
+}
+
+# records a stage started by start(); $counts_cb, if supplied, receives
+# a Slic3r::Profiler::Counts object to fill with the data of the stage
+sub stop {
+    my ($self, $start, $stage, $obj_idx, $counts_cb) = @_;
+    
+    my $end = Slic3r::Profiler::Sample->new;
+    my %record = (
+        input_file      => $self->input_file,
+        stage           => $stage,
+        object          => $obj_idx,
+        wall_time       => $end->wall_time - $start->wall_time,
+        cpu_time        => $end->cpu_time - $start->cpu_time,
+        peak_rss_delta  => $end->peak_rss - $start->peak_rss,
+    );
+    if ($counts_cb) {
+        my $counts = Slic3r::Profiler::Counts->new;
+        $counts_cb->($counts);
+        $record{$_} = $counts->$_ for COUNTS;
+    }
+    push @{$self->stages}, \%record;
+}
+
+# runs $cb as a stage and returns its result
+sub measure {
+    my ($self, $stage, $obj_idx, $cb, $counts_cb) = @_;
+    
+    my $start = $self->start;
+    my @ret = $cb->();
+    $self->stop($start, $stage, $obj_idx, $counts_cb);
+    return wantarray ? @ret : $ret[0];
+}
+
+sub as_json {
+    my ($self) = @_;
+    
+    my $string = sub {
+        my ($value) = @_;
+        return 'null' if !defined $value;
+        $value =~ s/(["\\])/\\$1/g;
+        $value =~ s/([\x00-\x1f])/sprintf '\\u%04x', ord $1/ge;
+        return qq{"$value"};
+    };
+    my $number = sub {
+        my ($value, $format) = @_;
+        return defined $value ? sprintf($format, $value) : 'null';
+    };
+    
+    my @stages = map {
+        my $s = $_;
+        "    {"
+            . join(', ',
+                qq{"input_file": } . $string->($s->{input_file}),
+                qq{"stage": } . $string->($s->{stage}),
+                qq{"object": } . $number->($s->{object}, '%d'),
+                qq{"wall_time": } . $number->($s->{wall_time}, '%.6f'),
+                qq{"cpu_time": } . $number->($s->{cpu_time}, '%.6f'),
+                qq{"peak_rss_delta": } . $number->($s->{peak_rss_delta}, '%.0f'),
+                map qq{"$_": } . $number->($s->{$_}, '%d'), COUNTS,
+            )
+            . "}";
+    } @{$self->stages};
+    return "{\n  \"stages\": [\n" . join(",\n", @stages) . "\n  ]\n}\n";
+}
+
+# only lists the stages recorded for the current input file, since the
+# same profiler may collect the stages of several G-code files
+sub as_gcode_comments {
+    my ($self) = @_;
+    
+    my $input_file = $self->input_file // '';
+    my $gcode = sprintf "; %-16s %6s %10s %10s %10s %8s %10s %12s %10s\n",
+        qw(stage object wall(s) cpu(s) rss(MB) layers polygons points paths);
+    foreach my $s (grep { ($_->{input_file} // '') eq $input_file } @{$self->stages}) {
+        $gcode .= sprintf "; %-16s %6s %10.3f %10.3f %10.1f %8s %10s %12s %10s\n",
+            $s->{stage}, $s->{object} // '-', $s->{wall_time}, $s->{cpu_time},
+            $s->{peak_rss_delta}/1024/1024, map $_ // '-', @$s{+COUNTS};
+    }
+    return $gcode;
+}
+
+1;
@@ -7,7 +7,8 @@ has '_print' => (
     is      => 'ro',
     default => sub { Slic3r::Print->new },
     handles => [qw(apply_config extruders expanded_output_filepath
-                    total_used_filament total_extruded_volume)],
+                    total_used_filament total_extruded_volume
+                    estimated_print_time)],
 );
 
 has 'duplicate' => (
@@ -25,6 +26,13 @@ has 'rotate' => (
     default => sub { 0 },
 );
 
+# rotation steps tried for each part when auto-arranging; 1 keeps the
+# parts in their original orientation
+has 'arrange_rotations' => (
+    is      => 'rw',
+    default => sub { 1 },
+);
+
 has 'duplicate_grid' => (
     is      => 'rw',
     default => sub { [1,1] },
@@ -39,6 +47,10 @@ has 'output_file' => (
     is      => 'rw',
 );
 
+has 'profiler' => (
+    is      => 'rw',
+);
+
 sub set_model {
     my ($self, $model) = @_;
     
@@ -62,10 +74,12 @@ sub set_model {
     if ($self->duplicate_grid->[X] > 1 || $self->duplicate_grid->[Y] > 1) {
         $model->duplicate_objects_grid($self->duplicate_grid, $self->_print->config->duplicate_distance);
     } elsif ($need_arrange) {
-        $model->duplicate_objects($self->duplicate, $self->_print->config->min_object_distance);
+        $model->duplicate_objects($self->duplicate, $self->_print->config->min_object_distance, undef,
+            $self->arrange_rotations, $self->_print->thread_pool);
     } elsif ($self->duplicate > 1) {
         # if all input objects have defined position(s) apply duplication to the whole model
-        $model->duplicate($self->duplicate, $self->_print->config->min_object_distance);
+        $model->duplicate($self->duplicate, $self->_print->config->min_object_distance, undef,
+            $self->_print->thread_pool);
     }
     $model->center_instances_around_point($self->_print->config->print_center);
     
@@ -79,6 +93,7 @@ sub _before_export {
     my ($self) = @_;
     
     $self->_print->status_cb($self->status_cb);
+    $self->_print->profiler($self->profiler);
     $self->_print->validate;
 }
 
@@ -86,6 +101,7 @@ sub _after_export {
     my ($self) = @_;
     
     $self->_print->status_cb(undef);
+    $self->_print->profiler(undef);
 }
 
 sub export_gcode {
@@ -14,15 +14,101 @@ our %print_steps = map { $_ => 1 } (
     STEP_BRIM,
 );
 
+# short names used when reporting about the steps
+our %step_names = (
+    STEP_INIT_EXTRUDERS()   => 'init_extruders',
+    STEP_SLICE()            => 'slice',
+    STEP_PERIMETERS()       => 'perimeters',
+    STEP_PREPARE_INFILL()   => 'prepare_infill',
+    STEP_INFILL()           => 'infill',
+    STEP_SUPPORTMATERIAL()  => 'support_material',
+    STEP_SKIRT()            => 'skirt',
+    STEP_BRIM()             => 'brim',
+);
+
+# the step keys need parentheses, or the fat comma would quote them
 our %prereqs = (
-    STEP_INIT_EXTRUDERS     => [],
-    STEP_SLICE              => [],
-    STEP_PERIMETERS         => [STEP_SLICE, STEP_INIT_EXTRUDERS],
-    STEP_PREPARE_INFILL     => [STEP_PERIMETERS],
-    STEP_INFILL             => [STEP_INFILL],
-    STEP_SUPPORTMATERIAL    => [STEP_SLICE, STEP_INIT_EXTRUDERS],
-    STEP_SKIRT              => [STEP_PERIMETERS, STEP_INFILL],
-    STEP_BRIM               => [STEP_PERIMETERS, STEP_INFILL, STEP_SKIRT],
+    STEP_INIT_EXTRUDERS()   => [],
+    STEP_SLICE()            => [],
+    STEP_PERIMETERS()       => [STEP_SLICE],
+    STEP_PREPARE_INFILL()   => [STEP_PERIMETERS],
+    STEP_INFILL()           => [STEP_PREPARE_INFILL],
+    STEP_SUPPORTMATERIAL()  => [STEP_SLICE],
+    STEP_SKIRT()            => [STEP_INIT_EXTRUDERS, STEP_PERIMETERS, STEP_INFILL, STEP_SUPPORTMATERIAL],
+    STEP_BRIM()             => [STEP_PERIMETERS, STEP_INFILL, STEP_SUPPORTMATERIAL, STEP_SKIRT],
+);
+
+# Steps whose results depend on each config option (steps depending on them
+# are invalidated as well). Options mapped to no steps are only read when
+# writing G-code, which is always done from scratch. Options affecting
+# prepare_infill invalidate STEP_PERIMETERS instead, because that step works
+# in place on the fill surfaces generated along with perimeters.
+# Options not listed here invalidate all steps.
+our %option_steps = (
+    (map { $_ => [] } qw(
+        avoid_crossing_perimeters bed_size bed_temperature bridge_acceleration
+        bridge_fan_speed bridge_speed complete_objects cooling default_acceleration
+        disable_fan_first_layers duplicate_distance end_gcode external_perimeter_speed
+        extruder_clearance_height extruder_clearance_radius extruder_offset
+        extrusion_axis fan_always_on fan_below_layer_time
+        first_layer_acceleration first_layer_bed_temperature
+        first_layer_speed first_layer_temperature g0 gcode_arcs gcode_comments
+        gcode_flavor infill_acceleration infill_first infill_speed layer_gcode
+        max_fan_speed min_fan_speed min_print_speed notes
+        only_retract_when_crossing_perimeters output_filename_format overhangs
+        perimeter_acceleration perimeter_speed post_process print_center
+        randomize_start retract_before_travel retract_layer_change retract_length
+        retract_length_toolchange retract_lift retract_restart_extra
+        retract_restart_extra_toolchange retract_speed slowdown_below_layer_time
+        small_perimeter_speed solid_infill_speed spiral_vase
+        standby_temperature_delta start_gcode start_perimeters_at_concave_points
+        start_perimeters_at_non_overhang support_material_speed temperature threads
+        toolchange_gcode top_solid_infill_speed travel_speed use_firmware_retraction
+        use_relative_e_distances vibration_limit wipe z_offset
+    )),
+    (map { $_ => [STEP_INIT_EXTRUDERS] } qw(
+        ooze_prevention skirt_height skirts
+    )),
+    (map { $_ => [STEP_SLICE] } qw(
+        first_layer_height layer_height raft_layers resolution
+    )),
+    (map { $_ => [STEP_PERIMETERS] } qw(
+        bridge_flow_ratio brim_width external_perimeters_first extra_perimeters
+        fill_angle gap_fill_speed perimeter_extrusion_width perimeters thin_walls
+    )),
+    # read by prepare_infill
+    (map { $_ => [STEP_PERIMETERS] } qw(
+        bottom_solid_layers fill_density fill_pattern infill_every_layers
+        infill_extrusion_width infill_only_where_needed solid_infill_below_area
+        solid_infill_every_layers solid_infill_extrusion_width
+        top_infill_extrusion_width top_solid_layers
+    )),
+    (map { $_ => [STEP_PERIMETERS, STEP_SUPPORTMATERIAL] } qw(
+        extrusion_width first_layer_extrusion_width nozzle_diameter
+    )),
+    # the set of used extruders is read by init_extruders
+    (map { $_ => [STEP_INIT_EXTRUDERS, STEP_PERIMETERS] } qw(
+        infill_extruder perimeter_extruder
+    )),
+    (map { $_ => [STEP_INIT_EXTRUDERS, STEP_SUPPORTMATERIAL] } qw(
+        support_material_extruder support_material_interface_extruder
+    )),
+    (map { $_ => [STEP_INFILL] } qw(
+        solid_fill_pattern
+    )),
+    (map { $_ => [STEP_SUPPORTMATERIAL] } qw(
+        support_material support_material_angle support_material_enforce_layers
+        support_material_extrusion_width support_material_interface_layers
+        support_material_interface_spacing support_material_pattern
+        support_material_spacing support_material_threshold
+    )),
+    (map { $_ => [STEP_SKIRT] } qw(
+        min_skirt_length skirt_distance
+    )),
+    # the filament used by each loop is read by make_skirt for min_skirt_length
+    (map { $_ => [STEP_SKIRT] } qw(
+        extrusion_multiplier filament_diameter
+    )),
 );
 
 1;
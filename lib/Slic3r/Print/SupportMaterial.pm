@@ -5,7 +5,7 @@ use List::Util qw(sum min max);
 use Slic3r::ExtrusionPath ':roles';
 use Slic3r::Flow ':roles';
 use Slic3r::Geometry qw(scale scaled_epsilon PI rad2deg deg2rad convex_hull);
-use Slic3r::Geometry::Clipper qw(offset diff union union_ex intersection offset_ex offset2
+use Slic3r::Geometry::Clipper qw(offset diff union_ex intersection offset_ex offset2
     intersection_pl);
 use Slic3r::Surface ':types';
 
@@ -53,31 +53,37 @@ sub generate {
     # If we wanted to apply some special logic to the first support layers lying on
     # object's top surfaces this is the place to detect them
     
-    my $shape = [];
+    # Propagate contact layers downwards to generate interface layers, then
+    # propagate contact and interface layers to generate the main support layers.
+    # This is done natively: polygons only cross the Perl boundary once per layer.
+    my $generator = Slic3r::Print::SupportMaterial::Generator->new(
+        $support_z,
+        $self->object_config->support_material_interface_layers,
+        $self->flow->scaled_width,
+        $self->interface_flow->scaled_width,
+    );
+    for my $i (0 .. $#$support_z) {
+        my $z = $support_z->[$i];
+        $generator->set_contact($i, $contact->{$z}) if $contact->{$z};
+        $generator->set_top($i, $top->{$z}) if $top->{$z};
+    }
+    $generator->add_object_layer($_->print_z, $_->height, [ map @$_, @{$_->slices} ])
+        for @{$object->layers};
     if ($self->object_config->support_material_pattern eq 'pillars') {
-        $self->generate_pillars_shape($contact, $support_z, $shape);
+        $generator->generate_pillars_shape(scale PILLAR_SIZE, scale PILLAR_SPACING);
     }
-    
-    # Propagate contact layers downwards to generate interface layers
-    my ($interface) = $self->generate_interface_layers($support_z, $contact, $top);
-    $self->clip_with_object($interface, $support_z, $object);
-    $self->clip_with_shape($interface, $shape) if @$shape;
-    
-    # Propagate contact layers and interface layers downwards to generate
-    # the main support layers.
-    my ($base) = $self->generate_base_layers($support_z, $contact, $interface, $top);
-    $self->clip_with_object($base, $support_z, $object);
-    $self->clip_with_shape($base, $shape) if @$shape;
+    $generator->generate;
+    my $interface = [ map $generator->interface($_), 0 .. $#$support_z ];  # layer_id => [ polygons ]
+    my $base      = [ map $generator->base($_),      0 .. $#$support_z ];  # layer_id => [ polygons ]
+    undef $generator;
     
     # Install support layers into object.
-    push @{$object->support_layers}, map Slic3r::Layer::Support->new(
-        object  => $object,
+    $object->add_support_layer(
         id      => $_,
         height  => ($_ == 0) ? $support_z->[$_] : ($support_z->[$_] - $support_z->[$_-1]),
         print_z => $support_z->[$_],
         slice_z => -1,
-        slices  => [],
-    ), 0 .. $#$support_z;
+    ) for 0 .. $#$support_z;
     
     # Generate the actual toolpaths and save them into each layer.
     $self->generate_toolpaths($object, $overhang, $contact, $interface, $base);
@@ -93,9 +99,8 @@ sub contact_area {
         Slic3r::debugf "Threshold angle = %d°\n", rad2deg($threshold_rad);
     }
     
-    # determine contact areas
-    my %contact  = ();  # contact_z => [ polygons ]
-    my %overhang = ();  # contact_z => [ polygons ] - this stores the actual overhang supported by each contact layer
+    # determine which layers need to be checked
+    my @layer_ids = ();
     for my $layer_id (0 .. $#{$object->layers}) {
         # note $layer_id might != $layer->id when raft_layers > 0
         # so $layer_id == 0 means first object layer
@@ -108,81 +113,56 @@ sub contact_area {
             # the 'overhangs' of the first object layer
             last if $layer_id > 0;
         }
-        my $layer = $object->layers->[$layer_id];
-        
-        # detect overhangs and contact areas needed to support them
-        my (@overhang, @contact) = ();
+        push @layer_ids, $layer_id;
+    }
+    
+    # Detect overhangs and contact areas needed to support them. Each layer only
+    # depends on itself and on the layer below, so the native detector processes
+    # layers in parallel on the thread pool; results are stored in the detector itself.
+    my $detector = Slic3r::Print::SupportMaterial::ContactDetector->new(scale MARGIN, scale MARGIN_STEP);
+    $detector->add_layer([ map @$_, @{$_->slices} ]) for @{$object->layers};
+    
+    for my $layer_id (@layer_ids) {
         if ($layer_id == 0) {
             # this is the first object layer, so we're here just to get the object
             # footprint for the raft
-            push @overhang, map $_->clone, map @$_, @{$layer->slices};
-            push @contact, @{offset(\@overhang, scale +MARGIN)};
-        } else {
-            my $lower_layer = $object->layers->[$layer_id-1];
-            foreach my $layerm (@{$layer->regions}) {
-                my $fw = $layerm->flow(FLOW_ROLE_PERIMETER)->scaled_width;
-                my $diff;
-            
-                # If a threshold angle was specified, use a different logic for detecting overhangs.
-                if (defined $threshold_rad
-                    || $layer_id < $self->object_config->support_material_enforce_layers
-                    || $self->object_config->raft_layers > 0) {
-                    my $d = defined $threshold_rad
-                        ? scale $lower_layer->height * ((cos $threshold_rad) / (sin $threshold_rad))
-                        : 0;
-                
-                    $diff = diff(
-                        offset([ map $_->p, @{$layerm->slices} ], -$d),
-                        [ map @$_, @{$lower_layer->slices} ],
-                    );
-                
-                    # only enforce spacing from the object ($fw/2) if the threshold angle
-                    # is not too high: in that case, $d will be very small (as we need to catch
-                    # very short overhangs), and such contact area would be eaten by the
-                    # enforced spacing, resulting in high threshold angles to be almost ignored
-                    $diff = diff(
-                        offset($diff, $d - $fw/2),
-                        [ map @$_, @{$lower_layer->slices} ],
-                    ) if $d > $fw/2;
-                } else {
-                    $diff = diff(
-                        offset([ map $_->p, @{$layerm->slices} ], -$fw/2),
-                        [ map @$_, @{$lower_layer->slices} ],
-                    );
-                
-                    # collapse very tiny spots
-                    $diff = offset2($diff, -$fw/10, +$fw/10);
-                
-                    # $diff now contains the ring or stripe comprised between the boundary of 
-                    # lower slices and the centerline of the last perimeter in this overhanging layer.
-                    # Void $diff means that there's no upper perimeter whose centerline is
-                    # outside the lower slice boundary, thus no overhang
-                }
-            
-                # TODO: this is the place to remove bridged areas
-            
-                next if !@$diff;
-                push @overhang, @$diff;  # NOTE: this is not the full overhang as it misses the outermost half of the perimeter width!
-            
-                # Let's define the required contact area by using a max gap of half the upper 
-                # extrusion width and extending the area according to the configured margin.
-                # We increment the area in steps because we don't want our support to overflow
-                # on the other side of the object (if it's very thin).
-                {
-                    my @slices_margin = @{offset([ map @$_, @{$lower_layer->slices} ], $fw/2)};
-                    for ($fw/2, map {scale MARGIN_STEP} 1..(MARGIN / MARGIN_STEP)) {
-                        $diff = diff(
-                            offset($diff, $_),
-                            \@slices_margin,
-                        );
-                    }
-                }
-                push @contact, @$diff;
-            }
+            $detector->add_footprint($layer_id);
+            next;
         }
+        
+        my $layer = $object->layers->[$layer_id];
+        my $lower_layer = $object->layers->[$layer_id-1];
+        
+        # If a threshold angle was specified, use a different logic for detecting overhangs.
+        my $use_threshold = defined $threshold_rad
+            || $layer_id < $self->object_config->support_material_enforce_layers
+            || $self->object_config->raft_layers > 0;
+        my $d = defined $threshold_rad
+            ? scale $lower_layer->height * ((cos $threshold_rad) / (sin $threshold_rad))
+            : 0;
+        
+        foreach my $layerm (@{$layer->regions}) {
+            # TODO: this is the place to remove bridged areas
+            $detector->add_region(
+                $layer_id,
+                [ map $_->p, @{$layerm->slices} ],
+                $layerm->flow(FLOW_ROLE_PERIMETER)->scaled_width,
+                $d,
+                $use_threshold ? 1 : 0,
+            );
+        }
+    }
+    $detector->detect_layers($object->print->thread_pool);
+    
+    # now apply the contact areas to the layer were they need to be made
+    my %contact  = ();  # contact_z => [ polygons ]
+    my %overhang = ();  # contact_z => [ polygons ] - this stores the actual overhang supported by each contact layer
+    for my $layer_id (@layer_ids) {
+        my $layer = $object->layers->[$layer_id];
+        my @contact  = @{$detector->contact($layer_id)};
+        my @overhang = @{$detector->overhang($layer_id)};  # NOTE: this is not the full overhang as it misses the outermost half of the perimeter width!
         next if !@contact;
         
-        # now apply the contact areas to the layer were they need to be made
         {
             # get the average nozzle diameter used on this layer
             my @nozzle_diameters = map $self->print_config->get_at('nozzle_diameter', $_),
@@ -301,100 +281,6 @@ sub support_layers_z {
     return \@z;
 }
 
-sub generate_interface_layers {
-    my ($self, $support_z, $contact, $top) = @_;
-    
-    # let's now generate interface layers below contact areas
-    my %interface = ();  # layer_id => [ polygons ]
-    my $interface_layers = $self->object_config->support_material_interface_layers;
-    for my $layer_id (0 .. $#$support_z) {
-        my $z = $support_z->[$layer_id];
-        my $this = $contact->{$z} // next;
-        
-        # count contact layer as interface layer
-        for (my $i = $layer_id-1; $i >= 0 && $i > $layer_id-$interface_layers; $i--) {
-            $z = $support_z->[$i];
-            my @overlapping_layers = $self->overlapping_layers($i, $support_z);
-            my @overlapping_z = map $support_z->[$_], @overlapping_layers;
-            
-            # Compute interface area on this layer as diff of upper contact area
-            # (or upper interface area) and layer slices.
-            # This diff is responsible of the contact between support material and
-            # the top surfaces of the object. We should probably offset the top 
-            # surfaces vertically before performing the diff, but this needs 
-            # investigation.
-            $this = $interface{$i} = diff(
-                [
-                    @$this,                         # clipped projection of the current contact regions
-                    @{ $interface{$i} || [] },      # interface regions already applied to this layer
-                ],
-                [
-                    (map @$_, map $top->{$_}, grep exists $top->{$_}, @overlapping_z),  # top slices on this layer
-                    (map @$_, map $contact->{$_}, grep exists $contact->{$_}, @overlapping_z),  # contact regions on this layer
-                ],
-                1,
-            );
-        }
-    }
-    
-    return \%interface;
-}
-
-sub generate_base_layers {
-    my ($self, $support_z, $contact, $interface, $top) = @_;
-    
-    # let's now generate support layers under interface layers
-    my $base = {};  # layer_id => [ polygons ]
-    {
-        for my $i (reverse 0 .. $#$support_z-1) {
-            my $z = $support_z->[$i];
-            my @overlapping_layers = $self->overlapping_layers($i, $support_z);
-            my @overlapping_z = map $support_z->[$_], @overlapping_layers;
-            
-            # in case we have no interface layers, look at upper contact
-            # (1 interface layer means we only have contact layer, so $interface->{$i+1} is empty)
-            my @upper_contact = ();
-            if ($self->object_config->support_material_interface_layers <= 1) {
-                @upper_contact = @{ $contact->{$support_z->[$i+1]} || [] };
-            }
-            
-            $base->{$i} = diff(
-                [
-                    @{ $base->{$i+1} || [] },         # support regions on upper layer
-                    @{ $interface->{$i+1} || [] },    # interface regions on upper layer
-                    @upper_contact,                   # contact regions on upper layer
-                ],
-                [
-                    (map @$_, map $top->{$_}, grep exists $top->{$_}, @overlapping_z),  # top slices on this layer
-                    (map @$_, map $interface->{$_}, grep exists $interface->{$_}, @overlapping_layers),  # interface regions on this layer
-                    (map @$_, map $contact->{$_}, grep exists $contact->{$_}, @overlapping_z),  # contact regions on this layer
-                ],
-                1,
-            );
-        }
-    }
-    
-    return $base;
-}
-
-sub clip_with_object {
-    my ($self, $support, $support_z, $object) = @_;
-    
-    foreach my $i (keys %$support) {
-        next if !@{$support->{$i}};
-        
-        my $zmax = $support_z->[$i];
-        my $zmin = ($i == 0) ? 0 : $support_z->[$i-1];
-        my @layers = grep { $_->print_z > $zmin && ($_->print_z - $_->height) < $zmax }
-            @{$object->layers};
-        
-        $support->{$i} = diff(
-            $support->{$i},
-            offset([ map @$_, map @{$_->slices}, @layers ], +$self->flow->scaled_width),
-        );
-    }
-}
-
 sub generate_toolpaths {
     my ($self, $object, $overhang, $contact, $interface, $base) = @_;
     
@@ -425,6 +311,10 @@ sub generate_toolpaths {
         support     => $object->fill_maker->filler($pattern),
     );
     
+    # these fillers are shared with the object infill: don't inherit the
+    # layer_id it set when run without threads, as we alternate angles ourselves
+    $_->layer_id(undef) for values %fillers;
+    
     my $interface_angle = $self->object_config->support_material_angle + 90;
     my $interface_spacing = $self->object_config->support_material_interface_spacing + $interface_flow->spacing;
     my $interface_density = $interface_spacing == 0 ? 1 : $interface_flow->spacing / $interface_spacing;
@@ -438,8 +328,8 @@ sub generate_toolpaths {
         
         my $overhang    = $overhang->{$z}           || [];
         my $contact     = $contact->{$z}            || [];
-        my $interface   = $interface->{$layer_id}   || [];
-        my $base        = $base->{$layer_id}        || [];
+        my $interface   = $interface->[$layer_id]   || [];
+        my $base        = $base->[$layer_id]        || [];
         
         if (DEBUG_CONTACT_ONLY) {
             $interface = [];
@@ -642,103 +532,6 @@ sub generate_toolpaths {
     );
 }
 
-sub generate_pillars_shape {
-    my ($self, $contact, $support_z, $shape) = @_;
-    
-    my $pillar_size     = scale PILLAR_SIZE;
-    my $pillar_spacing  = scale PILLAR_SPACING;
-    
-    my $grid;  # arrayref of polygons
-    {
-        my $pillar = Slic3r::Polygon->new(
-            [0,0],
-            [$pillar_size, 0],
-            [$pillar_size, $pillar_size],
-            [0, $pillar_size],
-        );
-    
-        my @pillars = ();
-        my $bb = Slic3r::Geometry::BoundingBox->new_from_points([ map @$_, map @$_, values %$contact ]);
-        for (my $x = $bb->x_min; $x <= $bb->x_max-$pillar_size; $x += $pillar_spacing) {
-            for (my $y = $bb->y_min; $y <= $bb->y_max-$pillar_size; $y += $pillar_spacing) {
-                push @pillars, my $p = $pillar->clone;
-                $p->translate($x, $y);
-            }
-        }
-        $grid = union(\@pillars);
-    }
-    
-    # add pillars to every layer
-    for my $i (0..$#$support_z) {
-        $shape->[$i] = [ @$grid ];
-    }
-    
-    # build capitals
-    for my $i (0..$#$support_z) {
-        my $z = $support_z->[$i];
-        
-        my $capitals = intersection(
-            $grid,
-            $contact->{$z} // [],
-        );
-        
-        # work on one pillar at time (if any) to prevent the capitals from being merged
-        # but store the contact area supported by the capital because we need to make 
-        # sure nothing is left
-        my $contact_supported_by_capitals = [];
-        foreach my $capital (@$capitals) {
-            # enlarge capital tops
-            $capital = offset([$capital], +($pillar_spacing - $pillar_size)/2);
-            push @$contact_supported_by_capitals, @$capital;
-            
-            for (my $j = $i-1; $j >= 0; $j--) {
-                my $jz = $support_z->[$j];
-                $capital = offset($capital, -$self->interface_flow->scaled_width/2);
-                last if !@$capitals;
-                push @{ $shape->[$j] }, @$capital;
-            }
-        }
-        
-        # Capitals will not generally cover the whole contact area because there will be
-        # remainders. For now we handle this situation by projecting such unsupported
-        # areas to the ground, just like we would do with a normal support.
-        my $contact_not_supported_by_capitals = diff(
-            $contact->{$z} // [],
-            $contact_supported_by_capitals,
-        );
-        if (@$contact_not_supported_by_capitals) {
-            for (my $j = $i-1; $j >= 0; $j--) {
-                push @{ $shape->[$j] }, @$contact_not_supported_by_capitals;
-            }
-        }
-    }
-}
-
-sub clip_with_shape {
-    my ($self, $support, $shape) = @_;
-    
-    foreach my $i (keys %$support) {
-        $support->{$i} = intersection(
-            $support->{$i},
-            $shape->[$i],
-        );
-    }
-}
-
-# this method returns the indices of the layers overlapping with the given one
-sub overlapping_layers {
-    my ($self, $i, $support_z) = @_;
-    
-    my $zmax = $support_z->[$i];
-    my $zmin = ($i == 0) ? 0 : $support_z->[$i-1];
-    
-    return grep {
-        my $zmax2 = $support_z->[$_];
-        my $zmin2 = ($_ == 0) ? 0 : $support_z->[$_-1];
-        $zmax > $zmin2 && $zmin < $zmax2;
-    } 0..$#$support_z;
-}
-
 # class method
 sub contact_distance {
     my ($nozzle_diameter) = @_;
@@ -8,6 +8,7 @@ BEGIN {
     use lib "$FindBin::Bin/lib";
 }
 
+use File::Path qw(make_path);
 use Getopt::Long qw(:config no_auto_abbrev);
 use List::Util qw(first);
 use POSIX qw(setlocale LC_NUMERIC);
@@ -25,6 +26,9 @@ my %cli_options = ();
         'debug'                 => \$Slic3r::debug,
         'gui'                   => \$opt{gui},
         'o|output=s'            => \$opt{output},
+        'slice-cache=s'         => \$Slic3r::slice_cache_dir,
+        'profile=s'             => \$opt{profile},
+        'profile-gcode'         => \$opt{profile_gcode},
         
         'save=s'                => \$opt{save},
         'load=s@'               => \$opt{load},
@@ -42,6 +46,7 @@ my %cli_options = ();
         'rotate=i'              => \$opt{rotate},
         'duplicate=i'           => \$opt{duplicate},
         'duplicate-grid=s'      => \$opt{duplicate_grid},
+        'arrange-rotations=i'   => \$opt{arrange_rotations},
     );
     foreach my $opt_key (keys %{$Slic3r::Config::Options}) {
         my $cli = $Slic3r::Config::Options->{$opt_key}->{cli} or next;
@@ -52,6 +57,12 @@ my %cli_options = ();
     GetOptions(%options) or usage(1);
 }
 
+# create the slice cache directory if needed
+if (defined $Slic3r::slice_cache_dir && !-d $Slic3r::slice_cache_dir) {
+    make_path($Slic3r::slice_cache_dir, { error => \my $err });
+    die "Cannot create slice cache directory ($Slic3r::slice_cache_dir).\n" if @$err;
+}
+
 # process command line options
 my $cli_config = Slic3r::Config->new_from_cli(%cli_options);
 
@@ -117,6 +128,13 @@ if (@ARGV) {  # slicing from command line
         exit;
     }
     
+    # one profiler for all the input files, so that a single report covers them;
+    # the stages appended to each G-code file are only the ones of its input file
+    my $profiler;
+    if (defined $opt{profile} || $opt{profile_gcode}) {
+        $profiler = Slic3r::Print::Profiler->new(gcode_comments => $opt{profile_gcode});
+    }
+    
     while (my $input_file = shift @ARGV) {
         my $model;
         if ($opt{merge}) {
@@ -140,12 +158,15 @@ if (@ARGV) {  # slicing from command line
             rotate          => $opt{rotate}         // 0,
             duplicate       => $opt{duplicate}      // 1,
             duplicate_grid  => $opt{duplicate_grid} // [1,1],
+            arrange_rotations => $opt{arrange_rotations} // 1,
             status_cb       => sub {
                 my ($percent, $message) = @_;
                 printf "=> %s\n", $message;
             },
             output_file     => $opt{output},
+            profiler        => $profiler,
         );
+        $profiler->input_file($input_file) if $profiler;
         
         $sprint->apply_config($config);
         $sprint->set_model($model);
@@ -165,8 +186,17 @@ if (@ARGV) {  # slicing from command line
             }
             printf "Filament required: %.1fmm (%.1fcm3)\n",
                 $sprint->total_used_filament, $sprint->total_extruded_volume/1000;
+            printf "Estimated printing time: %d minutes\n",
+                int($sprint->estimated_print_time / 60 + 0.5);
         }
     }
+    
+    if (defined $opt{profile}) {
+        Slic3r::open(\my $fh, '>', $opt{profile})
+            or die "Cannot write profile to $opt{profile}: $!\n";
+        print $fh $profiler->as_json;
+        close $fh;
+    }
 } else {
     usage(1) unless $opt{save};
 }
@@ -197,6 +227,11 @@ Usage: slic3r.pl [ OPTIONS ] [ file.stl ] [ file2.stl ] ...
     -o, --output <file> File to output gcode to (by default, the file will be saved
                         into the same directory as the input file using the 
                         --output-filename-format to generate the filename)
+    --slice-cache <dir> Store sliced layers in the specified directory and reuse them
+                        whenever the same meshes are sliced again at the same heights
+    --profile <file>    Write the time, memory and amount of data of each processing
+                        stage of each object to the specified file (JSON)
+    --profile-gcode     Append the same statistics to the G-code as comments
   
   Non-slicing actions (no G-code will be generated):
     --repair            Repair given STL files and save them as <name>_fixed.obj
@@ -408,6 +443,8 @@ $j
     --bed-size          Bed size, only used for auto-arrange (mm, default: $config->{bed_size}->[0],$config->{bed_size}->[1])
     --duplicate-grid    Number of items with grid arrangement (default: 1,1)
     --duplicate-distance Distance in mm between copies (default: $config->{duplicate_distance})
+    --arrange-rotations Number of rotation steps tried for each part by auto-arrange, e.g. 4 to
+                        also try 90 degrees rotations (1+, default: 1)
    
    Sequential printing options:
     --complete-objects  When printing multiple objects and/or copies, complete each one before
@@ -1,4 +1,4 @@
-use Test::More tests => 8;
+use Test::More tests => 14;
 use strict;
 use warnings;
 
@@ -7,6 +7,8 @@ BEGIN {
     use lib "$FindBin::Bin/../lib";
 }
 
+use File::Temp;
+use IO::Uncompress::Gunzip;
 use List::Util qw(first);
 use Slic3r;
 use Slic3r::Geometry qw(scale);
@@ -98,4 +100,60 @@ use Slic3r::Test;
     ok !(defined first { $_ > 100 } @percent), 'M73 is never given more than 100%';
 }
 
+{
+    my $print = Slic3r::Test::init_print('20mm_cube');
+    my $gcode = Slic3r::Test::gcode($print);
+    
+    # a File::Temp object would be cloned into the writer thread and unlink
+    # the file when that thread exits, so we only use a temporary directory
+    my $dir = File::Temp::tempdir(CLEANUP => 1);
+    for my $threads (1, 2) {
+        my $file = "$dir/$threads.gcode.gz";
+        $print->config->set('threads', $threads);
+        $print->write_gcode($file);
+        IO::Uncompress::Gunzip::gunzip($file => \my $unzipped);
+        # the header contains a timestamp and the footer the threads setting
+        s/^; (?:generated by|threads =) .*\n//mg for $gcode, $unzipped;
+        is $unzipped, $gcode, "G-code is streamed and compressed to .gz output files (threads = $threads)";
+    }
+}
+
+{
+    my $config = Slic3r::Config->new_from_defaults;
+    $config->set('start_perimeters_at_concave_points', 1);
+    $config->set('start_perimeters_at_non_overhang', 1);
+    $config->set('threads', 2);
+    my $gcode = sub {
+        my $print = Slic3r::Test::init_print('overhang', config => $config);
+        my $gcode = Slic3r::Test::gcode($print);
+        $gcode =~ s/^; generated by .*\n//mg;
+        return $gcode;
+    };
+    
+    my $computed = 0;
+    my $candidates = \&Slic3r::GCode::Seams::candidates;
+    my $native = do {
+        no warnings 'redefine';
+        local *Slic3r::GCode::Seams::candidates = sub { my $c = $candidates->(@_); $computed++ if $c; $c };
+        $gcode->();
+    };
+    ok $computed > 0, 'seam candidates are computed in advance';
+    my $serial = do {
+        no warnings 'redefine';
+        local *Slic3r::GCode::Seams::candidates = sub { undef };
+        $gcode->();
+    };
+    ok $native eq $serial, 'seam candidates computed in advance give the same G-code';
+}
+
+SKIP: {
+    skip "no /dev/full on this system", 2 if !-w '/dev/full';
+    
+    my $print = Slic3r::Test::init_print('20mm_cube');
+    for my $threads (1, 2) {
+        $print->config->set('threads', $threads);
+        ok !eval { $print->write_gcode('/dev/full'); 1 }, "write errors are reported (threads = $threads)";
+    }
+}
+
 __END__
@@ -1,4 +1,4 @@
-use Test::More tests => 2;
+use Test::More tests => 19;
 use strict;
 use warnings;
 
@@ -10,6 +10,7 @@ BEGIN {
 use List::Util qw(first);
 use Slic3r;
 use Slic3r::Geometry qw(epsilon unscale X Y);
+use Slic3r::Print::State ':steps';
 use Slic3r::Test;
 
 {
@@ -30,4 +31,87 @@ use Slic3r::Test;
     ok abs(unscale($center->[Y]) - $config->print_center->[Y]) < epsilon, 'print is centered around print_center (Y)';
 }
 
+{
+    my $config = Slic3r::Config->new_from_defaults;
+    my $print = Slic3r::Test::init_print('20mm_cube', config => $config);
+    Slic3r::Test::gcode($print);
+    my $object = $print->objects->[0];
+    ok $object->_state->done(STEP_INFILL), 'steps are marked as done after processing';
+    
+    $config->set('perimeter_speed', 13);
+    $print->apply_config($config);
+    ok !(first { !$object->_state->done($_) } STEP_SLICE, STEP_PERIMETERS, STEP_PREPARE_INFILL, STEP_INFILL),
+        'changing a speed does not invalidate any step';
+    ok Slic3r::Test::gcode($print) =~ /F780\b/, 'new speed is used when exporting again';
+    
+    $config->set('perimeters', 1);
+    $print->apply_config($config);
+    ok $object->_state->done(STEP_SLICE), 'changing perimeters does not invalidate slices';
+    ok !$object->_state->done(STEP_PERIMETERS), 'changing perimeters invalidates perimeters';
+    ok !$object->_state->done(STEP_INFILL), 'steps depending on perimeters are invalidated';
+    ok !$print->_state->done(STEP_SKIRT), 'print steps depending on perimeters are invalidated';
+}
+
+{
+    my $config = Slic3r::Config->new_from_defaults;
+    $config->set('skirts', 1);
+    $config->set('min_skirt_length', 500);
+    my $print = Slic3r::Test::init_print('20mm_cube', config => $config);
+    $print->process;
+    my $loops = scalar @{$print->skirt};
+    
+    $config->set('extrusion_multiplier', [2]);
+    $print->apply_config($config);
+    ok !$print->_state->done(STEP_SKIRT), 'changing extrusion_multiplier invalidates the skirt';
+    $print->process;
+    ok scalar(@{$print->skirt}) < $loops, 'skirt loops are recomputed for min_skirt_length';
+}
+
+{
+    # sloping walls give typed surfaces narrower than the collapse threshold
+    my $config = Slic3r::Config->new_from_defaults;
+    my $print = Slic3r::Test::init_print('V', config => $config);
+    Slic3r::Test::gcode($print);
+    
+    my $fresh_gcode = sub {
+        my $gcode = Slic3r::Test::gcode(Slic3r::Test::init_print('V', config => $config));
+        $gcode =~ s/^; generated by .*\n//m;  # contains a timestamp
+        return $gcode;
+    };
+    
+    $config->set('perimeters', 2);
+    $config->set('fill_density', 0.2);
+    $print->apply_config($config);
+    (my $gcode = Slic3r::Test::gcode($print)) =~ s/^; generated by .*\n//m;
+    ok $gcode eq $fresh_gcode->(), 'G-code of repeated steps is the same as processing from scratch';
+    
+    # simulate an interrupted prepare_infill, which left the fill surfaces typed
+    my $object = $print->objects->[0];
+    $print->invalidate_step(STEP_PREPARE_INFILL, 0);
+    $object->_state->set_started(STEP_PREPARE_INFILL);
+    $object->detect_surfaces_type;
+    ($gcode = Slic3r::Test::gcode($print)) =~ s/^; generated by .*\n//m;
+    ok $gcode eq $fresh_gcode->(), 'interrupted steps are repeated from clean data';
+}
+
+{
+    my $print = Slic3r::Test::init_print('20mm_cube');
+    my $profiler = Slic3r::Print::Profiler->new(gcode_comments => 1);
+    $print->profiler($profiler);
+    my $gcode = Slic3r::Test::gcode($print);
+    
+    my %stages = map { $_->{stage} . '/' . ($_->{object} // '') => $_ } @{$profiler->stages};
+    ok exists $stages{"$_/0"}, "$_ is measured for each object" for qw(slice perimeters infill);
+    ok $stages{'infill/0'}{layers} > 0 && $stages{'infill/0'}{paths} > 0 && $stages{'export/'},
+        'data produced by the steps is counted';
+    ok $gcode =~ /^; slice\s+0\s/m, 'stages are appended to G-code';
+    
+    # the same profiler collecting a second input file
+    $profiler->input_file('second.stl');
+    my $print2 = Slic3r::Test::init_print('20mm_cube');
+    $print2->profiler($profiler);
+    my $gcode2 = Slic3r::Test::gcode($print2);
+    is scalar(() = $gcode2 =~ /^; slice\s/mg), 1, 'only the stages of the current input file are appended to G-code';
+}
+
 __END__
@@ -14,7 +14,7 @@ use Slic3r::Test;
 if (!$Slic3r::have_threads) {
     plan skip_all => "this perl is not compiled with threads";
 }
-plan tests => 2;
+plan tests => 3;
 
 {
     my $print = Slic3r::Test::init_print('20mm_cube');
@@ -36,4 +36,19 @@ plan tests => 2;
     ok $thread->join, "process print in a separate thread";
 }
 
+{
+    my $gcode = sub {
+        my ($threads) = @_;
+        my $config = Slic3r::Config->new_from_defaults;
+        $config->set('threads', $threads);
+        $config->set('support_material', 1);
+        my $print = Slic3r::Test::init_print('overhang', config => $config);
+        my $gcode = Slic3r::Test::gcode($print);
+        # the header contains a timestamp and the footer the threads setting
+        $gcode =~ s/^; (?:generated by|threads =) .*\n//mg;
+        return $gcode;
+    };
+    ok $gcode->(1) eq $gcode->(4), 'G-code is the same regardless of the number of threads';
+}
+
 __END__
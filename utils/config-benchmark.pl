@@ -0,0 +1,53 @@
+#!/usr/bin/perl
+# This script measures the cost of reading config options from Perl
+# through the various accessors
+
+use strict;
+use warnings;
+
+BEGIN {
+    use FindBin;
+    use lib "$FindBin::Bin/../lib";
+}
+
+use Benchmark qw(cmpthese);
+use Getopt::Long qw(:config no_auto_abbrev);
+use Slic3r;
+
+my %opt = (
+    seconds => 2,
+);
+GetOptions(
+    'help'          => sub { usage() },
+    'seconds=i'     => \$opt{seconds},
+) or usage(1);
+
+my $full    = Slic3r::Config::Full->new;
+my $dynamic = Slic3r::Config->new_from_defaults;
+
+# one key at the start and one at the end of the old if-chains
+foreach my $opt_key (qw(layer_height z_offset)) {
+    printf "==> %s\n", $opt_key;
+    cmpthese(-$opt{seconds}, {
+        'static get()'      => sub { $full->get($opt_key) for 1..100 },
+        'static accessor'   => sub { $full->$opt_key for 1..100 },
+        'dynamic get()'     => sub { $dynamic->get($opt_key) for 1..100 },
+        'dynamic accessor'  => sub { $dynamic->$opt_key for 1..100 },
+    });
+    print "\n";
+}
+
+sub usage {
+    my ($exit_code) = @_;
+
+    print <<"EOF";
+Usage: config-benchmark.pl [ OPTIONS ]
+
+    --help              Output this usage screen and exit
+    --seconds N         Run each case for at least N seconds (default: $opt{seconds})
+
+EOF
+    exit ($exit_code || 0);
+}
+
+__END__
@@ -0,0 +1,97 @@
+#!/usr/bin/perl
+# This script compares the perimeter loop of make_perimeters() run on
+# arrays of Perl polygon objects with the same loop run on native
+# Slic3r::Polygon::Collection handles
+
+use strict;
+use warnings;
+
+BEGIN {
+    use FindBin;
+    use lib "$FindBin::Bin/../lib";
+}
+
+use Benchmark qw(cmpthese);
+use Getopt::Long qw(:config no_auto_abbrev);
+use Slic3r;
+use Slic3r::Geometry qw(PI scale);
+use Slic3r::Geometry::Clipper qw(offset offset2 diff_ex union_ex);
+
+my %opt = (
+    seconds     => 2,
+    islands     => 20,
+    points      => 200,
+    perimeters  => 3,
+);
+GetOptions(
+    'help'          => sub { usage() },
+    'seconds=i'     => \$opt{seconds},
+    'islands=i'     => \$opt{islands},
+    'points=i'      => \$opt{points},
+    'perimeters=i'  => \$opt{perimeters},
+) or usage(1);
+
+# a row of rings, each one with a hole, standing for the slices of a layer
+my @polygons = ();
+for my $i (0 .. $opt{islands}-1) {
+    my $circle = sub {
+        my ($radius) = @_;
+        return Slic3r::Polygon->new(
+            map [ scale($i*25 + $radius * cos(2*PI*$_/$opt{points})), scale($radius * sin(2*PI*$_/$opt{points})) ],
+                0 .. $opt{points}-1,
+        );
+    };
+    my $hole = $circle->(5);
+    $hole->reverse;
+    push @polygons, $circle->(10), $hole;
+}
+
+my $pspacing = scale 0.45;
+
+printf "==> %d islands with %d points per polygon, %d perimeters\n",
+    $opt{islands}, $opt{points}, $opt{perimeters};
+cmpthese(-$opt{seconds}, {
+    'Perl arrays' => sub {
+        my @last = @polygons;
+        my @gaps = ();
+        for my $i (1 .. $opt{perimeters}) {
+            my @offsets = @{offset2(\@last, -(1.5*$pspacing - 1), +(0.5*$pspacing - 1))};
+            push @gaps, @{diff_ex(
+                offset(\@last, -0.5*$pspacing),
+                offset(\@offsets, +0.5*$pspacing),
+            )};
+            last if !@offsets;
+            @last = @offsets;
+        }
+        my $fill = union_ex(\@last);
+    },
+    'native collections' => sub {
+        my $last = Slic3r::Polygon::Collection->new(@polygons);
+        my @gaps = ();
+        for my $i (1 .. $opt{perimeters}) {
+            my $offsets = $last->offset2(-(1.5*$pspacing - 1), +(0.5*$pspacing - 1));
+            push @gaps, $last->offset(-0.5*$pspacing)->diff_ex($offsets->offset(+0.5*$pspacing));
+            last if !$offsets->count;
+            $last = $offsets;
+        }
+        my $fill = $last->union_ex;
+    },
+});
+
+sub usage {
+    my ($exit_code) = @_;
+
+    print <<"EOF";
+Usage: marshalling-benchmark.pl [ OPTIONS ]
+
+    --help              Output this usage screen and exit
+    --seconds N         Run each case for at least N seconds (default: $opt{seconds})
+    --islands N         Number of islands in the layer (default: $opt{islands})
+    --points N          Number of points of each polygon (default: $opt{points})
+    --perimeters N      Number of perimeters to generate (default: $opt{perimeters})
+
+EOF
+    exit ($exit_code || 0);
+}
+
+__END__
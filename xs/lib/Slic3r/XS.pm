@@ -8,6 +8,9 @@ use Carp qw();
 use XSLoader;
 XSLoader::load(__PACKAGE__, $VERSION);
 
+# native accessors for the options of static configs ($config->layer_height)
+Slic3r::Config::install_static_accessors();
+
 package Slic3r::Line;
 use overload
     '@{}' => sub { $_[0]->arrayref },
@@ -68,11 +71,21 @@ our @ISA = 'Slic3r::Polygon';
 
 sub DESTROY {}
 
+package Slic3r::Polygon::Collection;
+use overload
+    '@{}' => sub { $_[0]->arrayref },
+    'fallback' => 1;
+
 package Slic3r::ExPolygon::Collection;
 use overload
     '@{}' => sub { $_[0]->arrayref },
     'fallback' => 1;
 
+package Slic3r::ExPolygon::Collection::Ref;
+our @ISA = 'Slic3r::ExPolygon::Collection';
+
+sub DESTROY {}
+
 package Slic3r::ExtrusionPath::Collection;
 use overload
     '@{}' => sub { $_[0]->arrayref },
@@ -221,4 +234,12 @@ use overload
     '@{}' => sub { $_[0]->arrayref },
     'fallback' => 1;
 
+package Slic3r::Surface::Collection::Ref;
+our @ISA = 'Slic3r::Surface::Collection';
+
+sub DESTROY {}
+
+package Slic3r::Layer::Support::Native;
+our @ISA = 'Slic3r::Layer::Native';
+
 1;
@@ -0,0 +1,394 @@
+#include "Arranger.hpp"
+#include "ClipperUtils.hpp"
+#include "Geometry.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+namespace Slic3r {
+
+class ArrangerCandidate
+{
+    public:
+    double score;
+    Point position;
+    int rotation;
+    ArrangerCandidate(double _score, const Point &_position, int _rotation)
+        : score(_score), position(_position), rotation(_rotation) {};
+    bool operator<(const ArrangerCandidate &other) const {
+        if (this->score != other.score) return this->score < other.score;
+        if (this->position.y != other.position.y) return this->position.y < other.position.y;
+        return this->position.x < other.position.x;
+    };
+};
+
+class ArrangerCandidateWorse
+{
+    public:
+    bool operator()(const ArrangerCandidate &a, const ArrangerCandidate &b) const {
+        return b < a;
+    };
+};
+
+class ArrangerPartAreaComparator
+{
+    public:
+    const std::vector<ArrangerPart>* parts;
+    ArrangerPartAreaComparator(const std::vector<ArrangerPart>* _parts) : parts(_parts) {};
+    bool operator()(size_t a, size_t b) const {
+        return (*this->parts)[a].hull.area() > (*this->parts)[b].hull.area();
+    };
+};
+
+/* Minkowski sum of two convex counter-clockwise polygons, computed by
+   merging their edges by polar angle. */
+static void
+convex_minkowski_sum(const Polygon &a, const Polygon &b, Polygon* retval)
+{
+    retval->points.clear();
+    const size_t n = a.points.size(), m = b.points.size();
+    
+    // start from the lowest (then leftmost) vertex of each polygon
+    size_t ia = 0, ib = 0;
+    for (size_t k = 1; k < n; ++k) {
+        if (a.points[k].y < a.points[ia].y || (a.points[k].y == a.points[ia].y && a.points[k].x < a.points[ia].x))
+            ia = k;
+    }
+    for (size_t k = 1; k < m; ++k) {
+        if (b.points[k].y < b.points[ib].y || (b.points[k].y == b.points[ib].y && b.points[k].x < b.points[ib].x))
+            ib = k;
+    }
+    
+    size_t i = 0, j = 0;
+    while (i < n || j < m) {
+        const Point &pa = a.points[(ia + i) % n];
+        const Point &pb = b.points[(ib + j) % m];
+        retval->points.push_back(Point(pa.x + pb.x, pa.y + pb.y));
+        
+        const Point &na = a.points[(ia + i + 1) % n];
+        const Point &nb = b.points[(ib + j + 1) % m];
+        long double cross = (long double)(na.x - pa.x) * (nb.y - pb.y) - (long double)(na.y - pa.y) * (nb.x - pb.x);
+        if (j == m || (i < n && cross > 0)) {
+            ++i;
+        } else if (i == n || cross < 0) {
+            ++j;
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+}
+
+/* Returns true if the point lies strictly inside the convex counter-clockwise
+   polygon; points on its boundary are not considered inside. */
+static bool
+convex_contains_strictly(const Polygon &polygon, const Point &point)
+{
+    const size_t n = polygon.points.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Point &a = polygon.points[i];
+        const Point &b = polygon.points[(i + 1) % n];
+        long double cross = (long double)(b.x - a.x) * (point.y - a.y) - (long double)(b.y - a.y) * (point.x - a.x);
+        if (cross <= 0) return false;
+    }
+    return true;
+}
+
+Arranger::Arranger(coord_t _distance, int _rotations)
+    : distance(_distance), rotations(std::max(_rotations, 1)), has_bed(false), time_budget(0)
+{}
+
+void
+Arranger::set_bed(const BoundingBox &bed)
+{
+    this->bed = bed;
+    this->has_bed = true;
+}
+
+void
+Arranger::set_time_budget(double seconds)
+{
+    this->time_budget = seconds;
+}
+
+size_t
+Arranger::add_part(const Polygon &hull)
+{
+    this->parts.push_back(ArrangerPart(hull));
+    return this->parts.size() - 1;
+}
+
+void
+Arranger::inflated_hull(const Polygon &hull, double angle, Polygon* retval) const
+{
+    Points points = hull.points;
+    if (angle != 0) {
+        Point origin(0, 0);
+        for (Points::iterator p = points.begin(); p != points.end(); ++p)
+            p->rotate(angle, &origin);
+    }
+    if (points.size() < 3) {
+        // degenerate parts are represented by their bounding box
+        BoundingBox bb(points.empty() ? Points(1, Point(0,0)) : points);
+        bb.polygon(retval);
+        points = retval->points;
+    }
+    
+    // keep half of the distance on each side
+    if (this->distance > 0) {
+        Polygon polygon;
+        polygon.points = points;
+        Polygons grown;
+        offset(Polygons(1, polygon), grown, this->distance / 2.0, 100000, ClipperLib::jtMiter, 2);
+        points.clear();
+        for (Polygons::const_iterator it = grown.begin(); it != grown.end(); ++it)
+            points.insert(points.end(), it->points.begin(), it->points.end());
+    }
+    Slic3r::Geometry::convex_hull(points, retval);
+    retval->make_counter_clockwise();
+}
+
+/* Generates the candidate positions of a part in the given rotation step,
+   scored by the compactness of the resulting layout, along with the no-fit
+   polygons of the part against the parts already placed. */
+void
+Arranger::candidates(const Polygon &part_hull, int rotation, const Polygons &placed,
+    const BoundingBox &layout_bb, Polygons* nfps, std::vector<BoundingBox>* nfps_bb,
+    std::vector<ArrangerCandidate>* retval) const
+{
+    Polygon hull;
+    this->inflated_hull(part_hull, 2*PI*rotation/this->rotations, &hull);
+    BoundingBox hull_bb(hull.points);
+    
+    // inner-fit rectangle: positions keeping the part inside the bed
+    BoundingBox ifr;
+    if (this->has_bed) {
+        ifr.min = Point(this->bed.min.x - hull_bb.min.x, this->bed.min.y - hull_bb.min.y);
+        ifr.max = Point(this->bed.max.x - hull_bb.max.x, this->bed.max.y - hull_bb.max.y);
+        if (ifr.min.x > ifr.max.x || ifr.min.y > ifr.max.y) return;
+    }
+    
+    Points positions;
+    if (this->has_bed) {
+        positions.push_back(ifr.min);
+        positions.push_back(Point(ifr.max.x, ifr.min.y));
+        positions.push_back(Point(ifr.min.x, ifr.max.y));
+        positions.push_back(ifr.max);
+    } else if (placed.empty()) {
+        positions.push_back(Point(-hull_bb.min.x, -hull_bb.min.y));
+    }
+    
+    // no-fit polygons: positions where the part touches a placed part
+    Polygon reflected = hull;
+    for (Points::iterator p = reflected.points.begin(); p != reflected.points.end(); ++p) {
+        p->x = -p->x;
+        p->y = -p->y;
+    }
+    nfps->reserve(placed.size());
+    nfps_bb->reserve(placed.size());
+    for (Polygons::const_iterator it = placed.begin(); it != placed.end(); ++it) {
+        nfps->push_back(Polygon());
+        convex_minkowski_sum(*it, reflected, &nfps->back());
+        nfps_bb->push_back(BoundingBox(nfps->back().points));
+        positions.insert(positions.end(), nfps->back().points.begin(), nfps->back().points.end());
+    }
+    
+    // let the part slide along the no-fit polygons until it's aligned
+    // with the sides of the layout (or of the bed)
+    if (!placed.empty()) {
+        std::vector<coord_t> xs, ys;
+        xs.push_back(layout_bb.min.x - hull_bb.min.x);
+        xs.push_back(layout_bb.max.x - hull_bb.max.x);
+        ys.push_back(layout_bb.min.y - hull_bb.min.y);
+        ys.push_back(layout_bb.max.y - hull_bb.max.y);
+        if (this->has_bed) {
+            xs.push_back(ifr.min.x);
+            xs.push_back(ifr.max.x);
+            ys.push_back(ifr.min.y);
+            ys.push_back(ifr.max.y);
+        }
+        for (Polygons::const_iterator nfp = nfps->begin(); nfp != nfps->end(); ++nfp) {
+            Lines lines = nfp->lines();
+            for (Lines::const_iterator line = lines.begin(); line != lines.end(); ++line) {
+                const Point &a = line->a, &b = line->b;
+                for (std::vector<coord_t>::const_iterator x = xs.begin(); x != xs.end(); ++x) {
+                    if (a.x == b.x || *x <= std::min(a.x, b.x) || *x >= std::max(a.x, b.x)) continue;
+                    positions.push_back(Point(*x, a.y + (double)(b.y - a.y) * (*x - a.x) / (b.x - a.x)));
+                }
+                for (std::vector<coord_t>::const_iterator y = ys.begin(); y != ys.end(); ++y) {
+                    if (a.y == b.y || *y <= std::min(a.y, b.y) || *y >= std::max(a.y, b.y)) continue;
+                    positions.push_back(Point(a.x + (double)(b.x - a.x) * (*y - a.y) / (b.y - a.y), *y));
+                }
+            }
+        }
+    }
+    
+    retval->reserve(positions.size());
+    for (Points::const_iterator p = positions.begin(); p != positions.end(); ++p) {
+        if (this->has_bed && (p->x < ifr.min.x || p->x > ifr.max.x || p->y < ifr.min.y || p->y > ifr.max.y))
+            continue;
+        BoundingBox bb = hull_bb;
+        bb.translate(p->x, p->y);
+        if (!placed.empty()) bb.merge(layout_bb);
+        const double w = bb.max.x - bb.min.x;
+        const double h = bb.max.y - bb.min.y;
+        retval->push_back(ArrangerCandidate(w*h + std::max(w, h)*std::max(w, h), *p, rotation));
+    }
+}
+
+// generates the candidates of one rotation step per task
+class ArrangerRotationJob : public ThreadPoolJob
+{
+    public:
+    const Arranger &arranger;
+    const Polygon &hull;
+    const Polygons &placed;
+    const BoundingBox &layout_bb;
+    std::vector<Polygons> &nfps;
+    std::vector<std::vector<BoundingBox> > &nfps_bb;
+    std::vector<std::vector<ArrangerCandidate> > &candidates;
+    
+    ArrangerRotationJob(const Arranger &_arranger, const Polygon &_hull, const Polygons &_placed,
+        const BoundingBox &_layout_bb, std::vector<Polygons> &_nfps,
+        std::vector<std::vector<BoundingBox> > &_nfps_bb, std::vector<std::vector<ArrangerCandidate> > &_candidates)
+        : arranger(_arranger), hull(_hull), placed(_placed), layout_bb(_layout_bb), nfps(_nfps),
+          nfps_bb(_nfps_bb), candidates(_candidates) {};
+    void run(size_t task) {
+        this->arranger.candidates(this->hull, task, this->placed, this->layout_bb,
+            &this->nfps[task], &this->nfps_bb[task], &this->candidates[task]);
+    };
+};
+
+/* Checks a block of candidates, in score order, against the no-fit polygons.
+   Each task checks a contiguous range and stops at its first free candidate,
+   as the ones following it can't win. */
+class ArrangerCheckJob : public ThreadPoolJob
+{
+    public:
+    const std::vector<ArrangerCandidate> &block;
+    const std::vector<Polygons> &nfps;
+    const std::vector<std::vector<BoundingBox> > &nfps_bb;
+    size_t tasks;
+    std::vector<size_t> first_free;     // for each task, index in block or block.size()
+    
+    ArrangerCheckJob(const std::vector<ArrangerCandidate> &_block, const std::vector<Polygons> &_nfps,
+        const std::vector<std::vector<BoundingBox> > &_nfps_bb, size_t _tasks)
+        : block(_block), nfps(_nfps), nfps_bb(_nfps_bb), tasks(_tasks), first_free(_tasks, _block.size()) {};
+    void run(size_t task) {
+        for (size_t i = this->block.size() * task / this->tasks; i < this->block.size() * (task+1) / this->tasks; ++i) {
+            const Point &p = this->block[i].position;
+            const Polygons &nfp = this->nfps[this->block[i].rotation];
+            const std::vector<BoundingBox> &nfp_bb = this->nfps_bb[this->block[i].rotation];
+            bool found = true;
+            for (size_t k = 0; k < nfp.size() && found; ++k) {
+                if (p.x <= nfp_bb[k].min.x || p.x >= nfp_bb[k].max.x || p.y <= nfp_bb[k].min.y || p.y >= nfp_bb[k].max.y)
+                    continue;
+                if (convex_contains_strictly(nfp[k], p)) found = false;
+            }
+            if (found) {
+                this->first_free[task] = i;
+                return;
+            }
+        }
+    };
+};
+
+/* Computes the position (and rotation) of all parts. Returns false if
+   some part can't fit the bed, leaving the parts unchanged. */
+bool
+Arranger::arrange(ThreadPool* pool)
+{
+    const double start = ProfilerSample().wall_time;
+    
+    // place larger parts first
+    std::vector<size_t> order;
+    for (size_t i = 0; i < this->parts.size(); ++i) order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), ArrangerPartAreaComparator(&this->parts));
+    
+    Polygons placed;                    // inflated hulls of the placed parts, translated
+    BoundingBox layout_bb;              // bounding box of all placed parts
+    std::vector<Point> positions(this->parts.size());
+    std::vector<int> part_rotations(this->parts.size(), 0);
+    
+    // most parts are placed after a few attempts, so candidates are checked
+    // in small blocks
+    const size_t block_size = 8 * pool->size();
+    
+    for (std::vector<size_t>::const_iterator part_idx = order.begin(); part_idx != order.end(); ++part_idx) {
+        const ArrangerPart &part = this->parts[*part_idx];
+        
+        // once the time budget is exhausted, only try parts unrotated
+        int num_rotations = this->rotations;
+        if (this->time_budget > 0 && ProfilerSample().wall_time - start > this->time_budget)
+            num_rotations = 1;
+        
+        std::vector<Polygons> nfps(num_rotations);
+        std::vector<std::vector<BoundingBox> > nfps_bb(num_rotations);
+        std::vector<ArrangerCandidate> candidates;
+        {
+            std::vector<std::vector<ArrangerCandidate> > rotation_candidates(num_rotations);
+            ArrangerRotationJob job(*this, part.hull, placed, layout_bb, nfps, nfps_bb, rotation_candidates);
+            pool->run(&job, num_rotations);
+            for (int r = 0; r < num_rotations; ++r)
+                candidates.insert(candidates.end(), rotation_candidates[r].begin(), rotation_candidates[r].end());
+        }
+        
+        // try the most compact candidates first; candidates are popped from
+        // a heap instead of sorted, as only the first blocks are usually needed
+        std::make_heap(candidates.begin(), candidates.end(), ArrangerCandidateWorse());
+        std::vector<ArrangerCandidate>::iterator heap_end = candidates.end();
+        const ArrangerCandidate* candidate = NULL;
+        std::vector<ArrangerCandidate> block;
+        while (heap_end != candidates.begin() && candidate == NULL) {
+            block.clear();
+            while (heap_end != candidates.begin() && block.size() < block_size) {
+                std::pop_heap(candidates.begin(), heap_end, ArrangerCandidateWorse());
+                --heap_end;
+                block.push_back(*heap_end);
+            }
+            ArrangerCheckJob job(block, nfps, nfps_bb, std::min(pool->size(), block.size()));
+            pool->run(&job, job.tasks);
+            size_t first_free = *std::min_element(job.first_free.begin(), job.first_free.end());
+            if (first_free < block.size()) candidate = &block[first_free];
+        }
+        if (candidate == NULL) return false;
+        
+        Polygon hull;
+        this->inflated_hull(part.hull, 2*PI*candidate->rotation/this->rotations, &hull);
+        hull.translate(candidate->position.x, candidate->position.y);
+        placed.push_back(hull);
+        if (placed.size() == 1) {
+            layout_bb = BoundingBox(hull.points);
+        } else {
+            layout_bb.merge(BoundingBox(hull.points));
+        }
+        positions[*part_idx] = candidate->position;
+        part_rotations[*part_idx] = candidate->rotation;
+    }
+    
+    for (size_t i = 0; i < this->parts.size(); ++i) {
+        this->parts[i].position = positions[i];
+        this->parts[i].rotation = 2*PI*part_rotations[i]/this->rotations;
+    }
+    
+    // without a bed, align the parts (not their spacing) to the origin
+    if (!this->has_bed) {
+        Points points;
+        Point origin(0, 0);
+        for (std::vector<ArrangerPart>::const_iterator part = this->parts.begin(); part != this->parts.end(); ++part) {
+            for (Points::const_iterator p = part->hull.points.begin(); p != part->hull.points.end(); ++p) {
+                Point point = *p;
+                point.rotate(part->rotation, &origin);
+                point.translate(part->position.x, part->position.y);
+                points.push_back(point);
+            }
+        }
+        if (!points.empty()) {
+            BoundingBox bb(points);
+            for (std::vector<ArrangerPart>::iterator part = this->parts.begin(); part != this->parts.end(); ++part)
+                part->position.translate(-bb.min.x, -bb.min.y);
+        }
+    }
+    return true;
+}
+
+}
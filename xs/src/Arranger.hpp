@@ -0,0 +1,57 @@
+#ifndef slic3r_Arranger_hpp_
+#define slic3r_Arranger_hpp_
+
+#include <myinit.h>
+#include "BoundingBox.hpp"
+#include "Polygon.hpp"
+#include "ThreadPool.hpp"
+#include <vector>
+
+namespace Slic3r {
+
+class ArrangerCandidate;
+
+class ArrangerPart
+{
+    public:
+    Polygon hull;           // convex hull of the part, not translated
+    Point position;         // computed translation
+    double rotation;        // computed rotation around origin, in radians
+    ArrangerPart(const Polygon &_hull) : hull(_hull), rotation(0) {};
+};
+
+/* Packs parts by their convex hulls using a bottom-left-fill heuristic:
+   parts are placed from the largest one, and the candidate positions of
+   each part are the vertices of its no-fit polygons against the parts
+   already placed. The candidate yielding the most compact layout wins.
+   Candidates are generated and scored for each rotation, then checked
+   for overlaps in blocks, on the thread pool; the first free candidate
+   in score order wins, so the layout doesn't depend on the pool size. */
+class Arranger
+{
+    public:
+    std::vector<ArrangerPart> parts;
+    
+    Arranger(coord_t _distance, int _rotations = 1);
+    void set_bed(const BoundingBox &bed);
+    void set_time_budget(double seconds);
+    size_t add_part(const Polygon &hull);
+    bool arrange(ThreadPool* pool);
+    
+    private:
+    friend class ArrangerRotationJob;
+    coord_t distance;       // minimum distance between parts
+    int rotations;          // number of rotation steps tried for each part
+    bool has_bed;
+    BoundingBox bed;
+    double time_budget;     // wall seconds after which parts are only tried unrotated
+    
+    void inflated_hull(const Polygon &hull, double angle, Polygon* retval) const;
+    void candidates(const Polygon &part_hull, int rotation, const Polygons &placed,
+        const BoundingBox &layout_bb, Polygons* nfps, std::vector<BoundingBox>* nfps_bb,
+        std::vector<ArrangerCandidate>* retval) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include "BridgeDetector.hpp"
+#include "BoundingBox.hpp"
+#include "ClipperUtils.hpp"
+#include "Line.hpp"
+
+namespace Slic3r {
+
+BridgeDetector::BridgeDetector(const ExPolygon &_expolygon, const ExPolygonCollection &_lower_slices,
+    coord_t _perimeter_flow_width, coord_t _infill_flow_width)
+    : expolygon(_expolygon), lower_slices(_lower_slices), perimeter_flow_width(_perimeter_flow_width),
+      infill_flow_width(_infill_flow_width), resolution(PI/36.0), angle(-1)
+{}
+
+/* Returns false if no direction could be detected (no supported edges, or
+   a single straight one, which is treated as an overhang). */
+bool
+BridgeDetector::detect_angle()
+{
+    Polygons grown;
+    offset((Polygons)this->expolygon, grown, +this->perimeter_flow_width);
+    
+    // detect what edges lie on lower slices
+    Polylines edges;
+    this->supported_edges(grown, &edges);
+    if (edges.empty()) return false;
+    
+    if (edges.size() == 2) {
+        // bridge between the midpoints of the chords of the two supported edges
+        Point* midpoints[2];
+        for (size_t i = 0; i < 2; ++i)
+            midpoints[i] = Line(edges[i].points.front(), edges[i].points.back()).midpoint();
+        this->angle = Line(*midpoints[0], *midpoints[1]).direction();
+        delete midpoints[0];
+        delete midpoints[1];
+        return true;
+    }
+    
+    if (edges.size() == 1) {
+        // TODO: this case includes both U-shaped bridges and plain overhangs;
+        // we need a trapezoidation algorithm to detect the actual bridged area
+        // and separate it from the overhang area.
+        // in the mean time, we're treating as overhangs all cases where
+        // our supporting edge is a straight line
+        if (edges.front().points.size() <= 2) return false;
+        this->angle = Line(edges.front().points.front(), edges.front().points.back()).direction();
+        return true;
+    }
+    
+    // outset the bridge expolygon by half the amount we used for detecting anchors;
+    // we'll use this one to clip our test lines and be sure that their endpoints
+    // are inside the anchors and not on their contours
+    ExPolygons clip_area;
+    offset_ex((Polygons)this->expolygon, clip_area, +this->perimeter_flow_width/2.0);
+    
+    // detect anchors as intersection between our bridge expolygon and the lower slices
+    // (safety offset required to avoid Clipper from detecting empty intersection while
+    // we actually found some edges)
+    ExPolygons anchors;
+    intersection(grown, (Polygons)this->lower_slices, anchors, true);
+    if (anchors.empty()) return false;
+    
+    // Try several directions using a rudimentary visibility check: bridge in each
+    // direction and sum the length of lines having both endpoints within anchors.
+    // The best direction is the one causing most lines to be bridged.
+    const size_t candidates = (size_t)(PI / this->resolution) + 1;
+    std::vector<double> scores(candidates, 0);
+    for (size_t i = 0; i < candidates; ++i)
+        scores[i] = this->coverage(i * this->resolution, clip_area, anchors);
+    
+    size_t best = 0;
+    for (size_t i = 1; i < candidates; ++i) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    
+    // lines were tested along the rotated Y axis
+    this->angle = fmod(best * this->resolution + PI/2, PI);
+    return true;
+}
+
+/* Clips the contour and holes of the grown bridge with the contour of each lower
+   slice, returning one polyline per supported edge. */
+void
+BridgeDetector::supported_edges(const Polygons &grown, Polylines* edges) const
+{
+    Polylines grown_pl;
+    for (Polygons::const_iterator it = grown.begin(); it != grown.end(); ++it) {
+        // split at first point
+        Polyline pl;
+        pl.points = it->points;
+        pl.points.push_back(it->points.front());
+        grown_pl.push_back(pl);
+    }
+    
+    for (ExPolygons::const_iterator lower = this->lower_slices.expolygons.begin(); lower != this->lower_slices.expolygons.end(); ++lower) {
+        Polylines clipped;
+        intersection(grown_pl, Polygons(1, lower->contour), clipped);
+        
+        if (clipped.size() == 2) {
+            // If the split_at_first_point() call above happens to split the polygon inside the
+            // clipping area we get two consecutive polylines instead of a single one, so we
+            // recombine them back into a single one.
+            if (clipped.front().points.front().coincides_with(clipped.back().points.back())) {
+                Polyline pl = clipped.back();
+                pl.points.insert(pl.points.end(), clipped.front().points.begin(), clipped.front().points.end());
+                clipped = Polylines(1, pl);
+            } else if (clipped.back().points.front().coincides_with(clipped.front().points.back())) {
+                Polyline pl = clipped.front();
+                pl.points.insert(pl.points.end(), clipped.back().points.begin(), clipped.back().points.end());
+                clipped = Polylines(1, pl);
+            }
+        }
+        edges->insert(edges->end(), clipped.begin(), clipped.end());
+    }
+}
+
+/* Returns the total length of the test lines, spaced by the infill flow width
+   and running at the given angle, that fall within the clip area and have both
+   endpoints anchored. */
+double
+BridgeDetector::coverage(double angle, const ExPolygons &clip_area, const ExPolygons &anchors) const
+{
+    // rotate everything by -angle so that test lines are vertical - the center point doesn't matter
+    Point center(0, 0);
+    ExPolygonCollection rotated_anchors;
+    rotated_anchors.expolygons = anchors;
+    rotated_anchors.rotate(-angle, &center);
+    ExPolygonCollection rotated_clip_area;
+    rotated_clip_area.expolygons = clip_area;
+    rotated_clip_area.rotate(-angle, &center);
+    
+    // generate lines in this direction
+    Points anchor_points;
+    for (ExPolygons::const_iterator it = rotated_anchors.expolygons.begin(); it != rotated_anchors.expolygons.end(); ++it)
+        anchor_points.insert(anchor_points.end(), it->contour.points.begin(), it->contour.points.end());
+    BoundingBox bb(anchor_points);
+    
+    Polylines lines;
+    for (coord_t x = bb.min.x; x <= bb.max.x; x += this->infill_flow_width) {
+        Polyline line;
+        line.points.push_back(Point(x, bb.min.y));
+        line.points.push_back(Point(x, bb.max.y));
+        lines.push_back(line);
+    }
+    
+    Polylines clipped;
+    intersection(lines, (Polygons)rotated_clip_area, clipped);
+    
+    // sum the length of the lines having both endpoints within anchors
+    double total_length = 0;
+    for (Polylines::const_iterator it = clipped.begin(); it != clipped.end(); ++it) {
+        const Point &a = it->points.front(), &b = it->points.back();
+        if (rotated_anchors.contains_point(&a) && rotated_anchors.contains_point(&b))
+            total_length += a.distance_to(&b);
+    }
+    return total_length;
+}
+
+class BridgeDetectorJob : public ThreadPoolJob
+{
+    public:
+    const std::vector<BridgeDetector*> &detectors;
+    std::vector<char> &found;           // one flag per detector, each written by its own task
+    BridgeDetectorJob(const std::vector<BridgeDetector*> &_detectors, std::vector<char> &_found)
+        : detectors(_detectors), found(_found) {};
+    void run(size_t task) { this->found[task] = this->detectors[task]->detect_angle() ? 1 : 0; };
+};
+
+void
+detect_bridge_angles(const std::vector<BridgeDetector*> &detectors, ThreadPool* pool,
+    std::vector<char>* found)
+{
+    found->assign(detectors.size(), 0);
+    BridgeDetectorJob job(detectors, *found);
+    pool->run(&job, detectors.size());
+}
+
+}
@@ -0,0 +1,41 @@
+#ifndef slic3r_BridgeDetector_hpp_
+#define slic3r_BridgeDetector_hpp_
+
+#include <myinit.h>
+#include "ExPolygon.hpp"
+#include "ExPolygonCollection.hpp"
+#include "Polyline.hpp"
+#include "ThreadPool.hpp"
+#include <vector>
+
+namespace Slic3r {
+
+/* Detects the optimal direction for bridging the given expolygon over the
+   slices of the lower layer. It only reads its inputs, so several detectors
+   can run concurrently. */
+class BridgeDetector
+{
+    public:
+    ExPolygon expolygon;                // the bridge, not grown
+    ExPolygonCollection lower_slices;
+    coord_t perimeter_flow_width;       // scaled, used to find the supported edges
+    coord_t infill_flow_width;          // scaled, spacing of the test lines
+    double resolution;                  // increment between candidate angles, in radians
+    double angle;                       // detected direction, in radians
+
+    BridgeDetector(const ExPolygon &_expolygon, const ExPolygonCollection &_lower_slices,
+        coord_t _perimeter_flow_width, coord_t _infill_flow_width);
+    bool detect_angle();
+
+    private:
+    void supported_edges(const Polygons &grown, Polylines* edges) const;
+    double coverage(double angle, const ExPolygons &clip_area, const ExPolygons &anchors) const;
+};
+
+// runs detect_angle() of several detectors on the pool; found gets one flag per detector
+void detect_bridge_angles(const std::vector<BridgeDetector*> &detectors, ThreadPool* pool,
+    std::vector<char>* found);
+
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "Config.hpp"
+#include <cstring>
 
 namespace Slic3r {
 
@@ -21,8 +22,32 @@ ConfigBase::apply(ConfigBase &other, bool ignore_nonexistent) {
             continue;
         }
         
-        // not the most efficient way, but easier than casting pointers to subclasses
-        my_opt->deserialize( other.option(*it)->serialize() );
+        // copy typed values directly, and only go through the string
+        // representation when the two options are stored differently
+        ConfigOption* other_opt = other.option(*it);
+        if (!my_opt->set(*other_opt))
+            my_opt->deserialize( other_opt->serialize() );
+    }
+}
+
+bool
+ConfigBase::equals(ConfigBase &other) {
+    t_config_option_keys diff;
+    this->diff(other, &diff);
+    return diff.empty();
+}
+
+// returns the sorted list of keys whose values differ in the other config;
+// keys missing from the other config are not reported
+void
+ConfigBase::diff(ConfigBase &other, t_config_option_keys *diff) {
+    t_config_option_keys opt_keys;
+    this->keys(&opt_keys);
+    
+    for (t_config_option_keys::const_iterator it = opt_keys.begin(); it != opt_keys.end(); ++it) {
+        ConfigOption* other_opt = other.option(*it);
+        if (other_opt == NULL) continue;
+        if (!this->option(*it)->equals(*other_opt)) diff->push_back(*it);
     }
 }
 
@@ -93,6 +118,11 @@ SV*
 ConfigBase::get(t_config_option_key opt_key) {
     ConfigOption* opt = this->option(opt_key);
     if (opt == NULL) return &PL_sv_undef;
+    return this->get(opt);
+}
+
+SV*
+ConfigBase::get(ConfigOption* opt) {
     if (ConfigOptionFloat* optv = dynamic_cast<ConfigOptionFloat*>(opt)) {
         return newSVnv(optv->value);
     } else if (ConfigOptionFloats* optv = dynamic_cast<ConfigOptionFloats*>(opt)) {
@@ -240,7 +270,7 @@ DynamicConfig::~DynamicConfig () {
 }
 
 ConfigOption*
-DynamicConfig::option(const t_config_option_key opt_key, bool create) {
+DynamicConfig::option(const t_config_option_key &opt_key, bool create) {
     if (this->options.count(opt_key) == 0) {
         if (create) {
             ConfigOptionDef* optdef = &(*this->def)[opt_key];
@@ -294,6 +324,91 @@ DynamicConfig::erase(const t_config_option_key opt_key) {
     this->options.erase(opt_key);
 }
 
+ConfigOptionIndex::ConfigOptionIndex(const char** keys, size_t count, const t_optiondef_map &def)
+    : keys(keys, keys + count)
+{
+    // keep the load factor at or below 1/4 so that most lookups need a single probe
+    size_t buckets = 1;
+    while (buckets < count * 4) buckets *= 2;
+    this->buckets.resize(buckets, -1);
+    
+    this->types.reserve(count);
+    for (size_t id = 0; id < count; id++) {
+        t_optiondef_map::const_iterator optdef = def.find(keys[id]);
+        if (optdef == def.end()) throw "Option index refers to an undefined option";
+        this->types.push_back(optdef->second.type);
+        
+        unsigned int slot = hash(keys[id], strlen(keys[id])) & (buckets - 1);
+        while (this->buckets[slot] != -1) slot = (slot + 1) & (buckets - 1);
+        this->buckets[slot] = id;
+    }
+}
+
+/* returns -1 if the key is not in the index */
+int
+ConfigOptionIndex::find(const t_config_option_key &opt_key) const
+{
+    const size_t mask = this->buckets.size() - 1;
+    for (unsigned int slot = hash(opt_key.c_str(), opt_key.length()) & mask; ; slot = (slot + 1) & mask) {
+        const int id = this->buckets[slot];
+        if (id == -1) return -1;
+        if (opt_key == this->keys[id]) return id;
+    }
+}
+
+size_t
+ConfigOptionIndex::size() const
+{
+    return this->keys.size();
+}
+
+const char*
+ConfigOptionIndex::key(int id) const
+{
+    return this->keys[id];
+}
+
+ConfigOptionType
+ConfigOptionIndex::type(int id) const
+{
+    return this->types[id];
+}
+
+// FNV-1a
+unsigned int
+ConfigOptionIndex::hash(const char* str, size_t length)
+{
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)str[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+ConfigOption*
+StaticConfig::option(const t_config_option_key &opt_key, bool create) {
+    const int id = this->index->find(opt_key);
+    if (id == -1) return NULL;
+    return this->option_by_id(id);
+}
+
+#ifdef SLIC3RXS
+SV*
+StaticConfig::get_by_id(int id) {
+    ConfigOption* opt = this->option_by_id(id);
+    if (opt == NULL) return &PL_sv_undef;
+    
+    // the index knows the option type, so scalars don't need the dynamic_cast chain
+    switch (this->index->type(id)) {
+        case coFloat:   return newSVnv(static_cast<ConfigOptionFloat*>(opt)->value);
+        case coInt:     return newSViv(static_cast<ConfigOptionInt*>(opt)->value);
+        case coBool:    return newSViv(static_cast<ConfigOptionBool*>(opt)->value ? 1 : 0);
+        default:        return this->get(opt);
+    }
+}
+#endif
+
 void
 StaticConfig::keys(t_config_option_keys *keys) {
     for (t_optiondef_map::const_iterator it = this->def->begin(); it != this->def->end(); ++it) {
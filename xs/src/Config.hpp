@@ -22,6 +22,14 @@ class ConfigOption {
     virtual ~ConfigOption() {};
     virtual std::string serialize() const = 0;
     virtual void deserialize(std::string str) = 0;
+    
+    /* copy the value of another option of the same type without going
+       through its string representation; returns false (leaving this option
+       untouched) when the types don't match */
+    virtual bool set(const ConfigOption &option) = 0;
+    virtual bool equals(const ConfigOption &option) const {
+        return this->serialize() == option.serialize();
+    };
 };
 
 template <class T>
@@ -57,6 +65,19 @@ class ConfigOptionFloat : public ConfigOption
     void deserialize(std::string str) {
         this->value = ::atof(str.c_str());
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionFloat* other = dynamic_cast<const ConfigOptionFloat*>(&option);
+        if (other == NULL) return false;
+        this->value = other->value;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionFloat* other = dynamic_cast<const ConfigOptionFloat*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->value == other->value;
+    };
 };
 
 class ConfigOptionFloats : public ConfigOption, public ConfigOptionVector<double>
@@ -80,6 +101,19 @@ class ConfigOptionFloats : public ConfigOption, public ConfigOptionVector<double
             this->values.push_back(::atof(item_str.c_str()));
         }
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionFloats* other = dynamic_cast<const ConfigOptionFloats*>(&option);
+        if (other == NULL) return false;
+        this->values = other->values;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionFloats* other = dynamic_cast<const ConfigOptionFloats*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->values == other->values;
+    };
 };
 
 class ConfigOptionInt : public ConfigOption
@@ -99,6 +133,19 @@ class ConfigOptionInt : public ConfigOption
     void deserialize(std::string str) {
         this->value = ::atoi(str.c_str());
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionInt* other = dynamic_cast<const ConfigOptionInt*>(&option);
+        if (other == NULL) return false;
+        this->value = other->value;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionInt* other = dynamic_cast<const ConfigOptionInt*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->value == other->value;
+    };
 };
 
 class ConfigOptionInts : public ConfigOption, public ConfigOptionVector<int>
@@ -122,6 +169,19 @@ class ConfigOptionInts : public ConfigOption, public ConfigOptionVector<int>
             this->values.push_back(::atoi(item_str.c_str()));
         }
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionInts* other = dynamic_cast<const ConfigOptionInts*>(&option);
+        if (other == NULL) return false;
+        this->values = other->values;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionInts* other = dynamic_cast<const ConfigOptionInts*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->values == other->values;
+    };
 };
 
 class ConfigOptionString : public ConfigOption
@@ -155,6 +215,19 @@ class ConfigOptionString : public ConfigOption
         
         this->value = str;
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionString* other = dynamic_cast<const ConfigOptionString*>(&option);
+        if (other == NULL) return false;
+        this->value = other->value;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionString* other = dynamic_cast<const ConfigOptionString*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->value == other->value;
+    };
 };
 
 // semicolon-separated strings
@@ -179,6 +252,19 @@ class ConfigOptionStrings : public ConfigOption, public ConfigOptionVector<std::
             this->values.push_back(item_str);
         }
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionStrings* other = dynamic_cast<const ConfigOptionStrings*>(&option);
+        if (other == NULL) return false;
+        this->values = other->values;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionStrings* other = dynamic_cast<const ConfigOptionStrings*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->values == other->values;
+    };
 };
 
 class ConfigOptionFloatOrPercent : public ConfigOption
@@ -213,6 +299,20 @@ class ConfigOptionFloatOrPercent : public ConfigOption
             this->percent = false;
         }
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionFloatOrPercent* other = dynamic_cast<const ConfigOptionFloatOrPercent*>(&option);
+        if (other == NULL) return false;
+        this->value   = other->value;
+        this->percent = other->percent;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionFloatOrPercent* other = dynamic_cast<const ConfigOptionFloatOrPercent*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->value == other->value && this->percent == other->percent;
+    };
 };
 
 class ConfigOptionPoint : public ConfigOption
@@ -234,6 +334,19 @@ class ConfigOptionPoint : public ConfigOption
     void deserialize(std::string str) {
         sscanf(str.c_str(), "%lf%*1[,x]%lf", &this->point.x, &this->point.y);
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionPoint* other = dynamic_cast<const ConfigOptionPoint*>(&option);
+        if (other == NULL) return false;
+        this->point = other->point;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionPoint* other = dynamic_cast<const ConfigOptionPoint*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->point.x == other->point.x && this->point.y == other->point.y;
+    };
 };
 
 class ConfigOptionPoints : public ConfigOption, public ConfigOptionVector<Pointf>
@@ -261,6 +374,24 @@ class ConfigOptionPoints : public ConfigOption, public ConfigOptionVector<Pointf
             this->values.push_back(point);
         }
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionPoints* other = dynamic_cast<const ConfigOptionPoints*>(&option);
+        if (other == NULL) return false;
+        this->values = other->values;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionPoints* other = dynamic_cast<const ConfigOptionPoints*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        if (this->values.size() != other->values.size()) return false;
+        for (size_t i = 0; i < this->values.size(); ++i) {
+            if (this->values[i].x != other->values[i].x || this->values[i].y != other->values[i].y)
+                return false;
+        }
+        return true;
+    };
 };
 
 class ConfigOptionBool : public ConfigOption
@@ -278,6 +409,19 @@ class ConfigOptionBool : public ConfigOption
     void deserialize(std::string str) {
         this->value = (str.compare("1") == 0);
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionBool* other = dynamic_cast<const ConfigOptionBool*>(&option);
+        if (other == NULL) return false;
+        this->value = other->value;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionBool* other = dynamic_cast<const ConfigOptionBool*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->value == other->value;
+    };
 };
 
 class ConfigOptionBools : public ConfigOption, public ConfigOptionVector<bool>
@@ -301,10 +445,59 @@ class ConfigOptionBools : public ConfigOption, public ConfigOptionVector<bool>
             this->values.push_back(item_str.compare("1") == 0);
         }
     };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionBools* other = dynamic_cast<const ConfigOptionBools*>(&option);
+        if (other == NULL) return false;
+        this->values = other->values;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionBools* other = dynamic_cast<const ConfigOptionBools*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->values == other->values;
+    };
 };
 
 typedef std::map<std::string,int> t_config_enum_values;
 
+/* We use this one in DynamicConfig objects, otherwise it's better to use
+   the specialized ConfigOptionEnum<T> containers. */
+class ConfigOptionEnumGeneric : public ConfigOption
+{
+    public:
+    int value;
+    t_config_enum_values* keys_map;
+    
+    operator int() const { return this->value; };
+    
+    std::string serialize() const {
+        for (t_config_enum_values::iterator it = this->keys_map->begin(); it != this->keys_map->end(); ++it) {
+            if (it->second == this->value) return it->first;
+        }
+        return "";
+    };
+
+    void deserialize(std::string str) {
+        assert(this->keys_map->count(str) != 0);
+        this->value = (*this->keys_map)[str];
+    };
+    
+    bool set(const ConfigOption &option) {
+        const ConfigOptionEnumGeneric* other = dynamic_cast<const ConfigOptionEnumGeneric*>(&option);
+        if (other == NULL) return false;
+        this->value = other->value;
+        return true;
+    };
+    
+    bool equals(const ConfigOption &option) const {
+        const ConfigOptionEnumGeneric* other = dynamic_cast<const ConfigOptionEnumGeneric*>(&option);
+        if (other == NULL) return ConfigOption::equals(option);
+        return this->value == other->value;
+    };
+};
+
 template <class T>
 class ConfigOptionEnum : public ConfigOption
 {
@@ -327,30 +520,28 @@ class ConfigOptionEnum : public ConfigOption
         this->value = static_cast<T>(enum_keys_map[str]);
     };
 
-    static t_config_enum_values get_enum_values();
-};
-
-/* We use this one in DynamicConfig objects, otherwise it's better to use
-   the specialized ConfigOptionEnum<T> containers. */
-class ConfigOptionEnumGeneric : public ConfigOption
-{
-    public:
-    int value;
-    t_config_enum_values* keys_map;
-    
-    operator int() const { return this->value; };
-    
-    std::string serialize() const {
-        for (t_config_enum_values::iterator it = this->keys_map->begin(); it != this->keys_map->end(); ++it) {
-            if (it->second == this->value) return it->first;
+    bool set(const ConfigOption &option) {
+        if (const ConfigOptionEnum<T>* other = dynamic_cast<const ConfigOptionEnum<T>*>(&option)) {
+            this->value = other->value;
+            return true;
         }
-        return "";
+        // DynamicConfig stores enums as generic ones, and they share the numeric values
+        if (const ConfigOptionEnumGeneric* other = dynamic_cast<const ConfigOptionEnumGeneric*>(&option)) {
+            this->value = static_cast<T>(other->value);
+            return true;
+        }
+        return false;
     };
-
-    void deserialize(std::string str) {
-        assert(this->keys_map->count(str) != 0);
-        this->value = (*this->keys_map)[str];
+    
+    bool equals(const ConfigOption &option) const {
+        if (const ConfigOptionEnum<T>* other = dynamic_cast<const ConfigOptionEnum<T>*>(&option))
+            return this->value == other->value;
+        if (const ConfigOptionEnumGeneric* other = dynamic_cast<const ConfigOptionEnumGeneric*>(&option))
+            return static_cast<int>(this->value) == other->value;
+        return ConfigOption::equals(option);
     };
+    
+    static t_config_enum_values get_enum_values();
 };
 
 enum ConfigOptionType {
@@ -405,9 +596,11 @@ class ConfigBase
     
     ConfigBase() : def(NULL) {};
     bool has(const t_config_option_key opt_key);
-    virtual ConfigOption* option(const t_config_option_key opt_key, bool create = false) = 0;
+    virtual ConfigOption* option(const t_config_option_key &opt_key, bool create = false) = 0;
     virtual void keys(t_config_option_keys *keys) = 0;
     void apply(ConfigBase &other, bool ignore_nonexistent = false);
+    bool equals(ConfigBase &other);
+    void diff(ConfigBase &other, t_config_option_keys *diff);
     std::string serialize(const t_config_option_key opt_key);
     void set_deserialize(const t_config_option_key opt_key, std::string str);
     double get_abs_value(const t_config_option_key opt_key);
@@ -416,6 +609,7 @@ class ConfigBase
     #ifdef SLIC3RXS
     SV* as_hash();
     SV* get(t_config_option_key opt_key);
+    SV* get(ConfigOption* opt);
     SV* get_at(t_config_option_key opt_key, size_t i);
     void set(t_config_option_key opt_key, SV* value);
     #endif
@@ -426,7 +620,7 @@ class DynamicConfig : public ConfigBase
     public:
     DynamicConfig() {};
     ~DynamicConfig();
-    ConfigOption* option(const t_config_option_key opt_key, bool create = false);
+    ConfigOption* option(const t_config_option_key &opt_key, bool create = false);
     void keys(t_config_option_keys *keys);
     void erase(const t_config_option_key opt_key);
     
@@ -437,10 +631,39 @@ class DynamicConfig : public ConfigBase
     t_options_map options;
 };
 
+/* Maps the option keys of a family of StaticConfig classes to small integer
+   IDs through an open addressing hash table, so that looking up an option
+   costs one hash and one string comparison. The type of each option is
+   recorded too, so that callers holding an ID can skip dynamic_cast. */
+class ConfigOptionIndex
+{
+    public:
+    ConfigOptionIndex(const char** keys, size_t count, const t_optiondef_map &def);
+    int find(const t_config_option_key &opt_key) const;
+    size_t size() const;
+    const char* key(int id) const;
+    ConfigOptionType type(int id) const;
+    
+    private:
+    std::vector<const char*> keys;
+    std::vector<ConfigOptionType> types;
+    std::vector<int> buckets;   // option ID or -1, size is a power of two
+    static unsigned int hash(const char* str, size_t length);
+};
+
 class StaticConfig : public ConfigBase
 {
     public:
+    const ConfigOptionIndex* index;
+    
+    StaticConfig() : index(NULL) {};
+    ConfigOption* option(const t_config_option_key &opt_key, bool create = false);
+    virtual ConfigOption* option_by_id(int id) = 0;
     void keys(t_config_option_keys *keys);
+    
+    #ifdef SLIC3RXS
+    SV* get_by_id(int id);
+    #endif
 };
 
 }
@@ -36,6 +36,11 @@ class ExPolygon
     #endif
 };
 
+#ifdef SLIC3RXS
+// accepts Slic3r::ExPolygon::Collection
+bool from_SV_collection(SV* sv, ExPolygons* expolygons);
+#endif
+
 }
 
 #endif
@@ -67,4 +67,15 @@ ExPolygonCollection::convex_hull(Polygon* hull) const
     Slic3r::Geometry::convex_hull(pp, hull);
 }
 
+#ifdef SLIC3RXS
+bool
+from_SV_collection(SV* sv, ExPolygons* expolygons)
+{
+    if (!sv_isa(sv, "Slic3r::ExPolygon::Collection") && !sv_isa(sv, "Slic3r::ExPolygon::Collection::Ref"))
+        return false;
+    *expolygons = ((ExPolygonCollection*)SvIV((SV*)SvRV(sv)))->expolygons;
+    return true;
+}
+#endif
+
 }
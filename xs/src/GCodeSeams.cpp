@@ -0,0 +1,131 @@
+#include "GCodeSeams.hpp"
+#include <cmath>
+
+namespace Slic3r {
+
+// same as Slic3r::Geometry::angle3points(), with the same rounding
+static double
+angle3points(const Point &center, const Point &p2, const Point &p3)
+{
+    double angle = atan2((double)(p2.x - center.x), (double)(p2.y - center.y))
+                 - atan2((double)(p3.x - center.x), (double)(p3.y - center.y));
+
+    // we only want to return only positive angles
+    return angle <= 0 ? angle + 2*PI : angle;
+}
+
+// same points in the same order as Slic3r::Polygon::concave_points(),
+// which starts from the last one
+static void
+polygon_concave_points(const Polygon &polygon, Points* retval)
+{
+    const Points &points = polygon.points;
+    const int n = points.size();
+    for (int i = -1; i < n-1; ++i) {
+        const Point &p = points[(i+n) % n];
+        if (angle3points(p, points[(i-1+n) % n], points[(i+1) % n]) < PI - 1e-4)
+            retval->push_back(p);
+    }
+}
+
+static void
+non_overhang_points(const Points &points, const ExPolygonCollection &overhangs, Points* retval)
+{
+    for (Points::const_iterator p = points.begin(); p != points.end(); ++p) {
+        if (!overhangs.contains_point(&*p)) retval->push_back(*p);
+    }
+}
+
+void
+GCodeSeams::add_layer(const Layer* layer)
+{
+    this->layers.push_back(layer);
+    this->layer_loops.push_back(this->loops.size());
+    for (LayerRegionPtrs::const_iterator region = layer->regions.begin(); region != layer->regions.end(); ++region)
+        this->add_loops((*region)->perimeters);
+}
+
+void
+GCodeSeams::add_loops(const ExtrusionEntityCollection &collection)
+{
+    for (ExtrusionEntitiesPtr::const_iterator it = collection.entities.begin(); it != collection.entities.end(); ++it) {
+        if (const ExtrusionLoop* loop = dynamic_cast<const ExtrusionLoop*>(*it)) {
+            this->loop_index[loop] = this->loops.size();
+            this->loops.push_back(loop);
+        } else if (const ExtrusionEntityCollection* sub = dynamic_cast<const ExtrusionEntityCollection*>(*it)) {
+            this->add_loops(*sub);
+        }
+    }
+}
+
+class GCodeSeamsJob : public ThreadPoolJob
+{
+    public:
+    GCodeSeams* seams;
+    GCodeSeamsJob(GCodeSeams* _seams) : seams(_seams) {};
+    void run(size_t task) {
+        this->seams->process_layer(task);
+    };
+};
+
+// one task per layer, each one only writes the candidates of its own loops
+void
+GCodeSeams::process(ThreadPool* pool)
+{
+    this->loop_candidates.clear();
+    this->loop_candidates.resize(this->loops.size());
+
+    GCodeSeamsJob job(this);
+    pool->run(&job, this->layers.size());
+}
+
+/* Mirrors the candidate selection of Slic3r::GCode::extrude_loop(): concave
+   points not lying on overhangs, else any concave point, else any point not
+   lying on overhangs, else any point. The loop is only read; its polygon is
+   copied to be made counter-clockwise like extrude_loop() does. */
+void
+GCodeSeams::process_layer(size_t layer_id)
+{
+    const Layer &layer = *this->layers[layer_id];
+
+    // overhangs are the bottom surfaces of the layer, which has none at 0
+    ExPolygonCollection overhangs;
+    if (this->non_overhang && layer.id > 0) {
+        for (LayerRegionPtrs::const_iterator region = layer.regions.begin(); region != layer.regions.end(); ++region) {
+            const Surfaces &surfaces = (*region)->slices.surfaces;
+            for (Surfaces::const_iterator s = surfaces.begin(); s != surfaces.end(); ++s) {
+                if (s->surface_type == stBottom) overhangs.expolygons.push_back(s->expolygon);
+            }
+        }
+    }
+
+    const size_t last = layer_id+1 < this->layers.size() ? this->layer_loops[layer_id+1] : this->loops.size();
+    for (size_t i = this->layer_loops[layer_id]; i < last; ++i) {
+        Polygon polygon = this->loops[i]->polygon;
+        polygon.make_counter_clockwise();
+
+        Points concave;
+        if (this->concave_points) polygon_concave_points(polygon, &concave);
+
+        Points &retval = this->loop_candidates[i];
+        if (this->non_overhang) non_overhang_points(concave, overhangs, &retval);
+        if (retval.empty()) {
+            retval = concave;
+            if (retval.empty()) {
+                if (this->non_overhang) non_overhang_points(polygon.points, overhangs, &retval);
+                if (retval.empty()) retval = polygon.points;
+            }
+        }
+    }
+}
+
+// returns NULL if the loop doesn't belong to the layers of this batch
+const Points*
+GCodeSeams::candidates(const ExtrusionLoop* loop) const
+{
+    std::map<const ExtrusionLoop*, size_t>::const_iterator it = this->loop_index.find(loop);
+    if (it == this->loop_index.end() || it->second >= this->loop_candidates.size()) return NULL;
+    return &this->loop_candidates[it->second];
+}
+
+}
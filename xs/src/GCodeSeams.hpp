@@ -0,0 +1,45 @@
+#ifndef slic3r_GCodeSeams_hpp_
+#define slic3r_GCodeSeams_hpp_
+
+#include <myinit.h>
+#include <map>
+#include <vector>
+#include "ExtrusionEntityCollection.hpp"
+#include "Layer.hpp"
+#include "ThreadPool.hpp"
+
+namespace Slic3r {
+
+/* Candidate starting points of the perimeter loops of some layers. They only
+   depend on the loop and on the bottom surfaces of its layer, not on the
+   position of the extruder, so they're computed for a batch of layers on the
+   pool before the G-code of those layers is emitted; the G-code generator
+   then only picks the candidate nearest to its position. The layers must not
+   change between process() and the last lookup. */
+class GCodeSeams
+{
+    public:
+    bool concave_points;        // start_perimeters_at_concave_points
+    bool non_overhang;          // start_perimeters_at_non_overhang
+
+    GCodeSeams(bool _concave_points, bool _non_overhang)
+        : concave_points(_concave_points), non_overhang(_non_overhang) {};
+    void add_layer(const Layer* layer);
+    void process(ThreadPool* pool);
+    const Points* candidates(const ExtrusionLoop* loop) const;
+
+    private:
+    friend class GCodeSeamsJob;
+    std::vector<const Layer*> layers;
+    std::vector<size_t> layer_loops;    // index of the first loop of each layer in loops
+    std::vector<const ExtrusionLoop*> loops;
+    std::vector<Points> loop_candidates;
+    std::map<const ExtrusionLoop*, size_t> loop_index;
+
+    void add_loops(const ExtrusionEntityCollection &collection);
+    void process_layer(size_t layer_id);
+};
+
+}
+
+#endif
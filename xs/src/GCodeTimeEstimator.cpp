@@ -0,0 +1,302 @@
+#include "GCodeTimeEstimator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Slic3r {
+
+GCodeTimeEstimator::GCodeTimeEstimator()
+    : default_acceleration(0), extrusion_axis('E'), relative_e(false), feedrate(0),
+      acceleration(0), flushed_time(0), time_valid(true), buffered_time(0)
+{
+    this->pos[0] = this->pos[1] = this->pos[2] = this->pos[3] = 0;
+}
+
+void
+GCodeTimeEstimator::append(const std::string &gcode)
+{
+    std::string::size_type start = 0, end;
+    while ((end = gcode.find('\n', start)) != std::string::npos) {
+        this->parse_line(gcode.substr(start, end - start));
+        start = end + 1;
+    }
+    if (start < gcode.size()) {
+        this->parse_line(gcode.substr(start));
+        this->lines.back().newline = false;
+    }
+    this->time_valid = false;
+}
+
+void
+GCodeTimeEstimator::parse_line(const std::string &raw)
+{
+    this->lines.push_back(GCodeLine());
+    GCodeLine &line = this->lines.back();
+    line.raw = raw;
+
+    // strip comment
+    std::string::size_type code_end = raw.find(';');
+    if (code_end == std::string::npos) code_end = raw.size();
+
+    // split command and arguments
+    std::string cmd;
+    bool has[4] = { false, false, false, false };
+    double value[4] = { 0, 0, 0, 0 };
+    bool has_f = false, has_s = false, has_p = false, has_ij = false;
+    double f = 0, s = 0, p = 0, ij[2] = { 0, 0 };
+    std::string::size_type i = 0;
+    while (i < code_end) {
+        while (i < code_end && (raw[i] == ' ' || raw[i] == '\t' || raw[i] == '\r')) ++i;
+        if (i >= code_end) break;
+        std::string::size_type word_start = i;
+        while (i < code_end && raw[i] != ' ' && raw[i] != '\t' && raw[i] != '\r') ++i;
+        if (cmd.empty()) {
+            cmd = raw.substr(word_start, i - word_start);
+            continue;
+        }
+        const char letter = raw[word_start];
+        const double v = ::atof(raw.c_str() + word_start + 1);
+        if (letter == 'X') {
+            has[0] = true; value[0] = v;
+        } else if (letter == 'Y') {
+            has[1] = true; value[1] = v;
+        } else if (letter == 'Z') {
+            has[2] = true; value[2] = v;
+        } else if (letter == this->extrusion_axis && letter != '\0') {
+            has[3] = true; value[3] = v;
+        } else if (letter == 'F') {
+            has_f = true; f = v;
+            line.f_pos = word_start + 1;
+            line.f_len = i - line.f_pos;
+        } else if (letter == 'S') {
+            has_s = true; s = v;
+        } else if (letter == 'P') {
+            has_p = true; p = v;
+        } else if (letter == 'I') {
+            has_ij = true; ij[0] = v;
+        } else if (letter == 'J') {
+            has_ij = true; ij[1] = v;
+        }
+    }
+
+    if (cmd == "G0" || cmd == "G1" || cmd == "G2" || cmd == "G3") {
+        if (has_f) this->feedrate = f;
+        line.is_move      = true;
+        line.feedrate     = this->feedrate;
+        line.acceleration = this->acceleration > 0 ? this->acceleration : this->default_acceleration;
+
+        double target[4];
+        for (int axis = 0; axis < 4; ++axis) {
+            if (axis == 3 && this->relative_e) {
+                target[axis] = this->pos[axis] + (has[axis] ? value[axis] : 0);
+            } else {
+                target[axis] = has[axis] ? value[axis] : this->pos[axis];
+            }
+        }
+        line.dx = target[0] - this->pos[0];
+        line.dy = target[1] - this->pos[1];
+        line.dz = target[2] - this->pos[2];
+        line.de = target[3] - this->pos[3];
+
+        if ((cmd == "G2" || cmd == "G3") && has_ij) {
+            // arc length around the center at (I,J) relative to the start point
+            const double r  = sqrt(ij[0]*ij[0] + ij[1]*ij[1]);
+            const double a1 = atan2(-ij[1], -ij[0]);
+            const double a2 = atan2(line.dy - ij[1], line.dx - ij[0]);
+            double angle = (cmd == "G3") ? (a2 - a1) : (a1 - a2);
+            if (angle <= 0) angle += 2*PI;
+            line.length = sqrt(pow(r * angle, 2) + line.dz*line.dz);
+        } else {
+            line.length = sqrt(line.dx*line.dx + line.dy*line.dy + line.dz*line.dz);
+        }
+        if (line.length == 0) line.length = fabs(line.de);
+
+        // the same lines CoolingBuffer used to match: G1 moves in XY extruding at an explicit feedrate,
+        // excluding wipe moves and the first bridge move (bridges have their own speed)
+        line.slowdown_allowed = cmd == "G1"
+            && (has[0] || has[1])
+            && has[3]
+            && has_f
+            && raw.find(";_WIPE") == std::string::npos
+            && !(this->lines.size() > 1 && this->lines[this->lines.size()-2].raw == ";_BRIDGE_FAN_START");
+
+        for (int axis = 0; axis < 4; ++axis) this->pos[axis] = target[axis];
+    } else if (cmd == "G92") {
+        bool any = false;
+        for (int axis = 0; axis < 4; ++axis) {
+            if (has[axis]) {
+                this->pos[axis] = value[axis];
+                any = true;
+            }
+        }
+        if (!any) this->pos[0] = this->pos[1] = this->pos[2] = this->pos[3] = 0;
+    } else if (cmd == "G4") {
+        // P is in milliseconds and takes precedence, as in Marlin
+        if (has_p) {
+            line.dwell = p / 1000;
+        } else if (has_s) {
+            line.dwell = s;
+        }
+    } else if (cmd == "M204") {
+        if (has_s) this->acceleration = s;
+    } else if (cmd == "M82") {
+        this->relative_e = false;
+    } else if (cmd == "M83") {
+        this->relative_e = true;
+    }
+}
+
+/* Time needed to travel length mm entering at v_entry, cruising at most at
+   v_max and leaving at v_exit (all in mm/s) with the given acceleration. */
+double
+GCodeTimeEstimator::trapezoid_time(double length, double v_entry, double v_max, double v_exit, double acceleration)
+{
+    if (length <= 0 || v_max <= 0) return 0;
+    if (acceleration <= 0) return length / v_max;
+
+    const double d_accel = (v_max*v_max - v_entry*v_entry) / (2*acceleration);
+    const double d_decel = (v_max*v_max - v_exit*v_exit)   / (2*acceleration);
+    if (d_accel + d_decel <= length) {
+        // trapezoid: accelerate, cruise, decelerate
+        return (v_max - v_entry) / acceleration
+             + (v_max - v_exit)  / acceleration
+             + (length - d_accel - d_decel) / v_max;
+    }
+
+    // triangle: the cruise speed is never reached
+    const double v_peak = sqrt((2*acceleration*length + v_entry*v_entry + v_exit*v_exit) / 2);
+    if (v_peak <= std::max(v_entry, v_exit)) return 2 * length / (v_entry + v_exit);
+    return (v_peak - v_entry) / acceleration + (v_peak - v_exit) / acceleration;
+}
+
+void
+GCodeTimeEstimator::calculate_time()
+{
+    // collect moves having a duration
+    std::vector<GCodeLine*> moves;
+    for (GCodeLines::iterator it = this->lines.begin(); it != this->lines.end(); ++it) {
+        it->time = 0;
+        if (it->is_move && it->length > 0 && it->feedrate > 0) moves.push_back(&*it);
+    }
+    const size_t n = moves.size();
+
+    // maximum junction speeds: full speed through collinear moves, full stop on reversals
+    // and at the boundaries of the buffer
+    std::vector<double> v_max(n), v_junction(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) v_max[i] = moves[i]->feedrate / 60;
+    for (size_t i = 1; i < n; ++i) {
+        const GCodeLine* a = moves[i-1];
+        const GCodeLine* b = moves[i];
+        const double la = sqrt(a->dx*a->dx + a->dy*a->dy + a->dz*a->dz);
+        const double lb = sqrt(b->dx*b->dx + b->dy*b->dy + b->dz*b->dz);
+        if (la == 0 || lb == 0) continue;
+        const double cos_theta = (a->dx*b->dx + a->dy*b->dy + a->dz*b->dz) / (la * lb);
+        v_junction[i] = std::min(v_max[i-1], v_max[i]) * std::max(0.0, (1 + cos_theta) / 2);
+    }
+
+    // backward pass: make sure we can always decelerate to the next junction speed
+    for (size_t i = n; i-- > 0; ) {
+        const double a = moves[i]->acceleration;
+        if (a <= 0) continue;
+        v_junction[i] = std::min(v_junction[i], sqrt(v_junction[i+1]*v_junction[i+1] + 2*a*moves[i]->length));
+    }
+    // forward pass: make sure we can always accelerate up to the next junction speed
+    for (size_t i = 0; i < n; ++i) {
+        const double a = moves[i]->acceleration;
+        if (a <= 0) continue;
+        v_junction[i+1] = std::min(v_junction[i+1], sqrt(v_junction[i]*v_junction[i] + 2*a*moves[i]->length));
+    }
+
+    this->buffered_time = 0;
+    for (GCodeLines::iterator it = this->lines.begin(); it != this->lines.end(); ++it) {
+        it->time = it->dwell;
+        this->buffered_time += it->dwell;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        moves[i]->time = GCodeTimeEstimator::trapezoid_time(moves[i]->length,
+            std::min(v_junction[i], v_max[i]), v_max[i], std::min(v_junction[i+1], v_max[i]),
+            moves[i]->acceleration);
+        this->buffered_time += moves[i]->time;
+    }
+    this->time_valid = true;
+}
+
+/* estimated printing time of the buffered G-code, in seconds */
+double
+GCodeTimeEstimator::time()
+{
+    if (!this->time_valid) this->calculate_time();
+    return this->buffered_time;
+}
+
+/* estimated printing time of all the G-code seen so far, in seconds */
+double
+GCodeTimeEstimator::total_time() const
+{
+    return this->flushed_time + (this->time_valid ? this->buffered_time : 0);
+}
+
+/* Scales the feedrate of eligible extrusion moves, never going below min_feedrate (mm/min). */
+void
+GCodeTimeEstimator::slow_down(double speed_factor, double min_feedrate)
+{
+    if (speed_factor >= 1) return;
+    
+    char buf[64];
+    for (GCodeLines::iterator it = this->lines.begin(); it != this->lines.end(); ++it) {
+        if (!it->slowdown_allowed) continue;
+        const double new_feedrate = std::max(it->feedrate * speed_factor, min_feedrate);
+        sprintf(buf, "%.3f", new_feedrate);
+        it->raw.replace(it->f_pos, it->f_len, buf);
+        it->f_len = strlen(buf);
+        it->feedrate = new_feedrate;
+    }
+    this->time_valid = false;
+}
+
+/* Returns the buffered G-code replacing the bridge fan markers with the supplied
+   commands, and clears the buffer. */
+std::string
+GCodeTimeEstimator::flush(const std::string &bridge_fan_start, const std::string &bridge_fan_end)
+{
+    this->flushed_time += this->time();
+
+    std::string gcode;
+    for (GCodeLines::const_iterator it = this->lines.begin(); it != this->lines.end(); ++it) {
+        if (it->newline && it->raw == ";_BRIDGE_FAN_START") {
+            gcode += bridge_fan_start;
+        } else if (it->newline && it->raw == ";_BRIDGE_FAN_END") {
+            gcode += bridge_fan_end;
+        } else {
+            std::string::size_type wipe = it->raw.find(";_WIPE");
+            if (wipe == std::string::npos) {
+                gcode += it->raw;
+            } else {
+                gcode.append(it->raw, 0, wipe);
+                gcode.append(it->raw, wipe + 6, std::string::npos);
+            }
+            if (it->newline) gcode += '\n';
+        }
+    }
+    
+    this->lines.clear();
+    this->buffered_time = 0;
+    this->time_valid = true;
+    return gcode;
+}
+
+void
+GCodeTimeEstimator::reset()
+{
+    this->lines.clear();
+    this->pos[0] = this->pos[1] = this->pos[2] = this->pos[3] = 0;
+    this->feedrate = 0;
+    this->acceleration = 0;
+    this->flushed_time = 0;
+    this->buffered_time = 0;
+    this->time_valid = true;
+}
+
+}
@@ -0,0 +1,71 @@
+#ifndef slic3r_GCodeTimeEstimator_hpp_
+#define slic3r_GCodeTimeEstimator_hpp_
+
+#include <myinit.h>
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+/* A single line of buffered G-code. Lines that move the machine carry their
+   geometry so that their duration can be estimated without reparsing, and
+   lines carrying a feedrate remember where it is so that it can be rewritten
+   in place when cooling slows the layer down. */
+class GCodeLine
+{
+    public:
+    std::string raw;
+    bool newline;                   // false if raw was the unterminated tail of an appended chunk
+    bool is_move;
+    bool slowdown_allowed;          // extrusion move eligible for cooling slowdown
+    size_t f_pos, f_len;            // position of the feedrate value inside raw
+    double feedrate;                // mm/min in effect for this line
+    double acceleration;            // mm/s^2 in effect for this line, 0 = unlimited
+    double dx, dy, dz, de;          // relative motion in mm
+    double length;                  // mm (XYZ path length, or |dE| for extruder-only moves)
+    double dwell;                   // seconds spent in a G4 pause
+    double time;                    // seconds, computed by GCodeTimeEstimator::calculate_time()
+
+    GCodeLine() : newline(true), is_move(false), slowdown_allowed(false), f_pos(std::string::npos), f_len(0),
+        feedrate(0), acceleration(0), dx(0), dy(0), dz(0), de(0), length(0), dwell(0), time(0) {};
+};
+
+typedef std::vector<GCodeLine> GCodeLines;
+
+/* Buffers G-code for one or more layers and estimates its printing time using
+   a trapezoidal velocity profile (acceleration as set by M204 S, falling back
+   to default_acceleration) plus the G4 pauses. The text is parsed exactly once, when appended,
+   and flushed back byte for byte except for the feedrates changed by slow_down(). */
+class GCodeTimeEstimator
+{
+    public:
+    double default_acceleration;    // mm/s^2, 0 = unlimited
+    char extrusion_axis;            // '\0' if no extrusion axis is emitted
+    bool relative_e;
+
+    GCodeTimeEstimator();
+    void append(const std::string &gcode);
+    double time();
+    double total_time() const;
+    void slow_down(double speed_factor, double min_feedrate);
+    std::string flush(const std::string &bridge_fan_start, const std::string &bridge_fan_end);
+    void reset();
+
+    static double trapezoid_time(double length, double v_entry, double v_max, double v_exit, double acceleration);
+
+    private:
+    GCodeLines lines;
+    double pos[4];                  // X, Y, Z, E
+    double feedrate;                // mm/min
+    double acceleration;            // mm/s^2
+    double flushed_time;
+    bool time_valid;
+    double buffered_time;
+
+    void parse_line(const std::string &raw);
+    void calculate_time();
+};
+
+}
+
+#endif
@@ -0,0 +1,219 @@
+#include "HorizontalShells.hpp"
+#include "ClipperUtils.hpp"
+
+namespace Slic3r {
+
+void
+HorizontalShells::add_layer(SurfaceCollection* slices, SurfaceCollection* fill_surfaces,
+    coord_t perimeter_flow_width, coord_t solid_infill_flow_width)
+{
+    this->layers.push_back(HorizontalShellsLayer(slices, fill_surfaces, perimeter_flow_width, solid_infill_flow_width));
+}
+
+void
+HorizontalShells::process()
+{
+    this->fill_polygons.clear();
+    this->fill_polygons.resize(this->layers.size());
+    
+    for (size_t i = 0; i < this->layers.size(); ++i) {
+        if (this->solid_infill_every_layers > 0 && !this->hollow
+            && (i % this->solid_infill_every_layers) == 0) {
+            SurfaceCollection* fill_surfaces = this->layers[i].fill_surfaces;
+            for (Surfaces::iterator s = fill_surfaces->surfaces.begin(); s != fill_surfaces->surfaces.end(); ++s) {
+                if (s->surface_type == stInternal) s->surface_type = stInternalSolid;
+            }
+            this->fill_polygons[i].valid = false;
+        }
+        
+        this->propagate(i, stTop);
+        this->propagate(i, stBottom);
+    }
+}
+
+const HorizontalShellsFillPolygons&
+HorizontalShells::get_fill_polygons(size_t layer_id)
+{
+    HorizontalShellsFillPolygons &fp = this->fill_polygons[layer_id];
+    if (!fp.valid) {
+        const SurfaceCollection &fill_surfaces = *this->layers[layer_id].fill_surfaces;
+        fp.all = fill_surfaces;
+        fp.internal.clear();
+        fp.internal_solid.clear();
+        fill_surfaces.polygons_by_type(stInternal, &fp.internal);
+        fill_surfaces.polygons_by_type(stInternalSolid, &fp.internal_solid);
+        fp.valid = true;
+    }
+    return fp;
+}
+
+void
+HorizontalShells::propagate(size_t layer_id, SurfaceType type)
+{
+    // find slices of current type for current layer
+    // use slices instead of fill_surfaces because they also include the perimeter area
+    // which needs to be propagated in shells; we need to grow slices like we did for
+    // fill_surfaces though.  Using both ungrown slices and grown fill_surfaces will
+    // not work in some situations, as there won't be any grown region in the perimeter
+    // area (this was seen in a model where the top layer had one extra perimeter, thus
+    // its fill_surfaces were thinner than the lower layer's infill), however it's the best
+    // solution so far. Growing the external slices by EXTERNAL_INFILL_MARGIN will put
+    // too much solid infill inside nearly-vertical slopes.
+    Polygons solid;
+    this->layers[layer_id].slices->polygons_by_type(type, &solid);
+    this->layers[layer_id].fill_surfaces->polygons_by_type(type, &solid);
+    if (solid.empty()) return;
+    
+    const int solid_layers = (type == stTop) ? this->top_solid_layers : this->bottom_solid_layers;
+    const int step = (type == stTop) ? -1 : +1;
+    for (int n = (int)layer_id + step; abs(n - (int)layer_id) <= solid_layers-1; n += step) {
+        if (n < 0 || n >= (int)this->layers.size()) continue;
+        
+        // solid shells on one layer (for a given external surface) are always a subset
+        // of the shells found on the previous shell layer, so stop when nothing is left
+        if (!this->apply_shell(layer_id, n, &solid)) break;
+    }
+}
+
+/* Applies the given solid area of layer_id as a shell to its neighbor, updating
+   solid so that the next neighbor is limited to the areas found on this one.
+   Returns false if nothing was left to propagate. */
+bool
+HorizontalShells::apply_shell(size_t layer_id, size_t neighbor_id, Polygons* solid)
+{
+    const HorizontalShellsFillPolygons &neighbor_fill = this->get_fill_polygons(neighbor_id);
+    
+    // find intersection between neighbor and current layer's surfaces
+    // intersections have contours and holes
+    // we update solid so that we limit the next neighbor layer to the areas that were
+    // found on this one - in other words, solid shells on one layer (for a given external surface)
+    // are always a subset of the shells found on the previous shell layer
+    // this approach allows for DWIM in hollow sloping vases, where we want bottom
+    // shells to be generated in the base but not in the walls (where there are many
+    // narrow bottom surfaces): reassigning solid will consider the 'shadow' of the
+    // upper perimeter as an obstacle and shell will not be propagated to more upper layers
+    Polygons new_internal_solid;
+    {
+        Polygons internal = neighbor_fill.internal;
+        internal.insert(internal.end(), neighbor_fill.internal_solid.begin(), neighbor_fill.internal_solid.end());
+        intersection(*solid, internal, new_internal_solid, true);
+    }
+    *solid = new_internal_solid;
+    if (new_internal_solid.empty()) return false;
+    
+    if (this->hollow) {
+        // if we're printing a hollow object we discard any solid shell thinner
+        // than a perimeter width, since it's probably just crossing a sloping wall
+        // and it's not wanted in a hollow print even if it would make sense when
+        // obeying the solid shell count option strictly (DWIM!)
+        const coord_t margin = this->layers[neighbor_id].perimeter_flow_width;
+        Polygons opened, too_narrow;
+        offset2(new_internal_solid, opened, -margin, +margin, CLIPPER_OFFSET_SCALE, jtMiter, 5);
+        diff(new_internal_solid, opened, too_narrow, true);
+        if (!too_narrow.empty()) {
+            Polygons pp;
+            diff(new_internal_solid, too_narrow, pp);
+            new_internal_solid = pp;
+            *solid = new_internal_solid;
+        }
+    }
+    
+    // make sure the new internal solid is wide enough, as it might get collapsed
+    // when spacing is added in Fill.pm
+    {
+        const coord_t margin = 3 * this->layers[layer_id].solid_infill_flow_width; // require at least this size
+        // we use a higher miterLimit here to handle areas with acute angles
+        // in those cases, the default miterLimit would cut the corner and we'd
+        // get a triangle in too_narrow; if we grow it below then the shell
+        // would have a different shape from the external surface and we'd still
+        // have the same angle, so the next shell would be grown even more and so on.
+        Polygons opened, too_narrow;
+        offset2(new_internal_solid, opened, -margin, +margin, CLIPPER_OFFSET_SCALE, jtMiter, 5);
+        diff(new_internal_solid, opened, too_narrow, true);
+        
+        if (!too_narrow.empty()) {
+            // grow the collapsing parts and add the extra area to the neighbor layer
+            // as well as to our original surfaces so that we support this
+            // additional area in the next shell too
+            
+            // make sure our grown surfaces don't exceed the fill area
+            Polygons grown, grown_clipped;
+            offset(too_narrow, grown, +margin);
+            intersection(grown, neighbor_fill.all, grown_clipped);
+            new_internal_solid.insert(new_internal_solid.begin(), grown_clipped.begin(), grown_clipped.end());
+            *solid = new_internal_solid;
+        }
+    }
+    
+    // internal-solid are the union of the existing internal-solid surfaces
+    // and new ones
+    ExPolygons internal_solid;
+    {
+        Polygons pp = neighbor_fill.internal_solid;
+        pp.insert(pp.end(), new_internal_solid.begin(), new_internal_solid.end());
+        union_(pp, internal_solid);
+    }
+    Polygons internal_solid_p;
+    for (ExPolygons::const_iterator it = internal_solid.begin(); it != internal_solid.end(); ++it) {
+        Polygons pp = *it;
+        internal_solid_p.insert(internal_solid_p.end(), pp.begin(), pp.end());
+    }
+    
+    // subtract intersections from layer surfaces to get resulting internal surfaces
+    ExPolygons internal;
+    diff(neighbor_fill.internal, internal_solid_p, internal, true);
+    
+    SurfaceCollection* neighbor_fill_surfaces = this->layers[neighbor_id].fill_surfaces;
+    SurfaceCollection external;
+    for (Surfaces::const_iterator s = neighbor_fill_surfaces->surfaces.begin(); s != neighbor_fill_surfaces->surfaces.end(); ++s) {
+        if (s->surface_type == stTop || s->surface_type == stBottom) external.surfaces.push_back(*s);
+    }
+    
+    // assign resulting internal surfaces and new internal-solid surfaces to layer
+    neighbor_fill_surfaces->surfaces.clear();
+    neighbor_fill_surfaces->append(internal, stInternal);
+    neighbor_fill_surfaces->append(internal_solid, stInternalSolid);
+    
+    // assign top and bottom surfaces to layer
+    Polygons solid_and_internal_p = internal_solid_p;
+    for (ExPolygons::const_iterator it = internal.begin(); it != internal.end(); ++it) {
+        Polygons pp = *it;
+        solid_and_internal_p.insert(solid_and_internal_p.end(), pp.begin(), pp.end());
+    }
+    std::vector<SurfacesPtr> groups;
+    external.group(&groups);
+    for (std::vector<SurfacesPtr>::const_iterator group = groups.begin(); group != groups.end(); ++group) {
+        Polygons group_p;
+        for (SurfacesPtr::const_iterator s = group->begin(); s != group->end(); ++s) {
+            Polygons pp = (*s)->expolygon;
+            group_p.insert(group_p.end(), pp.begin(), pp.end());
+        }
+        ExPolygons solid_surfaces;
+        diff(group_p, solid_and_internal_p, solid_surfaces, true);
+        for (ExPolygons::const_iterator it = solid_surfaces.begin(); it != solid_surfaces.end(); ++it) {
+            Surface s = *group->front();
+            s.expolygon = *it;
+            neighbor_fill_surfaces->surfaces.push_back(s);
+        }
+    }
+    
+    this->fill_polygons[neighbor_id].valid = false;
+    return true;
+}
+
+class HorizontalShellsJob : public ThreadPoolJob
+{
+    public:
+    const std::vector<HorizontalShells*> &shells;
+    HorizontalShellsJob(const std::vector<HorizontalShells*> &_shells) : shells(_shells) {};
+    void run(size_t task) { this->shells[task]->process(); };
+};
+
+void
+process_horizontal_shells(const std::vector<HorizontalShells*> &shells, ThreadPool* pool)
+{
+    HorizontalShellsJob job(shells);
+    pool->run(&job, shells.size());
+}
+
+}
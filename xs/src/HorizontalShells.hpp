@@ -0,0 +1,74 @@
+#ifndef slic3r_HorizontalShells_hpp_
+#define slic3r_HorizontalShells_hpp_
+
+#include <myinit.h>
+#include <vector>
+#include "SurfaceCollection.hpp"
+#include "ThreadPool.hpp"
+
+namespace Slic3r {
+
+/* A layer region as seen by the shell propagator. The surface collections are
+   borrowed from the layer region, and fill_surfaces is modified in place. */
+class HorizontalShellsLayer
+{
+    public:
+    SurfaceCollection* slices;
+    SurfaceCollection* fill_surfaces;
+    coord_t perimeter_flow_width;       // scaled
+    coord_t solid_infill_flow_width;    // scaled
+
+    HorizontalShellsLayer(SurfaceCollection* _slices, SurfaceCollection* _fill_surfaces,
+        coord_t _perimeter_flow_width, coord_t _solid_infill_flow_width)
+        : slices(_slices), fill_surfaces(_fill_surfaces), perimeter_flow_width(_perimeter_flow_width),
+          solid_infill_flow_width(_solid_infill_flow_width) {};
+};
+
+/* Fill surfaces of a layer region as polygons, split by type. They only change
+   when the layer receives a new shell, so they're cached while the propagation
+   window slides over the layer. */
+class HorizontalShellsFillPolygons
+{
+    public:
+    bool valid;
+    Polygons all;
+    Polygons internal;
+    Polygons internal_solid;
+
+    HorizontalShellsFillPolygons() : valid(false) {};
+};
+
+/* Propagates the top and bottom surfaces of a region to the configured number
+   of solid layers below and above them. Regions don't share any surface, so
+   the propagators of different regions can run concurrently. */
+class HorizontalShells
+{
+    public:
+    int top_solid_layers;
+    int bottom_solid_layers;
+    int solid_infill_every_layers;
+    bool hollow;                        // true if fill_density is zero
+    std::vector<HorizontalShellsLayer> layers;
+
+    HorizontalShells(int _top_solid_layers, int _bottom_solid_layers, int _solid_infill_every_layers,
+        bool _hollow)
+        : top_solid_layers(_top_solid_layers), bottom_solid_layers(_bottom_solid_layers),
+          solid_infill_every_layers(_solid_infill_every_layers), hollow(_hollow) {};
+    void add_layer(SurfaceCollection* slices, SurfaceCollection* fill_surfaces,
+        coord_t perimeter_flow_width, coord_t solid_infill_flow_width);
+    void process();
+
+    private:
+    std::vector<HorizontalShellsFillPolygons> fill_polygons;
+
+    const HorizontalShellsFillPolygons& get_fill_polygons(size_t layer_id);
+    void propagate(size_t layer_id, SurfaceType type);
+    bool apply_shell(size_t layer_id, size_t neighbor_id, Polygons* solid);
+};
+
+// runs the propagators of several regions on the pool
+void process_horizontal_shells(const std::vector<HorizontalShells*> &shells, ThreadPool* pool);
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+#include "InfillCombiner.hpp"
+#include "ClipperUtils.hpp"
+
+namespace Slic3r {
+
+void
+InfillCombiner::add_layer(SurfaceCollection* fill_surfaces, coordf_t height)
+{
+    this->fill_surfaces.push_back(fill_surfaces);
+    this->heights.push_back(height);
+}
+
+/* Returns false if nothing could be combined. */
+bool
+InfillCombiner::combine()
+{
+    if (this->fill_surfaces.size() < 2) return false;
+    
+    // only combine internal infill
+    const SurfaceType type = stInternal;
+    
+    // intersect the candidates of all the layers; the intersection only shrinks,
+    // so stop as soon as it's empty
+    Polygons intersection_p;
+    this->fill_surfaces.front()->polygons_by_type(type, &intersection_p);
+    ExPolygons candidates;
+    for (size_t i = 1; i < this->fill_surfaces.size() && !intersection_p.empty(); ++i) {
+        Polygons layer_p;
+        this->fill_surfaces[i]->polygons_by_type(type, &layer_p);
+        if (i == this->fill_surfaces.size() - 1) {
+            Slic3r::intersection(intersection_p, layer_p, candidates);
+        } else {
+            Polygons pp;
+            Slic3r::intersection(intersection_p, layer_p, pp);
+            intersection_p = pp;
+        }
+    }
+    
+    // candidates now contains the regions that can be combined across the full
+    // amount of layers, so let's remove those areas from all layers
+    ExPolygons combined;
+    for (ExPolygons::const_iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        if (it->area() > this->area_threshold) combined.push_back(*it);
+    }
+    if (combined.empty()) return false;
+    
+    Polygons intersection_with_clearance;
+    {
+        Polygons combined_p;
+        for (ExPolygons::const_iterator it = combined.begin(); it != combined.end(); ++it) {
+            Polygons pp = *it;
+            combined_p.insert(combined_p.end(), pp.begin(), pp.end());
+        }
+        offset(combined_p, intersection_with_clearance, this->clearance);
+    }
+    
+    coordf_t thickness = 0;
+    for (std::vector<coordf_t>::const_iterator h = this->heights.begin(); h != this->heights.end(); ++h)
+        thickness += *h;
+    
+    for (size_t i = 0; i < this->fill_surfaces.size(); ++i) {
+        SurfaceCollection* fill_surfaces = this->fill_surfaces[i];
+        
+        Polygons this_type_p;
+        fill_surfaces->polygons_by_type(type, &this_type_p);
+        ExPolygons new_this_type;
+        diff(this_type_p, intersection_with_clearance, new_this_type);
+        
+        SurfaceCollection new_surfaces;
+        new_surfaces.append(new_this_type, type);
+        
+        // apply surfaces back with adjusted depth to the uppermost layer
+        if (i == this->fill_surfaces.size() - 1) {
+            SurfaceCollection thick;
+            thick.append(combined, type);
+            for (Surfaces::iterator s = thick.surfaces.begin(); s != thick.surfaces.end(); ++s) {
+                s->thickness        = thickness;
+                s->thickness_layers = this->fill_surfaces.size();
+            }
+            new_surfaces.surfaces.insert(new_surfaces.surfaces.end(), thick.surfaces.begin(), thick.surfaces.end());
+        }
+        
+        for (Surfaces::const_iterator s = fill_surfaces->surfaces.begin(); s != fill_surfaces->surfaces.end(); ++s) {
+            if (s->surface_type != type) new_surfaces.surfaces.push_back(*s);
+        }
+        fill_surfaces->surfaces = new_surfaces.surfaces;
+    }
+    
+    return true;
+}
+
+class InfillCombinerJob : public ThreadPoolJob
+{
+    public:
+    const std::vector<InfillCombiner*> &combiners;
+    std::vector<char> combined;     // one flag per combiner, each written by its own task
+    InfillCombinerJob(const std::vector<InfillCombiner*> &_combiners)
+        : combiners(_combiners), combined(_combiners.size(), 0) {};
+    void run(size_t task) { this->combined[task] = this->combiners[task]->combine() ? 1 : 0; };
+};
+
+size_t
+combine_infill(const std::vector<InfillCombiner*> &combiners, ThreadPool* pool)
+{
+    InfillCombinerJob job(combiners);
+    pool->run(&job, combiners.size());
+    
+    size_t count = 0;
+    for (std::vector<char>::const_iterator it = job.combined.begin(); it != job.combined.end(); ++it)
+        if (*it) ++count;
+    return count;
+}
+
+}
@@ -0,0 +1,34 @@
+#ifndef slic3r_InfillCombiner_hpp_
+#define slic3r_InfillCombiner_hpp_
+
+#include <myinit.h>
+#include <vector>
+#include "SurfaceCollection.hpp"
+#include "ThreadPool.hpp"
+
+namespace Slic3r {
+
+/* Combines the internal infill of a group of consecutive layers of a region
+   into the uppermost one (infill_every_layers). The fill surfaces are borrowed
+   from the layer regions and modified in place; groups never share a layer
+   region, so they can be combined concurrently. */
+class InfillCombiner
+{
+    public:
+    double area_threshold;              // scaled area below which combined regions are dropped
+    coordf_t clearance;                 // scaled distance between combined regions and the remaining infill
+    std::vector<SurfaceCollection*> fill_surfaces;  // bottom to top
+    std::vector<coordf_t> heights;
+
+    InfillCombiner(double _area_threshold, coordf_t _clearance)
+        : area_threshold(_area_threshold), clearance(_clearance) {};
+    void add_layer(SurfaceCollection* fill_surfaces, coordf_t height);
+    bool combine();
+};
+
+// combines several groups on the pool; returns how many were combined
+size_t combine_infill(const std::vector<InfillCombiner*> &combiners, ThreadPool* pool);
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "InfillPreparer.hpp"
+#include <stdexcept>
+
+namespace Slic3r {
+
+void
+InfillPreparer::add_region(int top_solid_layers, int bottom_solid_layers, int solid_infill_every_layers,
+    bool has_infill, double min_solid_area)
+{
+    this->regions.push_back(InfillPreparerRegion(top_solid_layers, bottom_solid_layers,
+        solid_infill_every_layers, has_infill, min_solid_area));
+}
+
+// layers of a region must be added bottom to top
+void
+InfillPreparer::add_layer(size_t region_id, LayerRegion* layerm, coord_t perimeter_flow_width,
+    coord_t infill_flow_width, coord_t solid_infill_flow_width)
+{
+    if (region_id >= this->regions.size())
+        throw std::out_of_range("no such region in the infill preparer");
+
+    InfillPreparerRegion &region = this->regions[region_id];
+    region.layers.push_back(this->layers.size());
+    region.shells.add_layer(&layerm->slices, &layerm->fill_surfaces, perimeter_flow_width, solid_infill_flow_width);
+    this->layers.push_back(InfillPreparerLayer(region_id, layerm, perimeter_flow_width, infill_flow_width));
+}
+
+void
+InfillPreparer::process_layer(size_t layer_id, int stage)
+{
+    InfillPreparerLayer &layer = this->layers[layer_id];
+    const InfillPreparerRegion &region = this->regions[layer.region_id];
+    if (stage == 0) {
+        // very narrow parts are collapsed (using the safety offset in the diff is not enough)
+        layer.layerm->detect_surfaces_type(layer.perimeter_flow_width / 10.0);
+        layer.layerm->prepare_fill_surfaces(region.top_solid, region.bottom_solid, region.has_infill,
+            region.min_solid_area);
+    } else if (stage == 1) {
+        layer.bridge_angles.clear();
+        layer.layerm->detect_bridge_angles(layer.perimeter_flow_width, layer.infill_flow_width, &layer.bridge_angles);
+    } else {
+        layer.layerm->process_external_surfaces(layer.bridge_angles, this->external_margin, region.has_infill);
+    }
+}
+
+// tasks 3*i to 3*i+2 are the stages of layer i, then one task per region for its shells
+class InfillPreparerJob : public ThreadPoolJob
+{
+    public:
+    InfillPreparer* preparer;
+    InfillPreparerJob(InfillPreparer* _preparer) : preparer(_preparer) {};
+    void run(size_t task) {
+        size_t stages = 3 * this->preparer->layers.size();
+        if (task < stages) {
+            this->preparer->process_layer(task / 3, task % 3);
+        } else {
+            this->preparer->regions[task - stages].shells.process();
+        }
+    };
+};
+
+void
+InfillPreparer::process(ThreadPool* pool)
+{
+    InfillPreparerJob job(this);
+    ThreadPoolGraph graph;
+
+    std::vector<size_t> last_stage(this->layers.size());
+    for (size_t i = 0; i < this->layers.size(); ++i) {
+        size_t node = graph.add_task(&job, 3*i);
+        for (size_t stage = 1; stage < 3; ++stage) {
+            size_t next = graph.add_task(&job, 3*i + stage);
+            graph.add_dependency(next, node);
+            node = next;
+        }
+        last_stage[i] = node;
+    }
+
+    for (size_t region_id = 0; region_id < this->regions.size(); ++region_id) {
+        size_t node = graph.add_task(&job, 3*this->layers.size() + region_id);
+        const std::vector<size_t> &layers = this->regions[region_id].layers;
+        for (std::vector<size_t>::const_iterator it = layers.begin(); it != layers.end(); ++it)
+            graph.add_dependency(node, last_stage[*it]);
+    }
+
+    pool->run(&graph);
+}
+
+}
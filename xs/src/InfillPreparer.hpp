@@ -0,0 +1,77 @@
+#ifndef slic3r_InfillPreparer_hpp_
+#define slic3r_InfillPreparer_hpp_
+
+#include <myinit.h>
+#include <vector>
+#include "HorizontalShells.hpp"
+#include "Layer.hpp"
+#include "ThreadPool.hpp"
+
+namespace Slic3r {
+
+/* A region of the object as seen by the preparer, with its settings and its
+   shell propagator. */
+class InfillPreparerRegion
+{
+    public:
+    bool top_solid;                     // top_solid_layers > 0
+    bool bottom_solid;                  // bottom_solid_layers > 0
+    bool has_infill;                    // fill_density > 0
+    double min_solid_area;              // scaled solid_infill_below_area
+    HorizontalShells shells;
+    std::vector<size_t> layers;         // items of this region, bottom to top
+
+    InfillPreparerRegion(int top_solid_layers, int bottom_solid_layers, int solid_infill_every_layers,
+        bool _has_infill, double _min_solid_area)
+        : top_solid(top_solid_layers > 0), bottom_solid(bottom_solid_layers > 0), has_infill(_has_infill),
+          min_solid_area(_min_solid_area),
+          shells(top_solid_layers, bottom_solid_layers, solid_infill_every_layers, !_has_infill) {};
+};
+
+// a layer region to be prepared, which is borrowed and modified in place
+class InfillPreparerLayer
+{
+    public:
+    size_t region_id;
+    LayerRegion* layerm;
+    coord_t perimeter_flow_width;       // scaled
+    coord_t infill_flow_width;          // scaled
+    std::vector<double> bridge_angles;  // detected by the second stage
+
+    InfillPreparerLayer(size_t _region_id, LayerRegion* _layerm, coord_t _perimeter_flow_width,
+        coord_t _infill_flow_width)
+        : region_id(_region_id), layerm(_layerm), perimeter_flow_width(_perimeter_flow_width),
+          infill_flow_width(_infill_flow_width) {};
+};
+
+/* Classifies the fill surfaces of the layer regions of an object and
+   propagates the horizontal shells, as a task graph on the pool. Each layer
+   region goes through detect_surfaces_type() and prepare_fill_surfaces(),
+   then detect_bridge_angles(), then process_external_surfaces(); these only
+   read the merged slices of the neighbouring layers, which none of them
+   writes, so a layer region depends on nothing but its own previous stage.
+   The shells of a region depend on the last stage of all its layers, and
+   start as soon as they are done, while the other regions are still going
+   through their stages. */
+class InfillPreparer
+{
+    public:
+    float external_margin;              // scaled EXTERNAL_INFILL_MARGIN
+    std::vector<InfillPreparerRegion> regions;
+    std::vector<InfillPreparerLayer> layers;
+
+    InfillPreparer(float _external_margin) : external_margin(_external_margin) {};
+    void add_region(int top_solid_layers, int bottom_solid_layers, int solid_infill_every_layers,
+        bool has_infill, double min_solid_area);
+    void add_layer(size_t region_id, LayerRegion* layerm, coord_t perimeter_flow_width,
+        coord_t infill_flow_width, coord_t solid_infill_flow_width);
+    void process(ThreadPool* pool);
+
+    private:
+    friend class InfillPreparerJob;
+    void process_layer(size_t layer_id, int stage);
+};
+
+}
+
+#endif
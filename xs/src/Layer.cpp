@@ -0,0 +1,251 @@
+#include "Layer.hpp"
+#include "BridgeDetector.hpp"
+#include "ClipperUtils.hpp"
+
+namespace Slic3r {
+
+// entities are owned by their collection, including nested collections
+static void
+delete_entities(ExtrusionEntityCollection* collection)
+{
+    for (ExtrusionEntitiesPtr::iterator it = collection->entities.begin(); it != collection->entities.end(); ++it) {
+        if (ExtrusionEntityCollection* child = dynamic_cast<ExtrusionEntityCollection*>(*it))
+            delete_entities(child);
+        delete *it;
+    }
+    collection->entities.clear();
+}
+
+LayerRegion::~LayerRegion()
+{
+    delete_entities(&this->thin_fills);
+    delete_entities(&this->perimeters);
+    delete_entities(&this->fills);
+}
+
+void
+LayerRegion::backup_slices()
+{
+    this->raw_slices = this->slices;
+}
+
+// detect_surfaces_type() splits the slices by type, collapsing the narrowest
+// parts, so merging them back wouldn't give the original geometry
+void
+LayerRegion::restore_slices()
+{
+    this->slices = this->raw_slices;
+}
+
+void
+LayerRegion::detect_surfaces_type(double collapse_offset)
+{
+    // comparison happens against the *full* slices (considering all regions)
+    const Layer* upper_layer = this->layer->upper_layer;
+    const Layer* lower_layer = this->layer->lower_layer;
+    this->slices.detect_type(
+        upper_layer != NULL ? &upper_layer->slices : NULL,
+        lower_layer != NULL ? &lower_layer->slices : NULL,
+        collapse_offset
+    );
+    
+    // clip surfaces to the fill boundaries
+    const Polygons fill_boundaries = this->fill_surfaces;
+    this->fill_surfaces.surfaces.clear();
+    for (Surfaces::const_iterator surface = this->slices.surfaces.begin(); surface != this->slices.surfaces.end(); ++surface) {
+        ExPolygons expp;
+        intersection((Polygons)surface->expolygon, fill_boundaries, expp);
+        this->fill_surfaces.append(expp, surface->surface_type);
+    }
+}
+
+// decide what surfaces are to be filled
+void
+LayerRegion::prepare_fill_surfaces(bool top_solid, bool bottom_solid, bool has_infill, double min_solid_area)
+{
+    // if no solid layers are requested, turn top/bottom surfaces to internal
+    for (Surfaces::iterator surface = this->fill_surfaces.surfaces.begin(); surface != this->fill_surfaces.surfaces.end(); ++surface) {
+        if ((surface->surface_type == stTop && !top_solid) || (surface->surface_type == stBottom && !bottom_solid))
+            surface->surface_type = stInternal;
+    }
+    
+    // turn too small internal regions into solid regions according to the user setting
+    if (has_infill) {
+        for (Surfaces::iterator surface = this->fill_surfaces.surfaces.begin(); surface != this->fill_surfaces.surfaces.end(); ++surface) {
+            if (surface->surface_type == stInternal && surface->area() <= min_solid_area)
+                surface->surface_type = stInternalSolid;
+        }
+    }
+}
+
+/* One angle (in radians) for each bottom surface, in the order of
+   fill_surfaces, or -1 where none was found; none at all on the first layer.
+   Bridge directions are detected before merging grown surfaces, otherwise
+   adjacent bridges would get merged into a single one while they need
+   different directions; also, the original expolygon is supplied instead of
+   the grown one, because in case of very thin (but still working) anchors,
+   the grown expolygon would go beyond them. */
+void
+LayerRegion::detect_bridge_angles(coord_t perimeter_flow_width, coord_t infill_flow_width,
+    std::vector<double>* angles) const
+{
+    const Layer* lower_layer = this->layer->lower_layer;
+    if (lower_layer == NULL) return;
+    
+    for (Surfaces::const_iterator surface = this->fill_surfaces.surfaces.begin(); surface != this->fill_surfaces.surfaces.end(); ++surface) {
+        if (surface->surface_type != stBottom) continue;
+        BridgeDetector bd(surface->expolygon, lower_layer->slices, perimeter_flow_width, infill_flow_width);
+        angles->push_back(bd.detect_angle() ? bd.angle : -1);
+    }
+}
+
+// same as Slic3r::Geometry::rad2deg_dir()
+static double
+rad2deg_dir(double rad)
+{
+    rad = (rad < PI) ? (-rad + PI/2) : (rad + PI/2);
+    if (rad < 0) rad += PI;
+    return rad / PI * 180;
+}
+
+/* Grows the top and bottom surfaces by the given margin over the fill
+   boundaries and subtracts them from the other surfaces. bridge_angles are
+   the ones returned by detect_bridge_angles(); bottom surfaces keep their
+   angle where none was found. */
+void
+LayerRegion::process_external_surfaces(const std::vector<double> &bridge_angles, float margin, bool has_infill)
+{
+    const Surfaces &surfaces = this->fill_surfaces.surfaces;
+    
+    SurfaceCollection bottom;
+    std::vector<double>::const_iterator angle = bridge_angles.begin();
+    for (Surfaces::const_iterator surface = surfaces.begin(); surface != surfaces.end(); ++surface) {
+        if (surface->surface_type != stBottom) continue;
+        ExPolygons grown;
+        offset_ex((Polygons)surface->expolygon, grown, +margin);
+    
+        double bridge_angle = surface->bridge_angle;
+        if (angle != bridge_angles.end()) {
+            if (*angle >= 0) bridge_angle = rad2deg_dir(*angle);
+            ++angle;
+        }
+        for (ExPolygons::const_iterator expolygon = grown.begin(); expolygon != grown.end(); ++expolygon) {
+            Surface s = *surface;
+            s.expolygon = *expolygon;
+            s.bridge_angle = bridge_angle;
+            bottom.surfaces.push_back(s);
+        }
+    }
+    const Polygons bottom_p = bottom;
+    
+    // give priority to bottom surfaces
+    SurfaceCollection external;
+    for (Surfaces::const_iterator surface = surfaces.begin(); surface != surfaces.end(); ++surface) {
+        if (surface->surface_type != stTop) continue;
+        Polygons grown;
+        offset((Polygons)surface->expolygon, grown, +margin);
+        ExPolygons expp;
+        diff(grown, bottom_p, expp);
+        for (ExPolygons::const_iterator expolygon = expp.begin(); expolygon != expp.end(); ++expolygon) {
+            Surface s = *surface;
+            s.expolygon = *expolygon;
+            external.surfaces.push_back(s);
+        }
+    }
+    external.surfaces.insert(external.surfaces.end(), bottom.surfaces.begin(), bottom.surfaces.end());
+    
+    // if we're slicing with no infill, we can't extend external surfaces
+    // over non-existent infill
+    Polygons fill_boundaries;
+    for (Surfaces::const_iterator surface = surfaces.begin(); surface != surfaces.end(); ++surface) {
+        if (!has_infill && surface->surface_type == stInternal) continue;
+        const Polygons surface_p = surface->expolygon;
+        fill_boundaries.insert(fill_boundaries.end(), surface_p.begin(), surface_p.end());
+    }
+    
+    // intersect the grown surfaces with the actual fill boundaries
+    SurfaceCollection new_surfaces;
+    std::vector<SurfacesPtr> groups;
+    external.group(&groups);
+    for (std::vector<SurfacesPtr>::const_iterator group = groups.begin(); group != groups.end(); ++group) {
+        Polygons group_p;
+        for (SurfacesPtr::const_iterator s = group->begin(); s != group->end(); ++s) {
+            const Polygons s_p = (*s)->expolygon;
+            group_p.insert(group_p.end(), s_p.begin(), s_p.end());
+        }
+        // safety offset to ensure adjacent expolygons are unified
+        ExPolygons expp;
+        intersection(group_p, fill_boundaries, expp, true);
+        for (ExPolygons::const_iterator expolygon = expp.begin(); expolygon != expp.end(); ++expolygon) {
+            Surface s = *group->front();
+            s.expolygon = *expolygon;
+            new_surfaces.surfaces.push_back(s);
+        }
+    }
+    
+    // subtract the new top surfaces from the other non-top surfaces and re-add them
+    SurfaceCollection other;
+    for (Surfaces::const_iterator surface = surfaces.begin(); surface != surfaces.end(); ++surface) {
+        if (surface->surface_type != stTop && surface->surface_type != stBottom)
+            other.surfaces.push_back(*surface);
+    }
+    groups.clear();
+    other.group(&groups);
+    for (std::vector<SurfacesPtr>::const_iterator group = groups.begin(); group != groups.end(); ++group) {
+        Polygons group_p;
+        for (SurfacesPtr::const_iterator s = group->begin(); s != group->end(); ++s) {
+            const Polygons s_p = (*s)->expolygon;
+            group_p.insert(group_p.end(), s_p.begin(), s_p.end());
+        }
+        const Polygons new_p = new_surfaces;
+        ExPolygons expp;
+        diff(group_p, new_p, expp);
+        for (ExPolygons::const_iterator expolygon = expp.begin(); expolygon != expp.end(); ++expolygon) {
+            Surface s = *group->front();
+            s.expolygon = *expolygon;
+            new_surfaces.surfaces.push_back(s);
+        }
+    }
+    
+    this->fill_surfaces.surfaces = new_surfaces.surfaces;
+}
+
+Layer::Layer(int id, PrintObject* object, coordf_t height, coordf_t print_z, coordf_t slice_z)
+    : id(id), object(object), upper_layer(NULL), lower_layer(NULL),
+      slice_z(slice_z), print_z(print_z), height(height)
+{}
+
+Layer::~Layer()
+{
+    for (LayerRegionPtrs::iterator it = this->regions.begin(); it != this->regions.end(); ++it)
+        delete *it;
+}
+
+LayerRegion*
+Layer::add_region()
+{
+    LayerRegion* layerm = new LayerRegion(this);
+    this->regions.push_back(layerm);
+    return layerm;
+}
+
+// merge all regions' slices to get islands
+void
+Layer::make_slices()
+{
+    Polygons slices_p;
+    for (LayerRegionPtrs::const_iterator layerm = this->regions.begin(); layerm != this->regions.end(); ++layerm) {
+        const Polygons region_p = (*layerm)->slices;
+        slices_p.insert(slices_p.end(), region_p.begin(), region_p.end());
+    }
+    this->slices.expolygons.clear();
+    union_(slices_p, this->slices.expolygons);
+}
+
+SupportLayer::~SupportLayer()
+{
+    delete_entities(&this->support_fills);
+    delete_entities(&this->support_interface_fills);
+}
+
+}
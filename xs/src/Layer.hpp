@@ -2,12 +2,112 @@
 #define slic3r_Layer_hpp_
 
 #include <myinit.h>
+#include "ExPolygonCollection.hpp"
+#include "ExtrusionEntityCollection.hpp"
+#include "SurfaceCollection.hpp"
+#include <map>
+#include <vector>
 
 namespace Slic3r {
 
 typedef std::pair<coordf_t,coordf_t> t_layer_height_range;
 typedef std::map<t_layer_height_range,coordf_t> t_layer_height_ranges;
 
+class Layer;
+class PrintObject;
+
+class LayerRegion
+{
+    friend class Layer;
+    
+    public:
+    Layer* layer;
+    
+    // collection of surfaces generated by slicing the original geometry
+    // divided by type top/bottom/internal
+    SurfaceCollection slices;
+    
+    // copy of the untyped slices as generated by slicing, so that the steps
+    // following it can be repeated without reslicing
+    SurfaceCollection raw_slices;
+    
+    // collection of extrusion paths/loops filling gaps
+    ExtrusionEntityCollection thin_fills;
+    
+    // collection of surfaces for infill generation
+    SurfaceCollection fill_surfaces;
+    
+    // ordered collection of extrusion paths/loops to build all perimeters
+    ExtrusionEntityCollection perimeters;
+    
+    // ordered collection of extrusion paths to fill surfaces
+    ExtrusionEntityCollection fills;
+    
+    void backup_slices();
+    void restore_slices();
+    void detect_surfaces_type(double collapse_offset);
+    void prepare_fill_surfaces(bool top_solid, bool bottom_solid, bool has_infill, double min_solid_area);
+    void detect_bridge_angles(coord_t perimeter_flow_width, coord_t infill_flow_width,
+        std::vector<double>* angles) const;
+    void process_external_surfaces(const std::vector<double> &bridge_angles, float margin, bool has_infill);
+    
+    private:
+    LayerRegion(Layer* layer) : layer(layer) {};
+    ~LayerRegion();
+};
+
+typedef std::vector<LayerRegion*> LayerRegionPtrs;
+
+/* Layers are owned by their PrintObject, which creates them, keeps the
+   upper_layer/lower_layer links in sync and frees them; Perl only ever
+   holds non-owning references to them. */
+class Layer
+{
+    friend class PrintObject;
+    
+    public:
+    int id;                 // sequential number of layer, 0-based
+    PrintObject* object;
+    Layer* upper_layer;
+    Layer* lower_layer;
+    LayerRegionPtrs regions;
+    coordf_t slice_z;       // Z used for slicing in unscaled coordinates
+    coordf_t print_z;       // Z used for printing in unscaled coordinates
+    coordf_t height;        // layer height in unscaled coordinates
+    
+    // collection of expolygons generated by slicing the original geometry;
+    // also known as 'islands' (all regions and surface types are merged here)
+    ExPolygonCollection slices;
+    
+    LayerRegion* add_region();
+    void make_slices();
+    
+    protected:
+    Layer(int id, PrintObject* object, coordf_t height, coordf_t print_z, coordf_t slice_z);
+    virtual ~Layer();
+};
+
+typedef std::vector<Layer*> LayerPtrs;
+
+class SupportLayer : public Layer
+{
+    friend class PrintObject;
+    
+    public:
+    ExPolygonCollection support_islands;
+    
+    // ordered collection of extrusion paths to fill surfaces for support material
+    ExtrusionEntityCollection support_fills;
+    ExtrusionEntityCollection support_interface_fills;
+    
+    protected:
+    SupportLayer(int id, PrintObject* object, coordf_t height, coordf_t print_z, coordf_t slice_z)
+        : Layer(id, object, height, print_z, slice_z) {};
+    virtual ~SupportLayer();
+};
+
+typedef std::vector<SupportLayer*> SupportLayerPtrs;
+
 }
 
 #endif
@@ -27,6 +27,8 @@ class Line
     Point* point_at(double distance) const;
     bool coincides_with(const Line* line) const;
     double distance_to(const Point* point) const;
+    double atan2_() const;
+    double direction() const;
     
     #ifdef SLIC3RXS
     void from_SV(SV* line_sv);
@@ -38,6 +38,11 @@ class Polygon : public MultiPoint {
     #endif
 };
 
+#ifdef SLIC3RXS
+// accepts Slic3r::Polygon::Collection and Slic3r::ExPolygon::Collection
+bool from_SV_collection(SV* sv, Polygons* polygons);
+#endif
+
 }
 
 #endif
@@ -0,0 +1,34 @@
+#include "PolygonCollection.hpp"
+#include "ExPolygonCollection.hpp"
+
+namespace Slic3r {
+
+// appends counter-clockwise polygons to contours and the other ones to holes
+void
+PolygonCollection::split_by_orientation(PolygonCollection* contours, PolygonCollection* holes) const
+{
+    for (Polygons::const_iterator it = this->polygons.begin(); it != this->polygons.end(); ++it) {
+        if (it->is_counter_clockwise()) {
+            contours->polygons.push_back(*it);
+        } else {
+            holes->polygons.push_back(*it);
+        }
+    }
+}
+
+#ifdef SLIC3RXS
+bool
+from_SV_collection(SV* sv, Polygons* polygons)
+{
+    if (sv_isa(sv, "Slic3r::Polygon::Collection")) {
+        *polygons = ((PolygonCollection*)SvIV((SV*)SvRV(sv)))->polygons;
+    } else if (sv_isa(sv, "Slic3r::ExPolygon::Collection") || sv_isa(sv, "Slic3r::ExPolygon::Collection::Ref")) {
+        *polygons = *(ExPolygonCollection*)SvIV((SV*)SvRV(sv));
+    } else {
+        return false;
+    }
+    return true;
+}
+#endif
+
+}
@@ -0,0 +1,23 @@
+#ifndef slic3r_PolygonCollection_hpp_
+#define slic3r_PolygonCollection_hpp_
+
+#include <myinit.h>
+#include "Polygon.hpp"
+
+namespace Slic3r {
+
+/* Polygons owned by a single Perl handle. Chains of Clipper operations can
+   pass them along without converting them to Perl values; Perl only gets a
+   view of each polygon when it actually iterates the collection. */
+class PolygonCollection
+{
+    public:
+    Polygons polygons;
+    PolygonCollection() {};
+    PolygonCollection(const Polygons &_polygons) : polygons(_polygons) {};
+    void split_by_orientation(PolygonCollection* contours, PolygonCollection* holes) const;
+};
+
+}
+
+#endif
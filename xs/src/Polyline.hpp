@@ -26,6 +26,11 @@ class Polyline : public MultiPoint {
     #endif
 };
 
+#ifdef SLIC3RXS
+// accepts Slic3r::Polyline::Collection
+bool from_SV_collection(SV* sv, Polylines* polylines);
+#endif
+
 }
 
 #endif
@@ -53,4 +53,14 @@ PolylineCollection::leftmost_point() const
     return new Point (*p);
 }
 
+#ifdef SLIC3RXS
+bool
+from_SV_collection(SV* sv, Polylines* polylines)
+{
+    if (!sv_isa(sv, "Slic3r::Polyline::Collection")) return false;
+    *polylines = ((PolylineCollection*)SvIV((SV*)SvRV(sv)))->polylines;
+    return true;
+}
+#endif
+
 }
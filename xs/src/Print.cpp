@@ -1,4 +1,5 @@
 #include "Print.hpp"
+#include <algorithm>
 
 namespace Slic3r {
 
@@ -40,4 +41,128 @@ PrintState::invalidate_all()
     this->_done.clear();
 }
 
+PrintObject::~PrintObject()
+{
+    this->clear_layers();
+    this->clear_support_layers();
+}
+
+size_t
+PrintObject::layer_count() const
+{
+    return this->layers.size();
+}
+
+Layer*
+PrintObject::get_layer(int idx)
+{
+    return this->layers.at(idx);
+}
+
+/* layers are appended bottom to top, so the new layer is linked
+   above the current topmost one */
+Layer*
+PrintObject::add_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z)
+{
+    Layer* layer = new Layer(id, this, height, print_z, slice_z);
+    if (!this->layers.empty()) {
+        layer->lower_layer = this->layers.back();
+        this->layers.back()->upper_layer = layer;
+    }
+    this->layers.push_back(layer);
+    return layer;
+}
+
+void
+PrintObject::delete_layer(int idx)
+{
+    Layer* layer = this->layers.at(idx);
+    if (layer->lower_layer != NULL) layer->lower_layer->upper_layer = layer->upper_layer;
+    if (layer->upper_layer != NULL) layer->upper_layer->lower_layer = layer->lower_layer;
+    this->layers.erase(this->layers.begin() + idx);
+    delete layer;
+}
+
+void
+PrintObject::clear_layers()
+{
+    for (LayerPtrs::iterator it = this->layers.begin(); it != this->layers.end(); ++it)
+        delete *it;
+    this->layers.clear();
+}
+
+size_t
+PrintObject::support_layer_count() const
+{
+    return this->support_layers.size();
+}
+
+SupportLayer*
+PrintObject::get_support_layer(int idx)
+{
+    return this->support_layers.at(idx);
+}
+
+SupportLayer*
+PrintObject::add_support_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z)
+{
+    SupportLayer* layer = new SupportLayer(id, this, height, print_z, slice_z);
+    if (!this->support_layers.empty()) {
+        layer->lower_layer = this->support_layers.back();
+        this->support_layers.back()->upper_layer = layer;
+    }
+    this->support_layers.push_back(layer);
+    return layer;
+}
+
+void
+PrintObject::clear_support_layers()
+{
+    for (SupportLayerPtrs::iterator it = this->support_layers.begin(); it != this->support_layers.end(); ++it)
+        delete *it;
+    this->support_layers.clear();
+}
+
+class MakeSlicesJob : public ThreadPoolJob
+{
+    public:
+    LayerPtrs &layers;
+    MakeSlicesJob(LayerPtrs &_layers) : layers(_layers) {};
+    void run(size_t task) { this->layers[task]->make_slices(); };
+};
+
+// each layer only merges the slices of its own regions
+void
+PrintObject::make_slices(ThreadPool* pool)
+{
+    MakeSlicesJob job(this->layers);
+    pool->run(&job, this->layers.size());
+}
+
+class DetectSurfacesTypeJob : public ThreadPoolJob
+{
+    public:
+    LayerPtrs &layers;
+    size_t region_id;
+    const std::vector<double> &collapse_offsets;
+    DetectSurfacesTypeJob(LayerPtrs &_layers, size_t _region_id, const std::vector<double> &_collapse_offsets)
+        : layers(_layers), region_id(_region_id), collapse_offsets(_collapse_offsets) {};
+    void run(size_t task) {
+        Layer* layer = this->layers[task];
+        if (this->region_id < layer->regions.size())
+            layer->regions[this->region_id]->detect_surfaces_type(this->collapse_offsets[task]);
+    };
+};
+
+/* Each layer only reads the full slices of its neighbours (which are left
+   untouched) and only writes the surfaces of its own region, so layers are
+   processed in parallel. The collapse offset depends on the perimeter flow,
+   which varies with the layer height, so one is supplied for each layer. */
+void
+PrintObject::detect_surfaces_type(size_t region_id, const std::vector<double> &collapse_offsets, ThreadPool* pool)
+{
+    DetectSurfacesTypeJob job(this->layers, region_id, collapse_offsets);
+    pool->run(&job, std::min(this->layers.size(), collapse_offsets.size()));
+}
+
 }
@@ -1,7 +1,11 @@
 #ifndef slic3r_Print_hpp_
 #define slic3r_Print_hpp_
 
+#include <myinit.h>
 #include <set>
+#include <vector>
+#include "Layer.hpp"
+#include "ThreadPool.hpp"
 
 namespace Slic3r {
 
@@ -25,6 +29,29 @@ class PrintState
     void invalidate_all();
 };
 
+/* Native storage for the layers of an object: the Perl Print::Object
+   creates and removes layers only through this class, so that C++ kernels
+   can walk the whole layer stack without going through Perl. */
+class PrintObject
+{
+    public:
+    LayerPtrs layers;
+    SupportLayerPtrs support_layers;
+    
+    ~PrintObject();
+    size_t layer_count() const;
+    Layer* get_layer(int idx);
+    Layer* add_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z);
+    void delete_layer(int idx);
+    void clear_layers();
+    size_t support_layer_count() const;
+    SupportLayer* get_support_layer(int idx);
+    SupportLayer* add_support_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z);
+    void clear_support_layers();
+    void make_slices(ThreadPool* pool);
+    void detect_surfaces_type(size_t region_id, const std::vector<double> &collapse_offsets, ThreadPool* pool);
+};
+
 }
 
 #endif
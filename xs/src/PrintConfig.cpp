@@ -3,5 +3,6 @@
 namespace Slic3r {
 
 t_optiondef_map PrintConfigDef::def = PrintConfigDef::build_def();
+ConfigOptionIndex PrintConfigDef::index = PrintConfigDef::build_index();
 
 }
@@ -50,10 +50,158 @@ template<> inline t_config_enum_values ConfigOptionEnum<SupportMaterialPattern>:
     return keys_map;
 }
 
+/* The options held by each StaticConfig class. These lists generate the
+   PrintConfigOptionID enum, the key index shared by all these classes and
+   their option_by_id() switches. */
+#define PRINT_OBJECT_CONFIG_OPTIONS(OPT)     \
+    OPT(extrusion_width)                     \
+    OPT(first_layer_height)                  \
+    OPT(infill_only_where_needed)            \
+    OPT(layer_height)                        \
+    OPT(raft_layers)                         \
+    OPT(support_material)                    \
+    OPT(support_material_angle)              \
+    OPT(support_material_enforce_layers)     \
+    OPT(support_material_extruder)           \
+    OPT(support_material_extrusion_width)    \
+    OPT(support_material_interface_extruder) \
+    OPT(support_material_interface_layers)   \
+    OPT(support_material_interface_spacing)  \
+    OPT(support_material_pattern)            \
+    OPT(support_material_spacing)            \
+    OPT(support_material_speed)              \
+    OPT(support_material_threshold)
+
+#define PRINT_REGION_CONFIG_OPTIONS(OPT) \
+    OPT(bottom_solid_layers)             \
+    OPT(extra_perimeters)                \
+    OPT(fill_angle)                      \
+    OPT(fill_density)                    \
+    OPT(fill_pattern)                    \
+    OPT(infill_extruder)                 \
+    OPT(infill_extrusion_width)          \
+    OPT(infill_every_layers)             \
+    OPT(perimeter_extruder)              \
+    OPT(perimeter_extrusion_width)       \
+    OPT(perimeters)                      \
+    OPT(solid_fill_pattern)              \
+    OPT(solid_infill_below_area)         \
+    OPT(solid_infill_extrusion_width)    \
+    OPT(solid_infill_every_layers)       \
+    OPT(thin_walls)                      \
+    OPT(top_infill_extrusion_width)      \
+    OPT(top_solid_layers)
+
+#define PRINT_CONFIG_OPTIONS(OPT)              \
+    OPT(avoid_crossing_perimeters)             \
+    OPT(bed_size)                              \
+    OPT(bed_temperature)                       \
+    OPT(bridge_acceleration)                   \
+    OPT(bridge_fan_speed)                      \
+    OPT(bridge_flow_ratio)                     \
+    OPT(bridge_speed)                          \
+    OPT(brim_width)                            \
+    OPT(complete_objects)                      \
+    OPT(cooling)                               \
+    OPT(default_acceleration)                  \
+    OPT(disable_fan_first_layers)              \
+    OPT(duplicate_distance)                    \
+    OPT(end_gcode)                             \
+    OPT(external_perimeter_speed)              \
+    OPT(external_perimeters_first)             \
+    OPT(extruder_clearance_height)             \
+    OPT(extruder_clearance_radius)             \
+    OPT(extruder_offset)                       \
+    OPT(extrusion_axis)                        \
+    OPT(extrusion_multiplier)                  \
+    OPT(fan_always_on)                         \
+    OPT(fan_below_layer_time)                  \
+    OPT(filament_diameter)                     \
+    OPT(first_layer_acceleration)              \
+    OPT(first_layer_bed_temperature)           \
+    OPT(first_layer_extrusion_width)           \
+    OPT(first_layer_speed)                     \
+    OPT(first_layer_temperature)               \
+    OPT(g0)                                    \
+    OPT(gap_fill_speed)                        \
+    OPT(gcode_arcs)                            \
+    OPT(gcode_comments)                        \
+    OPT(gcode_flavor)                          \
+    OPT(infill_acceleration)                   \
+    OPT(infill_first)                          \
+    OPT(infill_speed)                          \
+    OPT(layer_gcode)                           \
+    OPT(max_fan_speed)                         \
+    OPT(min_fan_speed)                         \
+    OPT(min_print_speed)                       \
+    OPT(min_skirt_length)                      \
+    OPT(notes)                                 \
+    OPT(nozzle_diameter)                       \
+    OPT(only_retract_when_crossing_perimeters) \
+    OPT(ooze_prevention)                       \
+    OPT(output_filename_format)                \
+    OPT(overhangs)                             \
+    OPT(perimeter_acceleration)                \
+    OPT(perimeter_speed)                       \
+    OPT(post_process)                          \
+    OPT(print_center)                          \
+    OPT(randomize_start)                       \
+    OPT(resolution)                            \
+    OPT(retract_before_travel)                 \
+    OPT(retract_layer_change)                  \
+    OPT(retract_length)                        \
+    OPT(retract_length_toolchange)             \
+    OPT(retract_lift)                          \
+    OPT(retract_restart_extra)                 \
+    OPT(retract_restart_extra_toolchange)      \
+    OPT(retract_speed)                         \
+    OPT(skirt_distance)                        \
+    OPT(skirt_height)                          \
+    OPT(skirts)                                \
+    OPT(slowdown_below_layer_time)             \
+    OPT(small_perimeter_speed)                 \
+    OPT(solid_infill_speed)                    \
+    OPT(spiral_vase)                           \
+    OPT(standby_temperature_delta)             \
+    OPT(start_gcode)                           \
+    OPT(start_perimeters_at_concave_points)    \
+    OPT(start_perimeters_at_non_overhang)      \
+    OPT(temperature)                           \
+    OPT(threads)                               \
+    OPT(toolchange_gcode)                      \
+    OPT(top_solid_infill_speed)                \
+    OPT(travel_speed)                          \
+    OPT(use_firmware_retraction)               \
+    OPT(use_relative_e_distances)              \
+    OPT(vibration_limit)                       \
+    OPT(wipe)                                  \
+    OPT(z_offset)
+
+#define PRINT_CONFIG_OPTION_ID(KEY)     opt_##KEY,
+#define PRINT_CONFIG_OPTION_KEY(KEY)    #KEY,
+#define PRINT_CONFIG_OPTION_CASE(KEY)   case opt_##KEY: return &this->KEY;
+
+enum PrintConfigOptionID {
+    PRINT_OBJECT_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_ID)
+    PRINT_REGION_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_ID)
+    PRINT_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_ID)
+    opt_count
+};
+
 class PrintConfigDef
 {
     public:
     static t_optiondef_map def;
+    static ConfigOptionIndex index;
+    
+    static ConfigOptionIndex build_index () {
+        static const char* keys[] = {
+            PRINT_OBJECT_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_KEY)
+            PRINT_REGION_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_KEY)
+            PRINT_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_KEY)
+        };
+        return ConfigOptionIndex(keys, opt_count, PrintConfigDef::def);
+    };
     
     static t_optiondef_map build_def () {
         t_optiondef_map Options;
@@ -910,6 +1058,7 @@ class PrintObjectConfig : public virtual StaticConfig
     
     PrintObjectConfig() {
         this->def = &PrintConfigDef::def;
+        this->index = &PrintConfigDef::index;
         
         this->extrusion_width.value                              = 0;
         this->extrusion_width.percent                            = false;
@@ -933,25 +1082,10 @@ class PrintObjectConfig : public virtual StaticConfig
         this->support_material_threshold.value                   = 0;
     };
     
-    ConfigOption* option(const t_config_option_key opt_key, bool create = false) {
-        if (opt_key == "extrusion_width")                            return &this->extrusion_width;
-        if (opt_key == "first_layer_height")                         return &this->first_layer_height;
-        if (opt_key == "infill_only_where_needed")                   return &this->infill_only_where_needed;
-        if (opt_key == "layer_height")                               return &this->layer_height;
-        if (opt_key == "raft_layers")                                return &this->raft_layers;
-        if (opt_key == "support_material")                           return &this->support_material;
-        if (opt_key == "support_material_angle")                     return &this->support_material_angle;
-        if (opt_key == "support_material_enforce_layers")            return &this->support_material_enforce_layers;
-        if (opt_key == "support_material_extruder")                  return &this->support_material_extruder;
-        if (opt_key == "support_material_extrusion_width")           return &this->support_material_extrusion_width;
-        if (opt_key == "support_material_interface_extruder")        return &this->support_material_interface_extruder;
-        if (opt_key == "support_material_interface_layers")          return &this->support_material_interface_layers;
-        if (opt_key == "support_material_interface_spacing")         return &this->support_material_interface_spacing;
-        if (opt_key == "support_material_pattern")                   return &this->support_material_pattern;
-        if (opt_key == "support_material_spacing")                   return &this->support_material_spacing;
-        if (opt_key == "support_material_speed")                     return &this->support_material_speed;
-        if (opt_key == "support_material_threshold")                 return &this->support_material_threshold;
-        
+    ConfigOption* option_by_id(int id) {
+        switch (id) {
+            PRINT_OBJECT_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_CASE)
+        }
         return NULL;
     };
 };
@@ -980,6 +1114,7 @@ class PrintRegionConfig : public virtual StaticConfig
     
     PrintRegionConfig() {
         this->def = &PrintConfigDef::def;
+        this->index = &PrintConfigDef::index;
         
         this->bottom_solid_layers.value                          = 3;
         this->extra_perimeters.value                             = true;
@@ -1005,26 +1140,10 @@ class PrintRegionConfig : public virtual StaticConfig
         this->top_solid_layers.value                             = 3;
     };
     
-    ConfigOption* option(const t_config_option_key opt_key, bool create = false) {
-        if (opt_key == "bottom_solid_layers")                        return &this->bottom_solid_layers;
-        if (opt_key == "extra_perimeters")                           return &this->extra_perimeters;
-        if (opt_key == "fill_angle")                                 return &this->fill_angle;
-        if (opt_key == "fill_density")                               return &this->fill_density;
-        if (opt_key == "fill_pattern")                               return &this->fill_pattern;
-        if (opt_key == "infill_extruder")                            return &this->infill_extruder;
-        if (opt_key == "infill_extrusion_width")                     return &this->infill_extrusion_width;
-        if (opt_key == "infill_every_layers")                        return &this->infill_every_layers;
-        if (opt_key == "perimeter_extruder")                         return &this->perimeter_extruder;
-        if (opt_key == "perimeter_extrusion_width")                  return &this->perimeter_extrusion_width;
-        if (opt_key == "perimeters")                                 return &this->perimeters;
-        if (opt_key == "solid_fill_pattern")                         return &this->solid_fill_pattern;
-        if (opt_key == "solid_infill_below_area")                    return &this->solid_infill_below_area;
-        if (opt_key == "solid_infill_extrusion_width")               return &this->solid_infill_extrusion_width;
-        if (opt_key == "solid_infill_every_layers")                  return &this->solid_infill_every_layers;
-        if (opt_key == "thin_walls")                                 return &this->thin_walls;
-        if (opt_key == "top_infill_extrusion_width")                 return &this->top_infill_extrusion_width;
-        if (opt_key == "top_solid_layers")                           return &this->top_solid_layers;
-        
+    ConfigOption* option_by_id(int id) {
+        switch (id) {
+            PRINT_REGION_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_CASE)
+        }
         return NULL;
     };
 };
@@ -1118,6 +1237,7 @@ class PrintConfig : public virtual StaticConfig
     
     PrintConfig() {
         this->def = &PrintConfigDef::def;
+        this->index = &PrintConfigDef::index;
         
         this->avoid_crossing_perimeters.value                    = false;
         this->bed_size.point                                     = Pointf(200,200);
@@ -1224,91 +1344,10 @@ class PrintConfig : public virtual StaticConfig
         this->z_offset.value                                     = 0;
     };
     
-    ConfigOption* option(const t_config_option_key opt_key, bool create = false) {
-        if (opt_key == "avoid_crossing_perimeters")                  return &this->avoid_crossing_perimeters;
-        if (opt_key == "bed_size")                                   return &this->bed_size;
-        if (opt_key == "bed_temperature")                            return &this->bed_temperature;
-        if (opt_key == "bridge_acceleration")                        return &this->bridge_acceleration;
-        if (opt_key == "bridge_fan_speed")                           return &this->bridge_fan_speed;
-        if (opt_key == "bridge_flow_ratio")                          return &this->bridge_flow_ratio;
-        if (opt_key == "bridge_speed")                               return &this->bridge_speed;
-        if (opt_key == "brim_width")                                 return &this->brim_width;
-        if (opt_key == "complete_objects")                           return &this->complete_objects;
-        if (opt_key == "cooling")                                    return &this->cooling;
-        if (opt_key == "default_acceleration")                       return &this->default_acceleration;
-        if (opt_key == "disable_fan_first_layers")                   return &this->disable_fan_first_layers;
-        if (opt_key == "duplicate_distance")                         return &this->duplicate_distance;
-        if (opt_key == "end_gcode")                                  return &this->end_gcode;
-        if (opt_key == "external_perimeter_speed")                   return &this->external_perimeter_speed;
-        if (opt_key == "external_perimeters_first")                  return &this->external_perimeters_first;
-        if (opt_key == "extruder_clearance_height")                  return &this->extruder_clearance_height;
-        if (opt_key == "extruder_clearance_radius")                  return &this->extruder_clearance_radius;
-        if (opt_key == "extruder_offset")                            return &this->extruder_offset;
-        if (opt_key == "extrusion_axis")                             return &this->extrusion_axis;
-        if (opt_key == "extrusion_multiplier")                       return &this->extrusion_multiplier;
-        if (opt_key == "fan_always_on")                              return &this->fan_always_on;
-        if (opt_key == "fan_below_layer_time")                       return &this->fan_below_layer_time;
-        if (opt_key == "filament_diameter")                          return &this->filament_diameter;
-        if (opt_key == "first_layer_acceleration")                   return &this->first_layer_acceleration;
-        if (opt_key == "first_layer_bed_temperature")                return &this->first_layer_bed_temperature;
-        if (opt_key == "first_layer_extrusion_width")                return &this->first_layer_extrusion_width;
-        if (opt_key == "first_layer_speed")                          return &this->first_layer_speed;
-        if (opt_key == "first_layer_temperature")                    return &this->first_layer_temperature;
-        if (opt_key == "g0")                                         return &this->g0;
-        if (opt_key == "gap_fill_speed")                             return &this->gap_fill_speed;
-        if (opt_key == "gcode_arcs")                                 return &this->gcode_arcs;
-        if (opt_key == "gcode_comments")                             return &this->gcode_comments;
-        if (opt_key == "gcode_flavor")                               return &this->gcode_flavor;
-        if (opt_key == "infill_acceleration")                        return &this->infill_acceleration;
-        if (opt_key == "infill_first")                               return &this->infill_first;
-        if (opt_key == "infill_speed")                               return &this->infill_speed;
-        if (opt_key == "layer_gcode")                                return &this->layer_gcode;
-        if (opt_key == "max_fan_speed")                              return &this->max_fan_speed;
-        if (opt_key == "min_fan_speed")                              return &this->min_fan_speed;
-        if (opt_key == "min_print_speed")                            return &this->min_print_speed;
-        if (opt_key == "min_skirt_length")                           return &this->min_skirt_length;
-        if (opt_key == "notes")                                      return &this->notes;
-        if (opt_key == "nozzle_diameter")                            return &this->nozzle_diameter;
-        if (opt_key == "only_retract_when_crossing_perimeters")      return &this->only_retract_when_crossing_perimeters;
-        if (opt_key == "ooze_prevention")                            return &this->ooze_prevention;
-        if (opt_key == "output_filename_format")                     return &this->output_filename_format;
-        if (opt_key == "overhangs")                                  return &this->overhangs;
-        if (opt_key == "perimeter_acceleration")                     return &this->perimeter_acceleration;
-        if (opt_key == "perimeter_speed")                            return &this->perimeter_speed;
-        if (opt_key == "post_process")                               return &this->post_process;
-        if (opt_key == "print_center")                               return &this->print_center;
-        if (opt_key == "randomize_start")                            return &this->randomize_start;
-        if (opt_key == "resolution")                                 return &this->resolution;
-        if (opt_key == "retract_before_travel")                      return &this->retract_before_travel;
-        if (opt_key == "retract_layer_change")                       return &this->retract_layer_change;
-        if (opt_key == "retract_length")                             return &this->retract_length;
-        if (opt_key == "retract_length_toolchange")                  return &this->retract_length_toolchange;
-        if (opt_key == "retract_lift")                               return &this->retract_lift;
-        if (opt_key == "retract_restart_extra")                      return &this->retract_restart_extra;
-        if (opt_key == "retract_restart_extra_toolchange")           return &this->retract_restart_extra_toolchange;
-        if (opt_key == "retract_speed")                              return &this->retract_speed;
-        if (opt_key == "skirt_distance")                             return &this->skirt_distance;
-        if (opt_key == "skirt_height")                               return &this->skirt_height;
-        if (opt_key == "skirts")                                     return &this->skirts;
-        if (opt_key == "slowdown_below_layer_time")                  return &this->slowdown_below_layer_time;
-        if (opt_key == "small_perimeter_speed")                      return &this->small_perimeter_speed;
-        if (opt_key == "solid_infill_speed")                         return &this->solid_infill_speed;
-        if (opt_key == "spiral_vase")                                return &this->spiral_vase;
-        if (opt_key == "standby_temperature_delta")                  return &this->standby_temperature_delta;
-        if (opt_key == "start_gcode")                                return &this->start_gcode;
-        if (opt_key == "start_perimeters_at_concave_points")         return &this->start_perimeters_at_concave_points;
-        if (opt_key == "start_perimeters_at_non_overhang")           return &this->start_perimeters_at_non_overhang;
-        if (opt_key == "temperature")                                return &this->temperature;
-        if (opt_key == "threads")                                    return &this->threads;
-        if (opt_key == "toolchange_gcode")                           return &this->toolchange_gcode;
-        if (opt_key == "top_solid_infill_speed")                     return &this->top_solid_infill_speed;
-        if (opt_key == "travel_speed")                               return &this->travel_speed;
-        if (opt_key == "use_firmware_retraction")                    return &this->use_firmware_retraction;
-        if (opt_key == "use_relative_e_distances")                   return &this->use_relative_e_distances;
-        if (opt_key == "vibration_limit")                            return &this->vibration_limit;
-        if (opt_key == "wipe")                                       return &this->wipe;
-        if (opt_key == "z_offset")                                   return &this->z_offset;
-        
+    ConfigOption* option_by_id(int id) {
+        switch (id) {
+            PRINT_CONFIG_OPTIONS(PRINT_CONFIG_OPTION_CASE)
+        }
         return NULL;
     };
     
@@ -1331,11 +1370,12 @@ class DynamicPrintConfig : public DynamicConfig
 };
 
 class FullPrintConfig : public PrintObjectConfig, public PrintRegionConfig, public PrintConfig {
-    ConfigOption* option(const t_config_option_key opt_key, bool create = false) {
+    public:
+    ConfigOption* option_by_id(int id) {
         ConfigOption* opt;
-        if ((opt = PrintObjectConfig::option(opt_key, create)) != NULL) return opt;
-        if ((opt = PrintRegionConfig::option(opt_key, create)) != NULL) return opt;
-        if ((opt = PrintConfig::option(opt_key, create)) != NULL) return opt;
+        if ((opt = PrintObjectConfig::option_by_id(id)) != NULL) return opt;
+        if ((opt = PrintRegionConfig::option_by_id(id)) != NULL) return opt;
+        if ((opt = PrintConfig::option_by_id(id)) != NULL) return opt;
         return NULL;
     };
 };
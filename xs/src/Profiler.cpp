@@ -0,0 +1,87 @@
+#include "Profiler.hpp"
+#include "Layer.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+namespace Slic3r {
+
+ProfilerSample::ProfilerSample()
+    : wall_time(0), cpu_time(0), peak_rss(0)
+{
+    #ifdef _WIN32
+    FILETIME now, creation, exit, kernel, user;
+    GetSystemTimeAsFileTime(&now);
+    this->wall_time = (((unsigned long long)now.dwHighDateTime << 32) | now.dwLowDateTime) / 1e7;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        this->cpu_time = ((((unsigned long long)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime)
+            + (((unsigned long long)user.dwHighDateTime << 32) | user.dwLowDateTime)) / 1e7;
+    }
+    #else
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    this->wall_time = now.tv_sec + now.tv_usec / 1e6;
+    
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        this->cpu_time = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+            + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+        #ifdef __APPLE__
+        this->peak_rss = usage.ru_maxrss;           // bytes
+        #else
+        this->peak_rss = usage.ru_maxrss * 1024;    // kilobytes
+        #endif
+    }
+    #endif
+}
+
+void
+ProfilerCounts::add(const PrintObject &object)
+{
+    this->layers += object.layers.size() + object.support_layers.size();
+    
+    for (LayerPtrs::const_iterator layer = object.layers.begin(); layer != object.layers.end(); ++layer) {
+        for (LayerRegionPtrs::const_iterator layerm = (*layer)->regions.begin(); layerm != (*layer)->regions.end(); ++layerm) {
+            for (Surfaces::const_iterator surface = (*layerm)->slices.surfaces.begin(); surface != (*layerm)->slices.surfaces.end(); ++surface)
+                this->add(surface->expolygon);
+            for (Surfaces::const_iterator surface = (*layerm)->fill_surfaces.surfaces.begin(); surface != (*layerm)->fill_surfaces.surfaces.end(); ++surface)
+                this->add(surface->expolygon);
+            this->add((*layerm)->thin_fills);
+            this->add((*layerm)->perimeters);
+            this->add((*layerm)->fills);
+        }
+    }
+    
+    for (SupportLayerPtrs::const_iterator layer = object.support_layers.begin(); layer != object.support_layers.end(); ++layer) {
+        for (ExPolygons::const_iterator expolygon = (*layer)->support_islands.expolygons.begin(); expolygon != (*layer)->support_islands.expolygons.end(); ++expolygon)
+            this->add(*expolygon);
+        this->add((*layer)->support_fills);
+        this->add((*layer)->support_interface_fills);
+    }
+}
+
+void
+ProfilerCounts::add(const ExtrusionEntityCollection &collection)
+{
+    for (ExtrusionEntitiesPtr::const_iterator entity = collection.entities.begin(); entity != collection.entities.end(); ++entity) {
+        if (ExtrusionEntityCollection* subcollection = dynamic_cast<ExtrusionEntityCollection*>(*entity)) {
+            this->add(*subcollection);
+        } else {
+            this->paths++;
+        }
+    }
+}
+
+void
+ProfilerCounts::add(const ExPolygon &expolygon)
+{
+    this->polygons += 1 + expolygon.holes.size();
+    this->points += expolygon.contour.points.size();
+    for (Polygons::const_iterator hole = expolygon.holes.begin(); hole != expolygon.holes.end(); ++hole)
+        this->points += hole->points.size();
+}
+
+}
@@ -0,0 +1,41 @@
+#ifndef slic3r_Profiler_hpp_
+#define slic3r_Profiler_hpp_
+
+#include <myinit.h>
+#include "ExtrusionEntityCollection.hpp"
+#include "Print.hpp"
+
+namespace Slic3r {
+
+/* Resource usage of the whole process at the time of construction. All the
+   values are cumulative, so the usage of a stage is the difference between
+   the samples taken before and after it. */
+class ProfilerSample
+{
+    public:
+    double wall_time;       // seconds since an arbitrary origin
+    double cpu_time;        // user + system seconds, summed over all threads
+    size_t peak_rss;        // high-water mark of the resident set in bytes, 0 if unknown
+    
+    ProfilerSample();
+};
+
+/* Sizes of the data produced by the print steps, counted without creating
+   any Perl wrapper so that profiling large prints stays cheap. */
+class ProfilerCounts
+{
+    public:
+    size_t layers;          // layers and support layers
+    size_t polygons;        // contours and holes of the region slices, fill surfaces and support islands
+    size_t points;          // vertices of the above polygons
+    size_t paths;           // extrusion paths and loops, nested collections excluded
+    
+    ProfilerCounts() : layers(0), polygons(0), points(0), paths(0) {};
+    void add(const PrintObject &object);
+    void add(const ExtrusionEntityCollection &collection);
+    void add(const ExPolygon &expolygon);
+};
+
+}
+
+#endif
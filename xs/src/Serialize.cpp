@@ -0,0 +1,435 @@
+#include "Serialize.hpp"
+#include <cstring>
+
+namespace Slic3r {
+
+// bump this whenever the encoding of any object changes
+#define SERIALIZE_VERSION 1
+
+// extrusion collections are recursive; refuse absurd nesting in
+// untrusted data instead of running out of stack
+#define SERIALIZE_MAX_DEPTH 64
+
+enum SerializedKind {
+    skExPolygon = 1,
+    skExPolygonCollection,
+    skSurface,
+    skSurfaceCollection,
+    skExtrusionEntityCollection,
+};
+
+enum SerializedExtrusionEntity {
+    seExtrusionPath,
+    seExtrusionLoop,
+    seExtrusionEntityCollection,
+};
+
+void
+BinaryWriter::write_uint32(uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) this->data += (char)((value >> (8*i)) & 0xff);
+}
+
+void
+BinaryWriter::write_varint(uint64_t value)
+{
+    while (value >= 0x80) {
+        this->data += (char)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    this->data += (char)value;
+}
+
+void
+BinaryWriter::write_double(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) this->data += (char)((bits >> (8*i)) & 0xff);
+}
+
+void
+BinaryWriter::write_points(const Points &points)
+{
+    this->write_varint(points.size());
+    int64_t x = 0, y = 0;
+    for (Points::const_iterator it = points.begin(); it != points.end(); ++it) {
+        const int64_t dx = (int64_t)it->x - x;
+        const int64_t dy = (int64_t)it->y - y;
+        // zigzag encoding keeps small negative deltas small
+        this->write_varint(((uint64_t)dx << 1) ^ (uint64_t)(dx >> 63));
+        this->write_varint(((uint64_t)dy << 1) ^ (uint64_t)(dy >> 63));
+        x = it->x;
+        y = it->y;
+    }
+}
+
+bool
+BinaryReader::read_uint32(uint32_t* value)
+{
+    if (this->end - this->p < 4) return false;
+    *value = (uint32_t)this->p[0] | ((uint32_t)this->p[1] << 8)
+        | ((uint32_t)this->p[2] << 16) | ((uint32_t)this->p[3] << 24);
+    this->p += 4;
+    return true;
+}
+
+bool
+BinaryReader::read_varint(uint64_t* value)
+{
+    uint64_t result = 0;
+    for (int shift = 0; this->p < this->end && shift < 64; shift += 7) {
+        const unsigned char byte = *this->p++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// reads a count, rejecting values that can't fit in the remaining bytes
+// (every item takes at least one) so that corrupted data can't make us
+// allocate huge vectors
+bool
+BinaryReader::read_count(size_t* count)
+{
+    uint64_t value;
+    if (!this->read_varint(&value) || value > (uint64_t)(this->end - this->p)) return false;
+    *count = (size_t)value;
+    return true;
+}
+
+bool
+BinaryReader::read_double(double* value)
+{
+    if (this->end - this->p < 8) return false;
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) bits |= (uint64_t)this->p[i] << (8*i);
+    memcpy(value, &bits, sizeof(bits));
+    this->p += 8;
+    return true;
+}
+
+bool
+BinaryReader::read_points(Points* points)
+{
+    size_t count;
+    if (!this->read_count(&count)) return false;
+    points->resize(count);
+    int64_t x = 0, y = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t dx, dy;
+        if (!this->read_varint(&dx) || !this->read_varint(&dy)) return false;
+        x += (int64_t)(dx >> 1) ^ -(int64_t)(dx & 1);
+        y += (int64_t)(dy >> 1) ^ -(int64_t)(dy & 1);
+        (*points)[i].x = (coord_t)x;
+        (*points)[i].y = (coord_t)y;
+    }
+    return true;
+}
+
+void
+write_expolygon(BinaryWriter* writer, const ExPolygon &expolygon)
+{
+    writer->write_varint(expolygon.holes.size());
+    writer->write_points(expolygon.contour.points);
+    for (Polygons::const_iterator hole = expolygon.holes.begin(); hole != expolygon.holes.end(); ++hole)
+        writer->write_points(hole->points);
+}
+
+bool
+read_expolygon(BinaryReader* reader, ExPolygon* expolygon)
+{
+    size_t holes_count;
+    if (!reader->read_count(&holes_count)) return false;
+    if (!reader->read_points(&expolygon->contour.points)) return false;
+    expolygon->holes.resize(holes_count);
+    for (Polygons::iterator hole = expolygon->holes.begin(); hole != expolygon->holes.end(); ++hole) {
+        if (!reader->read_points(&hole->points)) return false;
+    }
+    return true;
+}
+
+void
+write_expolygons(BinaryWriter* writer, const ExPolygons &expolygons)
+{
+    writer->write_varint(expolygons.size());
+    for (ExPolygons::const_iterator it = expolygons.begin(); it != expolygons.end(); ++it)
+        write_expolygon(writer, *it);
+}
+
+bool
+read_expolygons(BinaryReader* reader, ExPolygons* expolygons)
+{
+    size_t count;
+    if (!reader->read_count(&count)) return false;
+    expolygons->resize(count);
+    for (ExPolygons::iterator it = expolygons->begin(); it != expolygons->end(); ++it) {
+        if (!read_expolygon(reader, &*it)) return false;
+    }
+    return true;
+}
+
+void
+write_surface(BinaryWriter* writer, const Surface &surface)
+{
+    write_expolygon(writer, surface.expolygon);
+    writer->write_varint(surface.surface_type);
+    writer->write_double(surface.thickness);
+    writer->write_varint(surface.thickness_layers);
+    writer->write_double(surface.bridge_angle);
+    writer->write_varint(surface.extra_perimeters);
+}
+
+bool
+read_surface(BinaryReader* reader, Surface* surface)
+{
+    uint64_t surface_type, thickness_layers, extra_perimeters;
+    if (!read_expolygon(reader, &surface->expolygon)
+        || !reader->read_varint(&surface_type)
+        || !reader->read_double(&surface->thickness)
+        || !reader->read_varint(&thickness_layers)
+        || !reader->read_double(&surface->bridge_angle)
+        || !reader->read_varint(&extra_perimeters))
+        return false;
+    if (surface_type > stInternalVoid || thickness_layers > 0xffff || extra_perimeters > 0xffff)
+        return false;
+    surface->surface_type       = (SurfaceType)surface_type;
+    surface->thickness_layers   = (unsigned short)thickness_layers;
+    surface->extra_perimeters   = (unsigned short)extra_perimeters;
+    return true;
+}
+
+static void
+write_extrusion_entities(BinaryWriter* writer, const ExtrusionEntityCollection &collection)
+{
+    writer->write_varint(collection.no_sort ? 1 : 0);
+    writer->write_varint(collection.entities.size());
+    for (ExtrusionEntitiesPtr::const_iterator it = collection.entities.begin(); it != collection.entities.end(); ++it)
+        write_extrusion_entity(writer, **it);
+}
+
+void
+write_extrusion_entity(BinaryWriter* writer, const ExtrusionEntity &entity)
+{
+    if (const ExtrusionEntityCollection* collection = dynamic_cast<const ExtrusionEntityCollection*>(&entity)) {
+        writer->write_varint(seExtrusionEntityCollection);
+        write_extrusion_entities(writer, *collection);
+        return;
+    }
+    
+    const ExtrusionPath* path = dynamic_cast<const ExtrusionPath*>(&entity);
+    writer->write_varint(path != NULL ? seExtrusionPath : seExtrusionLoop);
+    writer->write_varint(entity.role);
+    writer->write_double(entity.mm3_per_mm);
+    if (path != NULL) {
+        writer->write_points(path->polyline.points);
+    } else {
+        writer->write_points(static_cast<const ExtrusionLoop&>(entity).polygon.points);
+    }
+}
+
+static ExtrusionEntity* read_extrusion_entity(BinaryReader* reader, int depth);
+
+static bool
+read_extrusion_entities(BinaryReader* reader, ExtrusionEntityCollection* collection, int depth)
+{
+    uint64_t no_sort;
+    size_t count;
+    if (!reader->read_varint(&no_sort) || !reader->read_count(&count)) return false;
+    collection->no_sort = no_sort != 0;
+    collection->entities.reserve(collection->entities.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        ExtrusionEntity* entity = read_extrusion_entity(reader, depth);
+        if (entity == NULL) return false;
+        collection->entities.push_back(entity);
+    }
+    return true;
+}
+
+// frees what was read so far when decoding fails halfway
+static void
+delete_extrusion_entities(ExtrusionEntityCollection* collection)
+{
+    for (ExtrusionEntitiesPtr::iterator it = collection->entities.begin(); it != collection->entities.end(); ++it) {
+        if (ExtrusionEntityCollection* child = dynamic_cast<ExtrusionEntityCollection*>(*it))
+            delete_extrusion_entities(child);
+        delete *it;
+    }
+    collection->entities.clear();
+}
+
+static ExtrusionEntity*
+read_extrusion_entity(BinaryReader* reader, int depth)
+{
+    uint64_t type;
+    if (!reader->read_varint(&type)) return NULL;
+    
+    if (type == seExtrusionEntityCollection) {
+        if (depth >= SERIALIZE_MAX_DEPTH) return NULL;
+        ExtrusionEntityCollection* collection = new ExtrusionEntityCollection ();
+        if (!read_extrusion_entities(reader, collection, depth + 1)) {
+            delete_extrusion_entities(collection);
+            delete collection;
+            return NULL;
+        }
+        return collection;
+    }
+    if (type != seExtrusionPath && type != seExtrusionLoop) return NULL;
+    
+    uint64_t role;
+    double mm3_per_mm;
+    if (!reader->read_varint(&role) || role > erGapFill || !reader->read_double(&mm3_per_mm))
+        return NULL;
+    ExtrusionEntity* entity;
+    bool ok;
+    if (type == seExtrusionPath) {
+        ExtrusionPath* path = new ExtrusionPath ();
+        ok = reader->read_points(&path->polyline.points);
+        entity = path;
+    } else {
+        ExtrusionLoop* loop = new ExtrusionLoop ();
+        ok = reader->read_points(&loop->polygon.points);
+        entity = loop;
+    }
+    if (!ok) {
+        delete entity;
+        return NULL;
+    }
+    entity->role        = (ExtrusionRole)role;
+    entity->mm3_per_mm  = mm3_per_mm;
+    return entity;
+}
+
+ExtrusionEntity*
+read_extrusion_entity(BinaryReader* reader)
+{
+    return read_extrusion_entity(reader, 0);
+}
+
+static void
+write_header(BinaryWriter* writer, SerializedKind kind)
+{
+    writer->data += "S3SB";
+    writer->write_varint(SERIALIZE_VERSION);
+    writer->write_varint(kind);
+}
+
+static bool
+read_header(BinaryReader* reader, SerializedKind kind)
+{
+    uint64_t version, actual_kind;
+    if (reader->end - reader->p < 4 || memcmp(reader->p, "S3SB", 4) != 0) return false;
+    reader->p += 4;
+    return reader->read_varint(&version) && version == SERIALIZE_VERSION
+        && reader->read_varint(&actual_kind) && actual_kind == (uint64_t)kind;
+}
+
+std::string
+serialize(const ExPolygon &expolygon)
+{
+    BinaryWriter writer;
+    write_header(&writer, skExPolygon);
+    write_expolygon(&writer, expolygon);
+    return writer.data;
+}
+
+std::string
+serialize(const ExPolygonCollection &collection)
+{
+    BinaryWriter writer;
+    write_header(&writer, skExPolygonCollection);
+    write_expolygons(&writer, collection.expolygons);
+    return writer.data;
+}
+
+std::string
+serialize(const Surface &surface)
+{
+    BinaryWriter writer;
+    write_header(&writer, skSurface);
+    write_surface(&writer, surface);
+    return writer.data;
+}
+
+std::string
+serialize(const SurfaceCollection &collection)
+{
+    BinaryWriter writer;
+    write_header(&writer, skSurfaceCollection);
+    writer.write_varint(collection.surfaces.size());
+    for (Surfaces::const_iterator it = collection.surfaces.begin(); it != collection.surfaces.end(); ++it)
+        write_surface(&writer, *it);
+    return writer.data;
+}
+
+std::string
+serialize(const ExtrusionEntityCollection &collection)
+{
+    BinaryWriter writer;
+    write_header(&writer, skExtrusionEntityCollection);
+    write_extrusion_entities(&writer, collection);
+    return writer.data;
+}
+
+bool
+deserialize(const char* data, size_t size, ExPolygon* expolygon)
+{
+    BinaryReader reader(data, size);
+    return read_header(&reader, skExPolygon)
+        && read_expolygon(&reader, expolygon)
+        && reader.at_end();
+}
+
+bool
+deserialize(const char* data, size_t size, ExPolygonCollection* collection)
+{
+    BinaryReader reader(data, size);
+    return read_header(&reader, skExPolygonCollection)
+        && read_expolygons(&reader, &collection->expolygons)
+        && reader.at_end();
+}
+
+bool
+deserialize(const char* data, size_t size, Surface* surface)
+{
+    BinaryReader reader(data, size);
+    return read_header(&reader, skSurface)
+        && read_surface(&reader, surface)
+        && reader.at_end();
+}
+
+bool
+deserialize(const char* data, size_t size, SurfaceCollection* collection)
+{
+    BinaryReader reader(data, size);
+    size_t count;
+    if (!read_header(&reader, skSurfaceCollection) || !reader.read_count(&count)) return false;
+    collection->surfaces.resize(count);
+    for (Surfaces::iterator it = collection->surfaces.begin(); it != collection->surfaces.end(); ++it) {
+        if (!read_surface(&reader, &*it)) return false;
+    }
+    return reader.at_end();
+}
+
+bool
+deserialize(const char* data, size_t size, ExtrusionEntityCollection* collection)
+{
+    BinaryReader reader(data, size);
+    ExtrusionEntityCollection loaded;
+    if (read_header(&reader, skExtrusionEntityCollection)
+        && read_extrusion_entities(&reader, &loaded, 0)
+        && reader.at_end()) {
+        collection->entities.insert(collection->entities.end(), loaded.entities.begin(), loaded.entities.end());
+        collection->no_sort = loaded.no_sort;
+        return true;
+    }
+    
+    // we own whatever was read before the error
+    delete_extrusion_entities(&loaded);
+    return false;
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef slic3r_Serialize_hpp_
+#define slic3r_Serialize_hpp_
+
+#include <myinit.h>
+#include "ExPolygon.hpp"
+#include "ExPolygonCollection.hpp"
+#include "ExtrusionEntityCollection.hpp"
+#include "SurfaceCollection.hpp"
+#include <stdint.h>
+#include <string>
+
+namespace Slic3r {
+
+/* Compact binary encoding of geometry, used to checkpoint intermediate
+   results and to move them between processes. Counts and enums are stored
+   as varints, point coordinates as zigzag varint deltas from the previous
+   point and doubles as little-endian IEEE 754, so the encoding doesn't
+   depend on the host. */
+class BinaryWriter
+{
+    public:
+    std::string data;
+    void write_uint32(uint32_t value);
+    void write_varint(uint64_t value);
+    void write_double(double value);
+    void write_points(const Points &points);
+};
+
+/* Decodes from a buffer owned by the caller (a memory-mapped file or a Perl
+   string) without copying it. Every read_*() returns false when the data
+   is truncated or malformed. */
+class BinaryReader
+{
+    public:
+    const unsigned char* p;
+    const unsigned char* end;
+    BinaryReader(const char* data, size_t size)
+        : p((const unsigned char*)data), end((const unsigned char*)data + size) {};
+    bool at_end() const { return this->p == this->end; };
+    bool read_uint32(uint32_t* value);
+    bool read_varint(uint64_t* value);
+    bool read_count(size_t* count);
+    bool read_double(double* value);
+    bool read_points(Points* points);
+};
+
+// encoding of the objects themselves, without any framing
+void write_expolygon(BinaryWriter* writer, const ExPolygon &expolygon);
+bool read_expolygon(BinaryReader* reader, ExPolygon* expolygon);
+void write_expolygons(BinaryWriter* writer, const ExPolygons &expolygons);
+bool read_expolygons(BinaryReader* reader, ExPolygons* expolygons);
+void write_surface(BinaryWriter* writer, const Surface &surface);
+bool read_surface(BinaryReader* reader, Surface* surface);
+void write_extrusion_entity(BinaryWriter* writer, const ExtrusionEntity &entity);
+ExtrusionEntity* read_extrusion_entity(BinaryReader* reader);
+
+/* Self-contained blobs: a header carrying a magic string, the format
+   version and the object kind, followed by the object. deserialize()
+   rejects blobs of another kind or version and trailing garbage. */
+std::string serialize(const ExPolygon &expolygon);
+std::string serialize(const ExPolygonCollection &collection);
+std::string serialize(const Surface &surface);
+std::string serialize(const SurfaceCollection &collection);
+std::string serialize(const ExtrusionEntityCollection &collection);
+bool deserialize(const char* data, size_t size, ExPolygon* expolygon);
+bool deserialize(const char* data, size_t size, ExPolygonCollection* collection);
+bool deserialize(const char* data, size_t size, Surface* surface);
+bool deserialize(const char* data, size_t size, SurfaceCollection* collection);
+bool deserialize(const char* data, size_t size, ExtrusionEntityCollection* collection);
+
+}
+
+#endif
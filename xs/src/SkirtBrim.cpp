@@ -0,0 +1,172 @@
+#include "SkirtBrim.hpp"
+#include "ClipperUtils.hpp"
+#include "Geometry.hpp"
+
+namespace Slic3r {
+
+void
+SkirtBrim::add_skirt_slices(const ExPolygonCollection* slices)
+{
+    // holes can't contribute to the convex hull
+    for (ExPolygons::const_iterator it = slices->expolygons.begin(); it != slices->expolygons.end(); ++it)
+        this->object_points.insert(this->object_points.end(), it->contour.points.begin(), it->contour.points.end());
+}
+
+void
+SkirtBrim::add_skirt_paths(const ExtrusionEntityCollection* paths)
+{
+    for (ExtrusionEntitiesPtr::const_iterator it = paths->entities.begin(); it != paths->entities.end(); ++it) {
+        if (const ExtrusionPath* path = dynamic_cast<const ExtrusionPath*>(*it)) {
+            this->object_points.insert(this->object_points.end(), path->polyline.points.begin(), path->polyline.points.end());
+        } else if (const ExtrusionLoop* loop = dynamic_cast<const ExtrusionLoop*>(*it)) {
+            this->object_points.insert(this->object_points.end(), loop->polygon.points.begin(), loop->polygon.points.end());
+        } else if (const ExtrusionEntityCollection* collection = dynamic_cast<const ExtrusionEntityCollection*>(*it)) {
+            this->add_skirt_paths(collection);
+        }
+    }
+}
+
+/* Closes the current object: its convex hull is translated to each copy. */
+void
+SkirtBrim::add_skirt_copies(const Points &copies)
+{
+    if (this->object_points.size() >= 3) {
+        Polygon hull;
+        Slic3r::Geometry::convex_hull(this->object_points, &hull);
+        for (Points::const_iterator copy = copies.begin(); copy != copies.end(); ++copy) {
+            for (Points::const_iterator p = hull.points.begin(); p != hull.points.end(); ++p)
+                this->hull_points.push_back(Point(p->x + copy->x, p->y + copy->y));
+        }
+    }
+    this->object_points.clear();
+}
+
+void
+SkirtBrim::add_brim_slices(const ExPolygonCollection* slices)
+{
+    for (ExPolygons::const_iterator it = slices->expolygons.begin(); it != slices->expolygons.end(); ++it)
+        this->object_islands.push_back(it->contour);
+}
+
+void
+SkirtBrim::add_brim_paths(const ExtrusionEntityCollection* paths, coord_t grow_distance)
+{
+    Polylines polylines;
+    for (ExtrusionEntitiesPtr::const_iterator it = paths->entities.begin(); it != paths->entities.end(); ++it) {
+        if (const ExtrusionPath* path = dynamic_cast<const ExtrusionPath*>(*it))
+            polylines.push_back(path->polyline);
+    }
+    Polygons grown;
+    offset(polylines, grown, grow_distance);
+    this->object_islands.insert(this->object_islands.end(), grown.begin(), grown.end());
+}
+
+/* Closes the current object: its islands are translated to each copy. */
+void
+SkirtBrim::add_brim_copies(const Points &copies)
+{
+    for (Points::const_iterator copy = copies.begin(); copy != copies.end(); ++copy) {
+        for (Polygons::const_iterator it = this->object_islands.begin(); it != this->object_islands.end(); ++it) {
+            this->islands.push_back(*it);
+            this->islands.back().translate(copy->x, copy->y);
+        }
+    }
+    this->object_islands.clear();
+}
+
+/* Adds the given loops (i.e. the skirt) as islands, for when brim touches them. */
+void
+SkirtBrim::add_brim_loops(const ExtrusionEntityCollection* loops, coord_t grow_distance)
+{
+    Polylines polylines;
+    for (ExtrusionEntitiesPtr::const_iterator it = loops->entities.begin(); it != loops->entities.end(); ++it) {
+        if (const ExtrusionLoop* loop = dynamic_cast<const ExtrusionLoop*>(*it)) {
+            // split at first point
+            Polyline pl;
+            pl.points = loop->polygon.points;
+            pl.points.push_back(loop->polygon.points.front());
+            polylines.push_back(pl);
+        }
+    }
+    Polygons grown;
+    offset(polylines, grown, grow_distance);
+    this->islands.insert(this->islands.end(), grown.begin(), grown.end());
+}
+
+/* Draws the skirt loops from outside to inside, looping while we have less loops
+   than required or any extruder hasn't reached min_skirt_length (if any); loops
+   are appended from inside to outside. Returns false if there's nothing to
+   surround. */
+bool
+SkirtBrim::make_skirt(ExtrusionEntityCollection* skirt, int skirts, coord_t distance, coord_t spacing,
+    double mm3_per_mm, double min_skirt_length, const std::vector<double> &extruders_e_per_mm) const
+{
+    if (this->hull_points.size() < 3) return false;  // at least three points required for a convex hull
+    
+    Points points = this->hull_points;
+    Polygon convex_hull;
+    Slic3r::Geometry::convex_hull(points, &convex_hull);
+    
+    std::vector<double> extruded_length(extruders_e_per_mm.size(), 0);
+    size_t extruder_idx = 0;
+    
+    ExtrusionEntitiesPtr loops;
+    for (int i = skirts; i > 0; --i) {
+        distance += spacing;
+        Polygons loop_pp;
+        offset(Polygons(1, convex_hull), loop_pp, distance, 1, jtRound, scale_(0.1));
+        if (loop_pp.empty()) continue;
+        
+        ExtrusionLoop* loop = new ExtrusionLoop();
+        loop->polygon       = loop_pp.front();
+        loop->role          = erSkirt;
+        loop->mm3_per_mm    = mm3_per_mm;
+        loops.push_back(loop);
+        
+        if (min_skirt_length > 0 && !extruders_e_per_mm.empty()) {
+            extruded_length[extruder_idx] += unscale(loop->polygon.length()) * extruders_e_per_mm[extruder_idx];
+            for (size_t j = 0; j < extruded_length.size(); ++j) {
+                if (extruded_length[j] < min_skirt_length) {
+                    ++i;
+                    break;
+                }
+            }
+            if (extruded_length[extruder_idx] >= min_skirt_length && extruder_idx < extruded_length.size() - 1)
+                ++extruder_idx;
+        }
+    }
+    
+    for (ExtrusionEntitiesPtr::reverse_iterator it = loops.rbegin(); it != loops.rend(); ++it) {
+        (*it)->reverse();
+        skirt->entities.push_back(*it);
+    }
+    return true;
+}
+
+/* Appends the given number of brim loops around the collected islands. */
+void
+SkirtBrim::make_brim(ExtrusionEntityCollection* brim, int loops, coord_t spacing, double mm3_per_mm) const
+{
+    Polygons loops_pp;
+    for (int i = loops; i >= 1; --i) {
+        // JT_SQUARE ensures no vertex is outside the given offset distance
+        // -0.5 because islands are not represented by their centerlines
+        // (first offset more, then step back - reverse order than the one used for
+        // perimeters because here we're offsetting outwards)
+        Polygons pp;
+        offset2(this->islands, pp, (i + 0.5) * spacing, -1.0 * spacing, 100000, jtSquare);
+        loops_pp.insert(loops_pp.end(), pp.begin(), pp.end());
+    }
+    
+    Polygons chained;
+    union_pt_chained(loops_pp, chained);
+    for (Polygons::const_reverse_iterator it = chained.rbegin(); it != chained.rend(); ++it) {
+        ExtrusionLoop* loop = new ExtrusionLoop();
+        loop->polygon       = *it;
+        loop->role          = erSkirt;
+        loop->mm3_per_mm    = mm3_per_mm;
+        brim->entities.push_back(loop);
+    }
+}
+
+}
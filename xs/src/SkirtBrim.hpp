@@ -0,0 +1,39 @@
+#ifndef slic3r_SkirtBrim_hpp_
+#define slic3r_SkirtBrim_hpp_
+
+#include <myinit.h>
+#include <vector>
+#include "ExPolygonCollection.hpp"
+#include "ExtrusionEntityCollection.hpp"
+#include "Polygon.hpp"
+
+namespace Slic3r {
+
+/* Generates the skirt and brim loops around all the objects of a print.
+   Geometry is collected one object at a time and then instanced for each of
+   its copies: the skirt only needs the convex hull of each object, which is
+   computed once and translated for every copy. */
+class SkirtBrim
+{
+    public:
+    void add_skirt_slices(const ExPolygonCollection* slices);
+    void add_skirt_paths(const ExtrusionEntityCollection* paths);
+    void add_skirt_copies(const Points &copies);
+    void add_brim_slices(const ExPolygonCollection* slices);
+    void add_brim_paths(const ExtrusionEntityCollection* paths, coord_t grow_distance);
+    void add_brim_copies(const Points &copies);
+    void add_brim_loops(const ExtrusionEntityCollection* loops, coord_t grow_distance);
+    bool make_skirt(ExtrusionEntityCollection* skirt, int skirts, coord_t distance, coord_t spacing,
+        double mm3_per_mm, double min_skirt_length, const std::vector<double> &extruders_e_per_mm) const;
+    void make_brim(ExtrusionEntityCollection* brim, int loops, coord_t spacing, double mm3_per_mm) const;
+
+    private:
+    Points object_points;       // points of the current object, before instancing
+    Polygons object_islands;    // islands of the current object, before instancing
+    Points hull_points;         // points of the convex hulls of all object copies
+    Polygons islands;           // islands of all object copies
+};
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include "SliceCache.hpp"
+#include "Serialize.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdint.h>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Slic3r {
+
+// bump this whenever the file layout or the slicing algorithm changes
+#define SLICE_CACHE_VERSION 1
+#define SLICE_CACHE_HEADER_SIZE 16
+
+static bool
+read_layers(const char* data, size_t size, size_t layers_count, std::vector<ExPolygons>* layers)
+{
+    BinaryReader reader(data, size);
+    uint32_t version, count, payload_size;
+    if (size < SLICE_CACHE_HEADER_SIZE || memcmp(data, "S3SC", 4) != 0) return false;
+    reader.p += 4;
+    reader.read_uint32(&version);
+    reader.read_uint32(&count);
+    reader.read_uint32(&payload_size);
+    if (version != SLICE_CACHE_VERSION || count != layers_count || payload_size != size - SLICE_CACHE_HEADER_SIZE)
+        return false;
+    
+    layers->resize(layers_count);
+    for (std::vector<ExPolygons>::iterator layer = layers->begin(); layer != layers->end(); ++layer) {
+        if (!read_expolygons(&reader, &*layer)) return false;
+    }
+    return reader.at_end();
+}
+
+// two independent 64-bit hashes (FNV-1a on bytes and a multiplicative hash
+// on 32-bit words) making up a 128-bit key
+class SliceCacheHasher
+{
+    public:
+    uint64_t h1;
+    uint64_t h2;
+    SliceCacheHasher() : h1(0xcbf29ce484222325ULL), h2(SLICE_CACHE_VERSION) {};
+    
+    void add(const void* data, size_t len) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < len; ++i)
+            this->h1 = (this->h1 ^ bytes[i]) * 0x100000001b3ULL;
+        for (size_t i = 0; i + 4 <= len; i += 4) {
+            uint32_t word;
+            memcpy(&word, bytes + i, 4);
+            this->h2 = (this->h2 ^ word) * 0x9e3779b97f4a7c15ULL;
+            this->h2 ^= this->h2 >> 29;
+        }
+    };
+};
+
+std::string
+SliceCache::key(const TriangleMesh &mesh, const std::vector<float> &z)
+{
+    SliceCacheHasher hasher;
+    const double scaling_factor = SCALING_FACTOR;
+    const uint32_t facets_count = mesh.stl.stats.number_of_facets;
+    const uint32_t z_count = z.size();
+    hasher.add(&scaling_factor, sizeof(scaling_factor));
+    hasher.add(&facets_count, sizeof(facets_count));
+    for (uint32_t i = 0; i < facets_count; ++i)
+        hasher.add(mesh.stl.facet_start[i].vertex, sizeof(stl_vertex) * 3);
+    hasher.add(&z_count, sizeof(z_count));
+    if (!z.empty()) hasher.add(&z.front(), sizeof(float) * z.size());
+    
+    char key[33];
+    sprintf(key, "%08x%08x%08x%08x",
+        (unsigned int)(hasher.h1 >> 32), (unsigned int)(hasher.h1 & 0xffffffff),
+        (unsigned int)(hasher.h2 >> 32), (unsigned int)(hasher.h2 & 0xffffffff));
+    return std::string(key);
+}
+
+std::string
+SliceCache::path(const std::string &key) const
+{
+    return this->dir + "/" + key + ".slices";
+}
+
+bool
+SliceCache::load(const std::string &key, size_t layers_count, std::vector<ExPolygons>* layers) const
+{
+    const std::string path = this->path(key);
+    bool ok;
+    
+    #ifdef _WIN32
+    std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+    if (!file) return false;
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ok = !data.empty()
+        && read_layers(&data.front(), data.size(), layers_count, layers);
+    #else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < SLICE_CACHE_HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    ok = read_layers((const char*)data, st.st_size, layers_count, layers);
+    munmap(data, st.st_size);
+    #endif
+    
+    if (!ok) layers->clear();
+    return ok;
+}
+
+bool
+SliceCache::store(const std::string &key, const std::vector<ExPolygons> &layers) const
+{
+    BinaryWriter payload;
+    for (std::vector<ExPolygons>::const_iterator layer = layers.begin(); layer != layers.end(); ++layer)
+        write_expolygons(&payload, *layer);
+    
+    BinaryWriter writer;
+    writer.data = "S3SC";
+    writer.write_uint32(SLICE_CACHE_VERSION);
+    writer.write_uint32(layers.size());
+    writer.write_uint32(payload.data.size());
+    const std::string data = writer.data + payload.data;
+    
+    // write to a file private to this call, then move it into place
+    const std::string path = this->path(key);
+    std::ostringstream tmp_path;
+    tmp_path << path << ".tmp" << getpid() << "-" << (const void*)&layers;
+    FILE* file = fopen(tmp_path.str().c_str(), "wb");
+    if (file == NULL) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = (fclose(file) == 0) && ok;
+    if (ok) ok = rename(tmp_path.str().c_str(), path.c_str()) == 0;
+    if (!ok) remove(tmp_path.str().c_str());
+    return ok;
+}
+
+}
@@ -0,0 +1,36 @@
+#ifndef slic3r_SliceCache_hpp_
+#define slic3r_SliceCache_hpp_
+
+#include <myinit.h>
+#include "ExPolygon.hpp"
+#include "TriangleMesh.hpp"
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+/* On-disk cache of TriangleMeshSlicer results. Entries are addressed by a
+   hash of the (already transformed) mesh facets and of the slicing Z list,
+   so identical slicing jobs share them no matter which file or config they
+   come from. Each entry is a file made of a fixed header followed by the
+   layers, where point coordinates are stored as zigzag varint deltas; the
+   format holds no pointers or padding, so it's read straight from a
+   memory-mapped file. Writers go through a temporary file and a rename, so
+   concurrent processes never see partial entries. */
+class SliceCache
+{
+    public:
+    std::string dir;
+    
+    SliceCache(const std::string &_dir) : dir(_dir) {};
+    static std::string key(const TriangleMesh &mesh, const std::vector<float> &z);
+    bool load(const std::string &key, size_t layers_count, std::vector<ExPolygons>* layers) const;
+    bool store(const std::string &key, const std::vector<ExPolygons> &layers) const;
+    
+    private:
+    std::string path(const std::string &key) const;
+};
+
+}
+
+#endif
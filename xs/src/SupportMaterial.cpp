@@ -0,0 +1,346 @@
+#include "SupportMaterial.hpp"
+#include "BoundingBox.hpp"
+#include "ClipperUtils.hpp"
+
+namespace Slic3r {
+
+SupportMaterial::SupportMaterial(const std::vector<coordf_t> &_support_z, int _interface_layers,
+    coord_t _flow_width, coord_t _interface_flow_width)
+    : support_z(_support_z), interface_layers(_interface_layers), flow_width(_flow_width),
+      interface_flow_width(_interface_flow_width)
+{
+    this->contact.resize(this->support_z.size());
+    this->top.resize(this->support_z.size());
+    this->interface.resize(this->support_z.size());
+    this->base.resize(this->support_z.size());
+}
+
+void
+SupportMaterial::add_object_layer(coordf_t print_z, coordf_t height, const Polygons &slices)
+{
+    this->object_layers.push_back(SupportObjectLayer(print_z, height, slices));
+}
+
+void
+SupportMaterial::generate()
+{
+    // propagate contact layers downwards to generate interface layers
+    this->generate_interface_layers();
+    this->clip_with_object(this->interface);
+    if (!this->shape.empty()) this->clip_with_shape(this->interface);
+
+    // propagate contact layers and interface layers downwards to generate
+    // the main support layers
+    this->generate_base_layers();
+    this->clip_with_object(this->base);
+    if (!this->shape.empty()) this->clip_with_shape(this->base);
+}
+
+void
+SupportMaterial::generate_interface_layers()
+{
+    const int layer_count = this->support_z.size();
+    for (int layer_id = 0; layer_id < layer_count; ++layer_id) {
+        if (this->contact[layer_id].empty()) continue;
+        Polygons current = this->contact[layer_id];
+
+        // count contact layer as interface layer
+        for (int i = layer_id-1; i >= 0 && i > layer_id - this->interface_layers; --i) {
+            std::vector<size_t> overlapping = this->overlapping_layers(i);
+
+            // Compute interface area on this layer as diff of upper contact area
+            // (or upper interface area) and layer slices.
+            Polygons subject = current;
+            subject.insert(subject.end(), this->interface[i].begin(), this->interface[i].end());
+
+            Polygons clip;
+            for (std::vector<size_t>::const_iterator j = overlapping.begin(); j != overlapping.end(); ++j)
+                clip.insert(clip.end(), this->top[*j].begin(), this->top[*j].end());
+            for (std::vector<size_t>::const_iterator j = overlapping.begin(); j != overlapping.end(); ++j)
+                clip.insert(clip.end(), this->contact[*j].begin(), this->contact[*j].end());
+
+            diff(subject, clip, this->interface[i], true);
+            current = this->interface[i];
+        }
+    }
+}
+
+void
+SupportMaterial::generate_base_layers()
+{
+    for (int i = (int)this->support_z.size() - 2; i >= 0; --i) {
+        std::vector<size_t> overlapping = this->overlapping_layers(i);
+
+        Polygons subject = this->base[i+1];                 // support regions on upper layer
+        subject.insert(subject.end(), this->interface[i+1].begin(), this->interface[i+1].end());
+
+        // in case we have no interface layers, look at upper contact
+        // (1 interface layer means we only have contact layer, so interface[i+1] is empty)
+        if (this->interface_layers <= 1)
+            subject.insert(subject.end(), this->contact[i+1].begin(), this->contact[i+1].end());
+
+        Polygons clip;
+        for (std::vector<size_t>::const_iterator j = overlapping.begin(); j != overlapping.end(); ++j)
+            clip.insert(clip.end(), this->top[*j].begin(), this->top[*j].end());
+        for (std::vector<size_t>::const_iterator j = overlapping.begin(); j != overlapping.end(); ++j)
+            clip.insert(clip.end(), this->interface[*j].begin(), this->interface[*j].end());
+        for (std::vector<size_t>::const_iterator j = overlapping.begin(); j != overlapping.end(); ++j)
+            clip.insert(clip.end(), this->contact[*j].begin(), this->contact[*j].end());
+
+        diff(subject, clip, this->base[i], true);
+    }
+}
+
+void
+SupportMaterial::clip_with_object(std::vector<Polygons> &support) const
+{
+    for (size_t i = 0; i < support.size(); ++i) {
+        if (support[i].empty()) continue;
+
+        const coordf_t zmax = this->support_z[i];
+        const coordf_t zmin = this->layer_bottom(i);
+
+        Polygons slices;
+        for (std::vector<SupportObjectLayer>::const_iterator layer = this->object_layers.begin(); layer != this->object_layers.end(); ++layer) {
+            if (layer->print_z > zmin && (layer->print_z - layer->height) < zmax)
+                slices.insert(slices.end(), layer->slices.begin(), layer->slices.end());
+        }
+
+        Polygons grown;
+        offset(slices, grown, +this->flow_width);
+        Polygons clipped;
+        diff(support[i], grown, clipped);
+        support[i] = clipped;
+    }
+}
+
+void
+SupportMaterial::clip_with_shape(std::vector<Polygons> &support) const
+{
+    for (size_t i = 0; i < support.size(); ++i) {
+        Polygons clipped;
+        intersection(support[i], this->shape[i], clipped);
+        support[i] = clipped;
+    }
+}
+
+/* Generates a tree-like structure to save material: a grid of pillars, enlarged
+   into capitals below the contact areas. */
+void
+SupportMaterial::generate_pillars_shape(coord_t pillar_size, coord_t pillar_spacing)
+{
+    const size_t layer_count = this->support_z.size();
+    this->shape.clear();
+    this->shape.resize(layer_count);
+
+    Polygons grid;
+    {
+        Points points;
+        for (std::vector<Polygons>::const_iterator c = this->contact.begin(); c != this->contact.end(); ++c)
+            for (Polygons::const_iterator p = c->begin(); p != c->end(); ++p)
+                points.insert(points.end(), p->points.begin(), p->points.end());
+        if (points.empty()) return;
+        BoundingBox bb(points);
+
+        Polygon pillar;
+        pillar.points.push_back(Point(0, 0));
+        pillar.points.push_back(Point(pillar_size, 0));
+        pillar.points.push_back(Point(pillar_size, pillar_size));
+        pillar.points.push_back(Point(0, pillar_size));
+
+        Polygons pillars;
+        for (coord_t x = bb.min.x; x <= bb.max.x - pillar_size; x += pillar_spacing) {
+            for (coord_t y = bb.min.y; y <= bb.max.y - pillar_size; y += pillar_spacing) {
+                pillars.push_back(pillar);
+                pillars.back().translate(x, y);
+            }
+        }
+        union_(pillars, grid);
+    }
+
+    // add pillars to every layer
+    for (size_t i = 0; i < layer_count; ++i)
+        this->shape[i] = grid;
+
+    // build capitals
+    for (size_t i = 0; i < layer_count; ++i) {
+        if (this->contact[i].empty()) continue;
+
+        Polygons capitals;
+        intersection(grid, this->contact[i], capitals);
+
+        // work on one pillar at time (if any) to prevent the capitals from being merged
+        // but store the contact area supported by the capital because we need to make
+        // sure nothing is left
+        Polygons contact_supported_by_capitals;
+        for (Polygons::const_iterator it = capitals.begin(); it != capitals.end(); ++it) {
+            // enlarge capital tops
+            Polygons capital;
+            offset(Polygons(1, *it), capital, +(pillar_spacing - pillar_size)/2.0);
+            contact_supported_by_capitals.insert(contact_supported_by_capitals.end(), capital.begin(), capital.end());
+
+            for (int j = i-1; j >= 0 && !capital.empty(); --j) {
+                Polygons shrunk;
+                offset(capital, shrunk, -this->interface_flow_width/2.0);
+                capital = shrunk;
+                this->shape[j].insert(this->shape[j].end(), capital.begin(), capital.end());
+            }
+        }
+
+        // Capitals will not generally cover the whole contact area because there will be
+        // remainders. For now we handle this situation by projecting such unsupported
+        // areas to the ground, just like we would do with a normal support.
+        Polygons contact_not_supported_by_capitals;
+        diff(this->contact[i], contact_supported_by_capitals, contact_not_supported_by_capitals);
+        for (int j = i-1; j >= 0; --j)
+            this->shape[j].insert(this->shape[j].end(), contact_not_supported_by_capitals.begin(), contact_not_supported_by_capitals.end());
+    }
+}
+
+/* Returns the indices of the support layers overlapping with the given one. */
+std::vector<size_t>
+SupportMaterial::overlapping_layers(size_t layer_id) const
+{
+    const coordf_t zmax = this->support_z[layer_id];
+    const coordf_t zmin = this->layer_bottom(layer_id);
+
+    // layers are sorted by Z, so the overlapping ones are contiguous
+    size_t first = layer_id, last = layer_id;
+    while (first > 0 && this->overlaps(first-1, zmin, zmax)) --first;
+    while (last+1 < this->support_z.size() && this->overlaps(last+1, zmin, zmax)) ++last;
+
+    std::vector<size_t> layers;
+    for (size_t i = first; i <= last; ++i)
+        if (this->overlaps(i, zmin, zmax)) layers.push_back(i);
+    return layers;
+}
+
+coordf_t
+SupportMaterial::layer_bottom(size_t layer_id) const
+{
+    return (layer_id == 0) ? 0 : this->support_z[layer_id-1];
+}
+
+bool
+SupportMaterial::overlaps(size_t layer_id, coordf_t zmin, coordf_t zmax) const
+{
+    return zmax > this->layer_bottom(layer_id) && zmin < this->support_z[layer_id];
+}
+
+void
+SupportContactDetector::add_layer(const Polygons &slices)
+{
+    this->layers.push_back(SupportContactLayer(slices));
+}
+
+void
+SupportContactDetector::add_footprint(size_t layer_id)
+{
+    this->layers.at(layer_id).footprint = true;
+}
+
+void
+SupportContactDetector::add_region(size_t layer_id, const Polygons &region_slices, coord_t flow_width,
+    coordf_t threshold_d, bool use_threshold)
+{
+    if (layer_id == 0) CONFESS("The first layer has no layer below to detect overhangs against");
+    this->layers.at(layer_id).regions.push_back(SupportContactRegion(region_slices, flow_width, threshold_d, use_threshold));
+}
+
+class SupportContactJob : public ThreadPoolJob
+{
+    public:
+    SupportContactDetector* detector;
+    SupportContactJob(SupportContactDetector* _detector) : detector(_detector) {};
+    void run(size_t task) {
+        SupportContactLayer &layer = this->detector->layers[task];
+        if (layer.footprint) this->detector->detect_footprint(task);
+        for (std::vector<SupportContactRegion>::const_iterator it = layer.regions.begin(); it != layer.regions.end(); ++it)
+            this->detector->detect(task, it->slices, it->flow_width, it->threshold_d, it->use_threshold);
+    };
+};
+
+// one task per layer, so that each layer is only written by a single thread
+void
+SupportContactDetector::detect_layers(ThreadPool* pool)
+{
+    SupportContactJob job(this);
+    pool->run(&job, this->layers.size());
+    
+    for (std::vector<SupportContactLayer>::iterator it = this->layers.begin(); it != this->layers.end(); ++it) {
+        it->footprint = false;
+        it->regions.clear();
+    }
+}
+
+/* This is the first object layer, so we're here just to get the object
+   footprint for the raft. */
+void
+SupportContactDetector::detect_footprint(size_t layer_id)
+{
+    SupportContactLayer &layer = this->layers.at(layer_id);
+    layer.overhang.insert(layer.overhang.end(), layer.slices.begin(), layer.slices.end());
+    offset(layer.slices, layer.contact, +this->margin);
+}
+
+/* Detects the overhangs of the given region slices over the layer below and
+   appends them, along with their contact areas, to the layer. */
+void
+SupportContactDetector::detect(size_t layer_id, const Polygons &region_slices, coord_t flow_width,
+    coordf_t threshold_d, bool use_threshold)
+{
+    SupportContactLayer &layer = this->layers.at(layer_id);
+    const Polygons &lower_slices = this->layers.at(layer_id-1).slices;
+    const coord_t fw = flow_width;
+
+    Polygons diff_pp;
+    if (use_threshold) {
+        Polygons shrunk;
+        offset(region_slices, shrunk, -threshold_d);
+        diff(shrunk, lower_slices, diff_pp);
+
+        // only enforce spacing from the object (fw/2) if the threshold angle
+        // is not too high: in that case, d will be very small (as we need to catch
+        // very short overhangs), and such contact area would be eaten by the
+        // enforced spacing, resulting in high threshold angles to be almost ignored
+        if (threshold_d > fw/2.0) {
+            Polygons grown;
+            offset(diff_pp, grown, threshold_d - fw/2.0);
+            diff(grown, lower_slices, diff_pp);
+        }
+    } else {
+        Polygons shrunk;
+        offset(region_slices, shrunk, -fw/2.0);
+        diff(shrunk, lower_slices, diff_pp);
+
+        // collapse very tiny spots
+        Polygons collapsed;
+        offset2(diff_pp, collapsed, -fw/10.0, +fw/10.0);
+        diff_pp = collapsed;
+
+        // diff_pp now contains the ring or stripe comprised between the boundary of
+        // lower slices and the centerline of the last perimeter in this overhanging layer.
+        // Void diff_pp means that there's no upper perimeter whose centerline is
+        // outside the lower slice boundary, thus no overhang
+    }
+
+    if (diff_pp.empty()) return;
+    // NOTE: this is not the full overhang as it misses the outermost half of the perimeter width!
+    layer.overhang.insert(layer.overhang.end(), diff_pp.begin(), diff_pp.end());
+
+    // Let's define the required contact area by using a max gap of half the upper
+    // extrusion width and extending the area according to the configured margin.
+    // We increment the area in steps because we don't want our support to overflow
+    // on the other side of the object (if it's very thin).
+    Polygons slices_margin;
+    offset(lower_slices, slices_margin, fw/2.0);
+    const int steps = this->margin / this->margin_step;
+    for (int i = 0; i <= steps; ++i) {
+        Polygons grown;
+        offset(diff_pp, grown, (i == 0) ? fw/2.0 : this->margin_step);
+        diff(grown, slices_margin, diff_pp);
+    }
+    layer.contact.insert(layer.contact.end(), diff_pp.begin(), diff_pp.end());
+}
+
+}
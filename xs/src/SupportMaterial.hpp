@@ -0,0 +1,114 @@
+#ifndef slic3r_SupportMaterial_hpp_
+#define slic3r_SupportMaterial_hpp_
+
+#include <myinit.h>
+#include <vector>
+#include "Polygon.hpp"
+#include "ThreadPool.hpp"
+
+namespace Slic3r {
+
+/* Object layer as seen by the support generator: only its vertical extents
+   and its slices are needed to keep support away from the object. */
+class SupportObjectLayer
+{
+    public:
+    coordf_t print_z;
+    coordf_t height;
+    Polygons slices;
+
+    SupportObjectLayer(coordf_t _print_z, coordf_t _height, const Polygons &_slices)
+        : print_z(_print_z), height(_height), slices(_slices) {};
+};
+
+/* Builds the interface and base regions of support material by propagating
+   the contact areas downwards through the support layers, i.e. the polygon
+   work of Slic3r::Print::SupportMaterial. All the per-layer vectors are
+   indexed like support_z. */
+class SupportMaterial
+{
+    public:
+    std::vector<coordf_t> support_z;    // top of each support layer, ascending
+    int interface_layers;               // number of interface layers, including the contact one
+    coord_t flow_width;                 // scaled width of the support material flow
+    coord_t interface_flow_width;       // scaled width of the interface flow
+    std::vector<Polygons> contact;      // contact areas
+    std::vector<Polygons> top;          // object top surfaces touched by support
+    std::vector<Polygons> interface;
+    std::vector<Polygons> base;
+    std::vector<Polygons> shape;        // clipping shape, empty unless pillars are used
+
+    SupportMaterial(const std::vector<coordf_t> &_support_z, int _interface_layers,
+        coord_t _flow_width, coord_t _interface_flow_width);
+    void add_object_layer(coordf_t print_z, coordf_t height, const Polygons &slices);
+    void generate_pillars_shape(coord_t pillar_size, coord_t pillar_spacing);
+    void generate();
+    void generate_interface_layers();
+    void generate_base_layers();
+    void clip_with_object(std::vector<Polygons> &support) const;
+    void clip_with_shape(std::vector<Polygons> &support) const;
+    std::vector<size_t> overlapping_layers(size_t layer_id) const;
+
+    private:
+    std::vector<SupportObjectLayer> object_layers;
+
+    coordf_t layer_bottom(size_t layer_id) const;
+    bool overlaps(size_t layer_id, coordf_t zmin, coordf_t zmax) const;
+};
+
+/* Layer region whose overhangs are to be detected by detect_layers(), with
+   the parameters of detect(). */
+class SupportContactRegion
+{
+    public:
+    Polygons slices;
+    coord_t flow_width;
+    coordf_t threshold_d;
+    bool use_threshold;
+
+    SupportContactRegion(const Polygons &_slices, coord_t _flow_width, coordf_t _threshold_d, bool _use_threshold)
+        : slices(_slices), flow_width(_flow_width), threshold_d(_threshold_d), use_threshold(_use_threshold) {};
+};
+
+/* Object layer as seen by the contact detector: its slices, and the contact
+   and overhang areas detected on it against the layer below. */
+class SupportContactLayer
+{
+    public:
+    Polygons slices;
+    Polygons contact;
+    Polygons overhang;
+    bool footprint;                     // detect_layers() takes the footprint of this layer
+    std::vector<SupportContactRegion> regions;  // regions queued for detect_layers()
+
+    SupportContactLayer(const Polygons &_slices) : slices(_slices), footprint(false) {};
+};
+
+/* Detects overhangs and the contact areas needed to support them. Each layer
+   only depends on itself and on the slices of the layer below, so detect()
+   can be called concurrently as long as every layer is handled by a single
+   thread; all the layers must have been added beforehand. detect_layers()
+   does so on the pool for the footprints and regions queued with
+   add_footprint() and add_region(). */
+class SupportContactDetector
+{
+    public:
+    coord_t margin;                     // scaled extension of the contact area
+    coord_t margin_step;                // scaled increment used to reach margin
+    std::vector<SupportContactLayer> layers;
+
+    SupportContactDetector(coord_t _margin, coord_t _margin_step)
+        : margin(_margin), margin_step(_margin_step) {};
+    void add_layer(const Polygons &slices);
+    void add_footprint(size_t layer_id);
+    void add_region(size_t layer_id, const Polygons &region_slices, coord_t flow_width,
+        coordf_t threshold_d, bool use_threshold);
+    void detect_layers(ThreadPool* pool);
+    void detect_footprint(size_t layer_id);
+    void detect(size_t layer_id, const Polygons &region_slices, coord_t flow_width,
+        coordf_t threshold_d, bool use_threshold);
+};
+
+}
+
+#endif
@@ -1,8 +1,19 @@
 #include "SurfaceCollection.hpp"
+#include "ClipperUtils.hpp"
 #include <map>
 
 namespace Slic3r {
 
+SurfaceCollection::operator Polygons() const
+{
+    Polygons polygons;
+    for (Surfaces::const_iterator surface = this->surfaces.begin(); surface != this->surfaces.end(); ++surface) {
+        Polygons surface_p = surface->expolygon;
+        polygons.insert(polygons.end(), surface_p.begin(), surface_p.end());
+    }
+    return polygons;
+}
+
 void
 SurfaceCollection::simplify(double tolerance)
 {
@@ -48,4 +59,117 @@ SurfaceCollection::group(std::vector<SurfacesPtr> *retval)
     }
 }
 
+/* appends the polygons of the surfaces having the given type */
+void
+SurfaceCollection::polygons_by_type(SurfaceType type, Polygons* polygons) const
+{
+    for (Surfaces::const_iterator surface = this->surfaces.begin(); surface != this->surfaces.end(); ++surface) {
+        if (surface->surface_type != type) continue;
+        Polygons surface_p = surface->expolygon;
+        polygons->insert(polygons->end(), surface_p.begin(), surface_p.end());
+    }
+}
+
+/* appends the given expolygons as new surfaces of the given type */
+void
+SurfaceCollection::append(const ExPolygons &expolygons, SurfaceType surface_type)
+{
+    for (ExPolygons::const_iterator it = expolygons.begin(); it != expolygons.end(); ++it) {
+        Surface s;
+        s.expolygon         = *it;
+        s.surface_type      = surface_type;
+        s.thickness         = -1;
+        s.thickness_layers  = 1;
+        s.bridge_angle      = -1;
+        s.extra_perimeters  = 0;
+        this->surfaces.push_back(s);
+    }
+}
+
+/* Returns the difference of the given polygons as surfaces of the given type,
+   collapsing very narrow parts (using the safety offset in the diff is not enough). */
+static void
+surfaces_difference(const Polygons &subject, const Polygons &clip, SurfaceType surface_type,
+    double collapse_offset, Surfaces &retval)
+{
+    Polygons pp;
+    diff(subject, clip, pp);
+    ExPolygons expp;
+    offset2_ex(pp, expp, -collapse_offset, +collapse_offset);
+    
+    SurfaceCollection collection;
+    collection.append(expp, surface_type);
+    retval = collection.surfaces;
+}
+
+static Polygons
+surfaces_to_polygons(const Surfaces &surfaces)
+{
+    SurfaceCollection collection;
+    collection.surfaces = surfaces;
+    return collection;
+}
+
+/* Classifies the slices of a layer region into top, bottom and internal surfaces
+   by comparing them with the full slices (considering all regions) of the upper
+   and lower layers, which can be NULL when there's no such layer. Neighbour slices
+   are only read, so layers can be processed concurrently. */
+void
+SurfaceCollection::detect_type(const ExPolygonCollection* upper_slices, const ExPolygonCollection* lower_slices,
+    double collapse_offset)
+{
+    const Polygons slices_p = surfaces_to_polygons(this->surfaces);
+    Surfaces top, bottom, internal;
+    
+    // find top surfaces (difference between current surfaces
+    // of current layer and upper one)
+    if (upper_slices != NULL) {
+        surfaces_difference(slices_p, *upper_slices, stTop, collapse_offset, top);
+    } else {
+        // if no upper layer, all surfaces of this one are solid
+        top = this->surfaces;
+        for (Surfaces::iterator it = top.begin(); it != top.end(); ++it) it->surface_type = stTop;
+    }
+    
+    // find bottom surfaces (difference between current surfaces
+    // of current layer and lower one)
+    if (lower_slices != NULL) {
+        surfaces_difference(slices_p, *lower_slices, stBottom, collapse_offset, bottom);
+    } else {
+        // if no lower layer, all surfaces of this one are solid
+        bottom = this->surfaces;
+        for (Surfaces::iterator it = bottom.begin(); it != bottom.end(); ++it) it->surface_type = stBottom;
+    }
+    
+    // now, if the object contained a thin membrane, we could have overlapping bottom
+    // and top surfaces; let's do an intersection to discover them and consider them
+    // as bottom surfaces (to allow for bridge detection)
+    if (!top.empty() && !bottom.empty()) {
+        ExPolygons overlapping;
+        intersection(surfaces_to_polygons(top), surfaces_to_polygons(bottom), overlapping);
+        Polygons overlapping_p;
+        for (ExPolygons::const_iterator it = overlapping.begin(); it != overlapping.end(); ++it) {
+            Polygons pp = *it;
+            overlapping_p.insert(overlapping_p.end(), pp.begin(), pp.end());
+        }
+        const Polygons top_p = surfaces_to_polygons(top);
+        surfaces_difference(top_p, overlapping_p, stTop, collapse_offset, top);
+    }
+    
+    // find internal surfaces (difference between top/bottom surfaces and others)
+    {
+        Polygons solid_p = surfaces_to_polygons(top);
+        const Polygons bottom_p = surfaces_to_polygons(bottom);
+        solid_p.insert(solid_p.end(), bottom_p.begin(), bottom_p.end());
+        surfaces_difference(slices_p, solid_p, stInternal, collapse_offset, internal);
+    }
+    
+    // save surfaces to layer
+    this->surfaces.clear();
+    this->surfaces.reserve(bottom.size() + top.size() + internal.size());
+    this->surfaces.insert(this->surfaces.end(), bottom.begin(), bottom.end());
+    this->surfaces.insert(this->surfaces.end(), top.begin(), top.end());
+    this->surfaces.insert(this->surfaces.end(), internal.begin(), internal.end());
+}
+
 }
@@ -2,6 +2,7 @@
 #define slic3r_SurfaceCollection_hpp_
 
 #include "Surface.hpp"
+#include "ExPolygonCollection.hpp"
 #include <vector>
 
 namespace Slic3r {
@@ -10,8 +11,13 @@ class SurfaceCollection
 {
     public:
     Surfaces surfaces;
+    operator Polygons() const;
     void simplify(double tolerance);
     void group(std::vector<SurfacesPtr> *retval);
+    void polygons_by_type(SurfaceType type, Polygons* polygons) const;
+    void append(const ExPolygons &expolygons, SurfaceType surface_type);
+    void detect_type(const ExPolygonCollection* upper_slices, const ExPolygonCollection* lower_slices,
+        double collapse_offset);
 };
 
 }
@@ -0,0 +1,326 @@
+#include "ThreadPool.hpp"
+#include <stdexcept>
+
+namespace Slic3r {
+
+ThreadPoolWorker::ThreadPoolWorker(ThreadPool* _pool, size_t _slot)
+    : pool(_pool), slot(_slot)
+{
+    pthread_mutex_init(&this->mutex, NULL);
+}
+
+ThreadPoolWorker::~ThreadPoolWorker()
+{
+    pthread_mutex_destroy(&this->mutex);
+}
+
+size_t
+ThreadPoolGraph::add_task(ThreadPoolJob* job, size_t task)
+{
+    this->nodes.push_back(ThreadPoolGraphNode(job, task));
+    return this->nodes.size() - 1;
+}
+
+void
+ThreadPoolGraph::add_dependency(size_t node, size_t prerequisite)
+{
+    if (node >= this->nodes.size() || prerequisite >= node)
+        throw std::invalid_argument("a graph task can only depend on a task added before it");
+    this->nodes[prerequisite].dependents.push_back(node);
+    this->nodes[node].prerequisites++;
+}
+
+size_t
+ThreadPoolGraph::size() const
+{
+    return this->nodes.size();
+}
+
+ThreadPool::ThreadPool(size_t threads)
+    : job(NULL), graph(NULL), pending(0), batch(0), stopping(false), failed(false)
+{
+    pthread_mutex_init(&this->mutex, NULL);
+    pthread_cond_init(&this->wake, NULL);
+    pthread_cond_init(&this->done, NULL);
+    pthread_cond_init(&this->ready, NULL);
+    
+    if (threads < 1) threads = 1;
+    for (size_t i = 0; i < threads; ++i)
+        this->workers.push_back(new ThreadPoolWorker(this, i));
+    
+    // if a thread can't be started the pool just gets smaller
+    for (size_t i = 1; i < this->workers.size(); ++i) {
+        if (pthread_create(&this->workers[i]->thread, NULL, &ThreadPool::thread_main, this->workers[i]) != 0) {
+            for (size_t j = i; j < this->workers.size(); ++j)
+                delete this->workers[j];
+            this->workers.resize(i);
+            break;
+        }
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    pthread_mutex_lock(&this->mutex);
+    this->stopping = true;
+    pthread_cond_broadcast(&this->wake);
+    pthread_mutex_unlock(&this->mutex);
+    
+    for (size_t i = 1; i < this->workers.size(); ++i)
+        pthread_join(this->workers[i]->thread, NULL);
+    for (std::vector<ThreadPoolWorker*>::iterator it = this->workers.begin(); it != this->workers.end(); ++it)
+        delete *it;
+    
+    pthread_cond_destroy(&this->ready);
+    pthread_cond_destroy(&this->done);
+    pthread_cond_destroy(&this->wake);
+    pthread_mutex_destroy(&this->mutex);
+}
+
+size_t
+ThreadPool::size() const
+{
+    return this->workers.size();
+}
+
+void
+ThreadPool::run(ThreadPoolJob* job, size_t tasks)
+{
+    if (tasks == 0) return;
+    if (this->workers.size() == 1) {
+        for (size_t i = 0; i < tasks; ++i) job->run(i);
+        return;
+    }
+    
+    std::vector<size_t> all(tasks);
+    for (size_t i = 0; i < tasks; ++i) all[i] = i;
+    std::vector<size_t> waiting;
+    this->dispatch(job, NULL, &waiting, all);
+}
+
+void
+ThreadPool::run(ThreadPoolGraph* graph)
+{
+    const std::vector<ThreadPoolGraphNode> &nodes = graph->nodes;
+    if (nodes.empty()) return;
+    
+    std::vector<size_t> waiting(nodes.size());
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        waiting[i] = nodes[i].prerequisites;
+        if (waiting[i] == 0) ready.push_back(i);
+    }
+    
+    // depth first, like the threads do
+    if (this->workers.size() == 1) {
+        std::vector<size_t> stack(ready.rbegin(), ready.rend());
+        while (!stack.empty()) {
+            const ThreadPoolGraphNode &node = nodes[stack.back()];
+            stack.pop_back();
+            node.job->run(node.task);
+            for (std::vector<size_t>::const_reverse_iterator it = node.dependents.rbegin(); it != node.dependents.rend(); ++it) {
+                if (--waiting[*it] == 0) stack.push_back(*it);
+            }
+        }
+        return;
+    }
+    
+    this->dispatch(NULL, graph, &waiting, ready);
+}
+
+/* Starts a batch running either job or graph, queueing the given tasks (the
+   graph nodes with no prerequisites), waits for the whole batch to be
+   completed and rethrows the first error of its tasks. waiting is swapped
+   with the pool's for the duration of the batch. */
+void
+ThreadPool::dispatch(ThreadPoolJob* job, ThreadPoolGraph* graph, std::vector<size_t>* waiting,
+    const std::vector<size_t> &tasks)
+{
+    pthread_mutex_lock(&this->mutex);
+    this->job = job;
+    this->graph = graph;
+    this->waiting.swap(*waiting);
+    this->pending = graph != NULL ? graph->nodes.size() : tasks.size();
+    
+    // contiguous blocks keep neighbouring layers on the same thread
+    size_t threads = this->workers.size();
+    for (size_t slot = 0; slot < threads; ++slot) {
+        ThreadPoolWorker* worker = this->workers[slot];
+        pthread_mutex_lock(&worker->mutex);
+        for (size_t i = tasks.size() * slot / threads; i < tasks.size() * (slot+1) / threads; ++i)
+            worker->tasks.push_back(tasks[i]);
+        pthread_mutex_unlock(&worker->mutex);
+    }
+    ++this->batch;
+    pthread_cond_broadcast(&this->wake);
+    pthread_mutex_unlock(&this->mutex);
+    
+    this->work(0);
+    
+    pthread_mutex_lock(&this->mutex);
+    while (this->pending > 0)
+        pthread_cond_wait(&this->done, &this->mutex);
+    this->job = NULL;
+    this->graph = NULL;
+    this->waiting.swap(*waiting);
+    bool failed = this->failed;
+    std::string error = this->error;
+    this->failed = false;
+    this->error.clear();
+    pthread_mutex_unlock(&this->mutex);
+    
+    // exceptions can't cross the worker threads, so they are rethrown here
+    if (failed) throw std::runtime_error(error);
+}
+
+void*
+ThreadPool::thread_main(void* arg)
+{
+    ThreadPoolWorker* worker = (ThreadPoolWorker*)arg;
+    ThreadPool* pool = worker->pool;
+    unsigned long seen = 0;
+    
+    while (true) {
+        pthread_mutex_lock(&pool->mutex);
+        while (!pool->stopping && pool->batch == seen)
+            pthread_cond_wait(&pool->wake, &pool->mutex);
+        if (pool->stopping) {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+        seen = pool->batch;
+        pthread_mutex_unlock(&pool->mutex);
+    
+        pool->work(worker->slot);
+    }
+    return NULL;
+}
+
+void
+ThreadPool::work(size_t slot)
+{
+    while (true) {
+        size_t task;
+        if (!this->next_task(slot, &task)) {
+            if (this->wait_task()) continue;
+            return;
+        }
+        
+        pthread_mutex_lock(&this->mutex);
+        bool skip = this->failed;
+        pthread_mutex_unlock(&this->mutex);
+        
+        // tasks are only queued by dispatch() after setting job or graph,
+        // and the queue mutex orders that write before this read
+        std::string error;
+        bool failed = false;
+        if (!skip) {
+            try {
+                if (this->graph != NULL) {
+                    const ThreadPoolGraphNode &node = this->graph->nodes[task];
+                    node.job->run(node.task);
+                } else {
+                    this->job->run(task);
+                }
+            } catch (std::exception &e) {
+                failed = true;
+                error = e.what();
+            } catch (...) {
+                failed = true;
+                error = "unknown exception in thread pool task";
+            }
+        }
+        
+        // dependents are released even if the task failed or was skipped,
+        // so that they're skipped as well and the batch gets over
+        std::vector<size_t> ready;
+        pthread_mutex_lock(&this->mutex);
+        if (failed && !this->failed) {
+            this->failed = true;
+            this->error = error;
+        }
+        if (this->graph != NULL) {
+            const std::vector<size_t> &dependents = this->graph->nodes[task].dependents;
+            for (std::vector<size_t>::const_iterator it = dependents.begin(); it != dependents.end(); ++it) {
+                if (--this->waiting[*it] == 0) ready.push_back(*it);
+            }
+        }
+        if (--this->pending == 0) {
+            pthread_cond_broadcast(&this->done);
+            pthread_cond_broadcast(&this->ready);
+        }
+        pthread_mutex_unlock(&this->mutex);
+        
+        if (!ready.empty()) {
+            ThreadPoolWorker* worker = this->workers[slot];
+            pthread_mutex_lock(&worker->mutex);
+            for (std::vector<size_t>::const_reverse_iterator it = ready.rbegin(); it != ready.rend(); ++it)
+                worker->tasks.push_front(*it);
+            pthread_mutex_unlock(&worker->mutex);
+            
+            pthread_mutex_lock(&this->mutex);
+            pthread_cond_broadcast(&this->ready);
+            pthread_mutex_unlock(&this->mutex);
+        }
+    }
+}
+
+/* Called when no task is queued. Tasks of a plain batch are all queued at
+   once, so there's nothing left to do; graph tasks are queued as their
+   prerequisites complete, so wait for more of them until the batch is over.
+   Returns true if a task may be available. */
+bool
+ThreadPool::wait_task()
+{
+    pthread_mutex_lock(&this->mutex);
+    bool retval = false;
+    while (this->graph != NULL && this->pending > 0) {
+        if (this->has_task()) {
+            retval = true;
+            break;
+        }
+        pthread_cond_wait(&this->ready, &this->mutex);
+    }
+    pthread_mutex_unlock(&this->mutex);
+    return retval;
+}
+
+// whether any thread has a queued task, to be called with the pool mutex held
+bool
+ThreadPool::has_task()
+{
+    bool retval = false;
+    for (size_t i = 0; i < this->workers.size() && !retval; ++i) {
+        pthread_mutex_lock(&this->workers[i]->mutex);
+        retval = !this->workers[i]->tasks.empty();
+        pthread_mutex_unlock(&this->workers[i]->mutex);
+    }
+    return retval;
+}
+
+/* takes the next task of our own block, or steals the last one of the
+   block of another thread once ours is exhausted */
+bool
+ThreadPool::next_task(size_t slot, size_t* task)
+{
+    size_t threads = this->workers.size();
+    for (size_t i = 0; i < threads; ++i) {
+        ThreadPoolWorker* worker = this->workers[(slot + i) % threads];
+        pthread_mutex_lock(&worker->mutex);
+        bool found = !worker->tasks.empty();
+        if (found) {
+            if (i == 0) {
+                *task = worker->tasks.front();
+                worker->tasks.pop_front();
+            } else {
+                *task = worker->tasks.back();
+                worker->tasks.pop_back();
+            }
+        }
+        pthread_mutex_unlock(&worker->mutex);
+        if (found) return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,114 @@
+#ifndef slic3r_ThreadPool_hpp_
+#define slic3r_ThreadPool_hpp_
+
+#include <myinit.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+namespace Slic3r {
+
+/* A batch of independent tasks numbered 0..n-1. run() is called concurrently
+   from several threads, each task exactly once, so it must only touch the
+   data owned by its task. */
+class ThreadPoolJob
+{
+    public:
+    virtual ~ThreadPoolJob() {};
+    virtual void run(size_t task) = 0;
+};
+
+class ThreadPoolGraphNode
+{
+    public:
+    ThreadPoolJob* job;
+    size_t task;
+    size_t prerequisites;               // number of nodes this one depends on
+    std::vector<size_t> dependents;     // nodes depending on this one
+    
+    ThreadPoolGraphNode(ThreadPoolJob* _job, size_t _task)
+        : job(_job), task(_task), prerequisites(0) {};
+};
+
+/* Tasks of several jobs with dependencies between them. A task is started as
+   soon as all the tasks it depends on are completed, so for example a layer
+   can go through the next stage while the other layers are still in the
+   previous one, with no barrier between the stages. A task can only depend
+   on tasks added before it, which rules out cycles. */
+class ThreadPoolGraph
+{
+    public:
+    size_t add_task(ThreadPoolJob* job, size_t task);
+    void add_dependency(size_t node, size_t prerequisite);
+    size_t size() const;
+    
+    private:
+    friend class ThreadPool;
+    std::vector<ThreadPoolGraphNode> nodes;
+};
+
+class ThreadPool;
+
+class ThreadPoolWorker
+{
+    public:
+    ThreadPool* pool;
+    size_t slot;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    std::deque<size_t> tasks;           // guarded by mutex
+    
+    ThreadPoolWorker(ThreadPool* _pool, size_t _slot);
+    ~ThreadPoolWorker();
+};
+
+/* Persistent pool of native threads. The threads are started once and sleep
+   between batches, so dispatching a batch costs a wakeup instead of a thread
+   (or interpreter) creation. run() splits the tasks in contiguous blocks, one
+   per thread, and idle threads steal tasks from the others, so uneven layers
+   don't leave threads waiting. The calling thread works too, thus a pool of
+   size 1 starts no thread and runs everything inline. If a task throws, the
+   tasks not started yet are skipped and run() throws the first error once
+   the batch is over, in the calling thread. A graph is run the same way,
+   starting from the tasks with no prerequisites; a thread completing a task
+   queues the dependents it made ready in front of its own block, so a layer
+   tends to go through its stages on the same thread. */
+class ThreadPool
+{
+    public:
+    ThreadPool(size_t threads);
+    ~ThreadPool();
+    size_t size() const;
+    void run(ThreadPoolJob* job, size_t tasks);
+    void run(ThreadPoolGraph* graph);
+    
+    private:
+    std::vector<ThreadPoolWorker*> workers;  // slot 0 is the calling thread
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    ThreadPoolJob* job;
+    ThreadPoolGraph* graph;             // set instead of job when running a graph
+    std::vector<size_t> waiting;        // prerequisites of each graph node not completed yet
+    pthread_cond_t ready;               // graph tasks were queued or the batch is over
+    size_t pending;                     // tasks of the current batch not completed yet
+    unsigned long batch;                // incremented by every run()
+    bool stopping;
+    bool failed;                        // a task of the current batch threw
+    std::string error;                  // message of the first exception thrown
+    
+    ThreadPool(const ThreadPool &);
+    ThreadPool& operator=(const ThreadPool &);
+    static void* thread_main(void* arg);
+    void dispatch(ThreadPoolJob* job, ThreadPoolGraph* graph, std::vector<size_t>* waiting,
+        const std::vector<size_t> &tasks);
+    void work(size_t slot);
+    bool next_task(size_t slot, size_t* task);
+    bool wait_task();
+    bool has_task();
+};
+
+}
+
+#endif
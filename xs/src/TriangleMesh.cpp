@@ -11,6 +11,13 @@
 #include <algorithm>
 #include <math.h>
 #include <assert.h>
+#include <float.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
 
 #ifdef SLIC3R_DEBUG
 #include "SVG.hpp"
@@ -133,21 +140,22 @@ TriangleMesh::WriteOBJFile(char* output_file) {
 
 void TriangleMesh::scale(float factor)
 {
-    stl_scale(&(this->stl), factor);
+    std::vector<double> versor(3, factor);
+    this->scale(versor);
 }
 
 void TriangleMesh::scale(std::vector<double> versor)
 {
-    float fversor[3];
-    fversor[0] = versor[0];
-    fversor[1] = versor[1];
-    fversor[2] = versor[2];
-    stl_scale_versor(&this->stl, fversor);
+    TriangleMeshTransform transform;
+    transform.scale(versor[0], versor[1], versor[2]);
+    this->transform(transform, false);
 }
 
 void TriangleMesh::translate(float x, float y, float z)
 {
-    stl_translate_relative(&(this->stl), x, y, z);
+    TriangleMeshTransform transform;
+    transform.translate(x, y, z);
+    this->transform(transform, false);
 }
 
 void TriangleMesh::align_to_origin()
@@ -161,9 +169,45 @@ void TriangleMesh::align_to_origin()
 
 void TriangleMesh::rotate(double angle, Point* center)
 {
-    this->translate(-center->x, -center->y, 0);
-    stl_rotate_z(&(this->stl), (float)angle);
-    this->translate(+center->x, +center->y, 0);
+    TriangleMeshTransform transform;
+    transform.translate(-center->x, -center->y, 0);
+    transform.rotate_z(angle);
+    transform.translate(+center->x, +center->y, 0);
+    this->transform(transform);
+}
+
+/* Transforms all vertices in a single pass, updating the size and volume
+   stats and the shared vertices (if any) instead of invalidating them. Facet normals are
+   transformed by the linear part and renormalized, which is only correct for
+   rotations and uniform scaling; pass normals = false to leave them alone. */
+void
+TriangleMesh::transform(const TriangleMeshTransform &transform, bool normals)
+{
+    if (this->stl.stats.number_of_facets == 0) return;
+    
+    BoundingBoxf3 bb;
+    transform.apply(this->stl.facet_start, this->stl.stats.number_of_facets, normals, &bb);
+    if (this->stl.v_shared != NULL)
+        transform.apply(this->stl.v_shared, this->stl.stats.shared_vertices);
+    
+    this->stl.stats.min.x = bb.min.x;
+    this->stl.stats.min.y = bb.min.y;
+    this->stl.stats.min.z = bb.min.z;
+    this->stl.stats.max.x = bb.max.x;
+    this->stl.stats.max.y = bb.max.y;
+    this->stl.stats.max.z = bb.max.z;
+    this->stl.stats.size.x = this->stl.stats.max.x - this->stl.stats.min.x;
+    this->stl.stats.size.y = this->stl.stats.max.y - this->stl.stats.min.y;
+    this->stl.stats.size.z = this->stl.stats.max.z - this->stl.stats.min.z;
+    this->stl.stats.bounding_diameter = sqrt(
+        this->stl.stats.size.x * this->stl.stats.size.x +
+        this->stl.stats.size.y * this->stl.stats.size.y +
+        this->stl.stats.size.z * this->stl.stats.size.z
+    );
+    
+    // scale volume
+    if (this->stl.stats.volume > 0.0)
+        this->stl.stats.volume *= transform.determinant();
 }
 
 TriangleMeshPtrs
@@ -293,6 +337,576 @@ TriangleMesh::require_shared_vertices()
     if (this->stl.v_shared == NULL) stl_generate_shared_vertices(&(this->stl));
 }
 
+IndexedTriangleSet::IndexedTriangleSet(TriangleMesh* mesh)
+{
+    mesh->require_shared_vertices();
+    
+    const int vertices = mesh->stl.stats.shared_vertices;
+    this->x.resize(vertices);
+    this->y.resize(vertices);
+    this->z.resize(vertices);
+    for (int i = 0; i < vertices; i++) {
+        this->x[i] = mesh->stl.v_shared[i].x;
+        this->y[i] = mesh->stl.v_shared[i].y;
+        this->z[i] = mesh->stl.v_shared[i].z;
+    }
+    
+    const int facets = mesh->stl.stats.number_of_facets;
+    this->indices.resize(facets * 3);
+    for (int facet_idx = 0; facet_idx < facets; facet_idx++) {
+        for (int j = 0; j <= 2; j++)
+            this->indices[facet_idx*3 + j] = mesh->stl.v_indices[facet_idx].vertex[j];
+    }
+}
+
+size_t
+IndexedTriangleSet::facets_count() const
+{
+    return this->indices.size() / 3;
+}
+
+size_t
+IndexedTriangleSet::vertices_count() const
+{
+    return this->x.size();
+}
+
+void
+IndexedTriangleSet::scale(double factor)
+{
+    TriangleMeshTransform transform;
+    transform.scale(factor, factor, factor);
+    this->transform(transform);
+}
+
+void
+IndexedTriangleSet::translate(float x, float y, float z)
+{
+    TriangleMeshTransform transform;
+    transform.translate(x, y, z);
+    this->transform(transform);
+}
+
+/* angle is in degrees, like TriangleMesh::rotate() */
+void
+IndexedTriangleSet::rotate_z(double angle)
+{
+    TriangleMeshTransform transform;
+    transform.rotate_z(angle);
+    this->transform(transform);
+}
+
+void
+IndexedTriangleSet::transform(const TriangleMeshTransform &transform, BoundingBoxf3* bb)
+{
+    if (this->x.empty()) return;
+    transform.apply(&this->x.front(), &this->y.front(), &this->z.front(), this->x.size(), bb);
+}
+
+void
+IndexedTriangleSet::facet_z_range(size_t facet_idx, float* min_z, float* max_z) const
+{
+    const float z0 = this->z[ this->indices[facet_idx*3]     ];
+    const float z1 = this->z[ this->indices[facet_idx*3 + 1] ];
+    const float z2 = this->z[ this->indices[facet_idx*3 + 2] ];
+    *min_z = fminf(z0, fminf(z1, z2));
+    *max_z = fmaxf(z0, fmaxf(z1, z2));
+}
+
+void
+IndexedTriangleSet::facet_normal(size_t facet_idx, stl_normal* normal) const
+{
+    const int a = this->indices[facet_idx*3];
+    const int b = this->indices[facet_idx*3 + 1];
+    const int c = this->indices[facet_idx*3 + 2];
+    const float ux = this->x[b] - this->x[a], uy = this->y[b] - this->y[a], uz = this->z[b] - this->z[a];
+    const float vx = this->x[c] - this->x[a], vy = this->y[c] - this->y[a], vz = this->z[c] - this->z[a];
+    normal->x = uy * vz - uz * vy;
+    normal->y = uz * vx - ux * vz;
+    normal->z = ux * vy - uy * vx;
+    
+    const float length = sqrt(normal->x * normal->x + normal->y * normal->y + normal->z * normal->z);
+    if (length > 0) {
+        normal->x /= length;
+        normal->y /= length;
+        normal->z /= length;
+    }
+}
+
+void
+IndexedTriangleSet::bounding_box(BoundingBoxf3* bb) const
+{
+    if (this->x.empty()) return;
+    bb->min.x = bb->max.x = this->x[0];
+    bb->min.y = bb->max.y = this->y[0];
+    bb->min.z = bb->max.z = this->z[0];
+    for (size_t i = 1; i < this->x.size(); i++) {
+        bb->min.x = std::min<coordf_t>(bb->min.x, this->x[i]);
+        bb->min.y = std::min<coordf_t>(bb->min.y, this->y[i]);
+        bb->min.z = std::min<coordf_t>(bb->min.z, this->z[i]);
+        bb->max.x = std::max<coordf_t>(bb->max.x, this->x[i]);
+        bb->max.y = std::max<coordf_t>(bb->max.y, this->y[i]);
+        bb->max.z = std::max<coordf_t>(bb->max.z, this->z[i]);
+    }
+}
+
+TriangleMeshTransform::TriangleMeshTransform()
+{
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            this->matrix[i][j] = (i == j) ? 1 : 0;
+}
+
+void
+TriangleMeshTransform::scale(double x, double y, double z)
+{
+    const double m[3][4] = {
+        { x, 0, 0, 0 },
+        { 0, y, 0, 0 },
+        { 0, 0, z, 0 },
+    };
+    this->append(m);
+}
+
+void
+TriangleMeshTransform::translate(double x, double y, double z)
+{
+    const double m[3][4] = {
+        { 1, 0, 0, x },
+        { 0, 1, 0, y },
+        { 0, 0, 1, z },
+    };
+    this->append(m);
+}
+
+/* angle is in degrees, like TriangleMesh::rotate() */
+void
+TriangleMeshTransform::rotate_z(double angle)
+{
+    const double c = cos(angle * PI / 180.0);
+    const double s = sin(angle * PI / 180.0);
+    const double m[3][4] = {
+        { c, -s, 0, 0 },
+        { s,  c, 0, 0 },
+        { 0,  0, 1, 0 },
+    };
+    this->append(m);
+}
+
+double
+TriangleMeshTransform::determinant() const
+{
+    const double (&m)[3][4] = this->matrix;
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+         - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+         + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+// this = m * this
+void
+TriangleMeshTransform::append(const double m[3][4])
+{
+    double result[3][4];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            result[i][j] = m[i][0] * this->matrix[0][j]
+                         + m[i][1] * this->matrix[1][j]
+                         + m[i][2] * this->matrix[2][j];
+        }
+        result[i][3] += m[i][3];
+    }
+    std::copy(&result[0][0], &result[0][0] + 12, &this->matrix[0][0]);
+}
+
+/* All code paths evaluate ((x*m0 + y*m1) + z*m2) + m3 in single precision,
+   so a pure scaling or translation gives the same floats as the scalar
+   admesh loops did, whichever path handles a given vertex. */
+void
+TriangleMeshTransform::apply(float* x, float* y, float* z, size_t count, BoundingBoxf3* bb) const
+{
+    float m[3][4];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            m[i][j] = this->matrix[i][j];
+    
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    size_t i = 0;
+    
+    #ifdef __AVX__
+    if (count >= 8) {
+        __m256 mm[3][4];
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 4; c++)
+                mm[r][c] = _mm256_set1_ps(m[r][c]);
+        __m256 vmin[3], vmax[3];
+        for (int r = 0; r < 3; r++) {
+            vmin[r] = _mm256_set1_ps(FLT_MAX);
+            vmax[r] = _mm256_set1_ps(-FLT_MAX);
+        }
+        for (; i + 8 <= count; i += 8) {
+            const __m256 px = _mm256_loadu_ps(x + i);
+            const __m256 py = _mm256_loadu_ps(y + i);
+            const __m256 pz = _mm256_loadu_ps(z + i);
+            __m256 res[3];
+            for (int r = 0; r < 3; r++) {
+                res[r] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                    _mm256_mul_ps(px, mm[r][0]), _mm256_mul_ps(py, mm[r][1])),
+                    _mm256_mul_ps(pz, mm[r][2])), mm[r][3]);
+                vmin[r] = _mm256_min_ps(vmin[r], res[r]);
+                vmax[r] = _mm256_max_ps(vmax[r], res[r]);
+            }
+            _mm256_storeu_ps(x + i, res[0]);
+            _mm256_storeu_ps(y + i, res[1]);
+            _mm256_storeu_ps(z + i, res[2]);
+        }
+        float lanes[8];
+        for (int r = 0; r < 3; r++) {
+            _mm256_storeu_ps(lanes, vmin[r]);
+            for (int k = 0; k < 8; k++) min[r] = std::min(min[r], lanes[k]);
+            _mm256_storeu_ps(lanes, vmax[r]);
+            for (int k = 0; k < 8; k++) max[r] = std::max(max[r], lanes[k]);
+        }
+    }
+    #endif
+    
+    #ifdef __SSE__
+    if (count - i >= 4) {
+        __m128 mm[3][4];
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 4; c++)
+                mm[r][c] = _mm_set1_ps(m[r][c]);
+        __m128 vmin[3], vmax[3];
+        for (int r = 0; r < 3; r++) {
+            vmin[r] = _mm_set1_ps(FLT_MAX);
+            vmax[r] = _mm_set1_ps(-FLT_MAX);
+        }
+        for (; i + 4 <= count; i += 4) {
+            const __m128 px = _mm_loadu_ps(x + i);
+            const __m128 py = _mm_loadu_ps(y + i);
+            const __m128 pz = _mm_loadu_ps(z + i);
+            __m128 res[3];
+            for (int r = 0; r < 3; r++) {
+                res[r] = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(px, mm[r][0]), _mm_mul_ps(py, mm[r][1])),
+                    _mm_mul_ps(pz, mm[r][2])), mm[r][3]);
+                vmin[r] = _mm_min_ps(vmin[r], res[r]);
+                vmax[r] = _mm_max_ps(vmax[r], res[r]);
+            }
+            _mm_storeu_ps(x + i, res[0]);
+            _mm_storeu_ps(y + i, res[1]);
+            _mm_storeu_ps(z + i, res[2]);
+        }
+        float lanes[4];
+        for (int r = 0; r < 3; r++) {
+            _mm_storeu_ps(lanes, vmin[r]);
+            for (int k = 0; k < 4; k++) min[r] = std::min(min[r], lanes[k]);
+            _mm_storeu_ps(lanes, vmax[r]);
+            for (int k = 0; k < 4; k++) max[r] = std::max(max[r], lanes[k]);
+        }
+    }
+    #endif
+    
+    // scalar fallback and remainder
+    for (; i < count; i++) {
+        const float px = x[i], py = y[i], pz = z[i];
+        float res[3];
+        for (int r = 0; r < 3; r++) {
+            res[r] = px * m[r][0] + py * m[r][1] + pz * m[r][2] + m[r][3];
+            min[r] = std::min(min[r], res[r]);
+            max[r] = std::max(max[r], res[r]);
+        }
+        x[i] = res[0];
+        y[i] = res[1];
+        z[i] = res[2];
+    }
+    
+    if (bb != NULL && count > 0) {
+        bb->min.x = min[0]; bb->min.y = min[1]; bb->min.z = min[2];
+        bb->max.x = max[0]; bb->max.y = max[1]; bb->max.z = max[2];
+    }
+}
+
+/* Interleaved (x,y,z) vertices are transformed one per SSE register: each
+   coordinate is broadcast and multiplied by a matrix column. Loads and
+   stores touch exactly three floats, so this works on the packed vertices
+   of stl_facet as well as on the shared vertex table. */
+#ifdef __SSE__
+static inline void
+transform_vertex_sse(stl_vertex* v, const __m128* columns, __m128* vmin, __m128* vmax)
+{
+    const __m128 p = _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&v->x), _mm_load_ss(&v->z));
+    const __m128 res = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+        _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(0,0,0,0)), columns[0]),
+        _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(1,1,1,1)), columns[1])),
+        _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2,2,2,2)), columns[2])),
+        columns[3]);
+    *vmin = _mm_min_ps(*vmin, res);
+    *vmax = _mm_max_ps(*vmax, res);
+    _mm_storel_pi((__m64*)&v->x, res);
+    _mm_store_ss(&v->z, _mm_movehl_ps(res, res));
+}
+#endif
+
+static inline void
+transform_vertex(stl_vertex* v, const float m[3][4], float* min, float* max)
+{
+    const float px = v->x, py = v->y, pz = v->z;
+    v->x = px * m[0][0] + py * m[0][1] + pz * m[0][2] + m[0][3];
+    v->y = px * m[1][0] + py * m[1][1] + pz * m[1][2] + m[1][3];
+    v->z = px * m[2][0] + py * m[2][1] + pz * m[2][2] + m[2][3];
+    min[0] = std::min(min[0], v->x); max[0] = std::max(max[0], v->x);
+    min[1] = std::min(min[1], v->y); max[1] = std::max(max[1], v->y);
+    min[2] = std::min(min[2], v->z); max[2] = std::max(max[2], v->z);
+}
+
+void
+TriangleMeshTransform::apply(stl_vertex* vertices, size_t count, BoundingBoxf3* bb) const
+{
+    float m[3][4];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            m[i][j] = this->matrix[i][j];
+    
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    
+    #ifdef __SSE__
+    __m128 columns[4];
+    for (int c = 0; c < 4; c++) columns[c] = _mm_setr_ps(m[0][c], m[1][c], m[2][c], 0);
+    __m128 vmin = _mm_set1_ps(FLT_MAX);
+    __m128 vmax = _mm_set1_ps(-FLT_MAX);
+    for (size_t i = 0; i < count; i++)
+        transform_vertex_sse(&vertices[i], columns, &vmin, &vmax);
+    {
+        float lanes[4];
+        _mm_storeu_ps(lanes, vmin);
+        std::copy(lanes, lanes + 3, min);
+        _mm_storeu_ps(lanes, vmax);
+        std::copy(lanes, lanes + 3, max);
+    }
+    #else
+    for (size_t i = 0; i < count; i++)
+        transform_vertex(&vertices[i], m, min, max);
+    #endif
+    
+    if (bb != NULL && count > 0) {
+        bb->min.x = min[0]; bb->min.y = min[1]; bb->min.z = min[2];
+        bb->max.x = max[0]; bb->max.y = max[1]; bb->max.z = max[2];
+    }
+}
+
+void
+TriangleMeshTransform::apply(stl_facet* facets, size_t count, bool normals, BoundingBoxf3* bb) const
+{
+    float m[3][4];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            m[i][j] = this->matrix[i][j];
+    
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    
+    #ifdef __SSE__
+    __m128 columns[4];
+    for (int c = 0; c < 4; c++) columns[c] = _mm_setr_ps(m[0][c], m[1][c], m[2][c], 0);
+    __m128 vmin = _mm_set1_ps(FLT_MAX);
+    __m128 vmax = _mm_set1_ps(-FLT_MAX);
+    #endif
+    
+    for (size_t i = 0; i < count; i++) {
+        stl_facet* facet = &facets[i];
+        for (int j = 0; j <= 2; j++) {
+            #ifdef __SSE__
+            transform_vertex_sse(&facet->vertex[j], columns, &vmin, &vmax);
+            #else
+            transform_vertex(&facet->vertex[j], m, min, max);
+            #endif
+        }
+        
+        if (normals) {
+            stl_normal* n = &facet->normal;
+            const float nx = n->x, ny = n->y, nz = n->z;
+            n->x = nx * m[0][0] + ny * m[0][1] + nz * m[0][2];
+            n->y = nx * m[1][0] + ny * m[1][1] + nz * m[1][2];
+            n->z = nx * m[2][0] + ny * m[2][1] + nz * m[2][2];
+            const float length = sqrt(n->x * n->x + n->y * n->y + n->z * n->z);
+            if (length > 0) {
+                n->x /= length;
+                n->y /= length;
+                n->z /= length;
+            }
+        }
+    }
+    
+    #ifdef __SSE__
+    {
+        float lanes[4];
+        _mm_storeu_ps(lanes, vmin);
+        std::copy(lanes, lanes + 3, min);
+        _mm_storeu_ps(lanes, vmax);
+        std::copy(lanes, lanes + 3, max);
+    }
+    #endif
+    
+    if (bb != NULL && count > 0) {
+        bb->min.x = min[0]; bb->min.y = min[1]; bb->min.z = min[2];
+        bb->max.x = max[0]; bb->max.y = max[1]; bb->max.z = max[2];
+    }
+}
+
+void
+TriangleMeshInstance::transform(Polygon* polygon) const
+{
+    Point origin(0, 0);
+    polygon->rotate(this->rotation * PI / 180.0, &origin);
+    polygon->scale(this->scaling_factor);
+    polygon->translate(scale_(this->offset.x), scale_(this->offset.y));
+}
+
+void
+TriangleMeshInstance::transform(ExPolygon* expolygon) const
+{
+    Point origin(0, 0);
+    expolygon->rotate(this->rotation * PI / 180.0, &origin);
+    expolygon->scale(this->scaling_factor);
+    expolygon->translate(scale_(this->offset.x), scale_(this->offset.y));
+}
+
+TriangleMeshView::TriangleMeshView(bool _with_projection)
+    : with_projection(_with_projection), empty(true), min_z(0), max_z(0)
+{}
+
+void
+TriangleMeshView::add_mesh(TriangleMesh* mesh)
+{
+    if (mesh->stl.stats.number_of_facets == 0) return;
+    
+    Polygon mesh_hull;
+    mesh->convex_hull(&mesh_hull);
+    Points points = this->hull.points;
+    points.insert(points.end(), mesh_hull.points.begin(), mesh_hull.points.end());
+    Slic3r::Geometry::convex_hull(points, &this->hull);
+    
+    BoundingBoxf3 bb;
+    mesh->bounding_box(&bb);
+    this->min_z = this->empty ? bb.min.z : std::min(this->min_z, bb.min.z);
+    this->max_z = this->empty ? bb.max.z : std::max(this->max_z, bb.max.z);
+    this->empty = false;
+    
+    if (this->with_projection) {
+        ExPolygons mesh_projection;
+        mesh->horizontal_projection(mesh_projection);
+        Polygons pp;
+        for (ExPolygons::const_iterator it = this->projection.begin(); it != this->projection.end(); ++it) {
+            Polygons p = *it;
+            pp.insert(pp.end(), p.begin(), p.end());
+        }
+        for (ExPolygons::const_iterator it = mesh_projection.begin(); it != mesh_projection.end(); ++it) {
+            Polygons p = *it;
+            pp.insert(pp.end(), p.begin(), p.end());
+        }
+        union_(pp, this->projection);
+    }
+}
+
+void
+TriangleMeshView::add_instance(const TriangleMeshInstance &instance)
+{
+    this->instances.push_back(instance);
+}
+
+void
+TriangleMeshView::clear_instances()
+{
+    this->instances.clear();
+}
+
+void
+TriangleMeshView::raw_convex_hull(Polygon* hull) const
+{
+    *hull = this->hull;
+}
+
+void
+TriangleMeshView::raw_bounding_box(BoundingBoxf3* bb) const
+{
+    *bb = BoundingBoxf3();
+    if (this->empty) return;
+    BoundingBox bb2d(this->hull.points);
+    bb->min.x = unscale(bb2d.min.x);
+    bb->min.y = unscale(bb2d.min.y);
+    bb->max.x = unscale(bb2d.max.x);
+    bb->max.y = unscale(bb2d.max.y);
+    bb->min.z = this->min_z;
+    bb->max.z = this->max_z;
+}
+
+void
+TriangleMeshView::instance_convex_hull(size_t instance_idx, Polygon* hull) const
+{
+    *hull = this->hull;
+    this->instances.at(instance_idx).transform(hull);
+}
+
+/* The XY extents of a transformed mesh are the ones of its transformed convex
+   hull, since rotation and scaling preserve convexity. */
+void
+TriangleMeshView::instance_bounding_box(size_t instance_idx, BoundingBoxf3* bb) const
+{
+    const TriangleMeshInstance &instance = this->instances.at(instance_idx);
+    if (this->empty) {
+        *bb = BoundingBoxf3();
+        return;
+    }
+    Polygon hull;
+    this->instance_convex_hull(instance_idx, &hull);
+    BoundingBox bb2d(hull.points);
+    bb->min.x = unscale(bb2d.min.x);
+    bb->min.y = unscale(bb2d.min.y);
+    bb->max.x = unscale(bb2d.max.x);
+    bb->max.y = unscale(bb2d.max.y);
+    bb->min.z = this->min_z * instance.scaling_factor;
+    bb->max.z = this->max_z * instance.scaling_factor;
+}
+
+void
+TriangleMeshView::instance_projection(size_t instance_idx, ExPolygons* projection) const
+{
+    const TriangleMeshInstance &instance = this->instances.at(instance_idx);
+    *projection = this->projection;
+    for (ExPolygons::iterator it = projection->begin(); it != projection->end(); ++it)
+        instance.transform(&*it);
+}
+
+void
+TriangleMeshView::convex_hull(Polygon* hull) const
+{
+    Points points;
+    for (size_t i = 0; i < this->instances.size(); ++i) {
+        Polygon instance_hull;
+        this->instance_convex_hull(i, &instance_hull);
+        points.insert(points.end(), instance_hull.points.begin(), instance_hull.points.end());
+    }
+    hull->points.clear();
+    if (!points.empty()) Slic3r::Geometry::convex_hull(points, hull);
+}
+
+void
+TriangleMeshView::bounding_box(BoundingBoxf3* bb) const
+{
+    *bb = BoundingBoxf3();
+    for (size_t i = 0; i < this->instances.size(); ++i) {
+        BoundingBoxf3 instance_bb;
+        this->instance_bounding_box(i, &instance_bb);
+        if (i == 0) {
+            *bb = instance_bb;
+        } else {
+            bb->merge(instance_bb);
+        }
+    }
+}
+
 #ifdef SLIC3RXS
 SV*
 TriangleMesh::to_SV() {
@@ -368,37 +982,35 @@ TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<Polygons>* la
     
     std::vector<IntersectionLines> lines(z.size());
     
-    for (int facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; facet_idx++) {
-        stl_facet* facet = &this->mesh->stl.facet_start[facet_idx];
-        
+    // the slicing planes are compared against our scaled vertices
+    std::vector<float> scaled_z(z.size());
+    for (size_t i = 0; i < z.size(); i++) scaled_z[i] = z[i] / SCALING_FACTOR;
+    
+    const int facets_count = this->its.facets_count();
+    for (int facet_idx = 0; facet_idx < facets_count; facet_idx++) {
         // find facet extents
-        float min_z = fminf(facet->vertex[0].z, fminf(facet->vertex[1].z, facet->vertex[2].z));
-        float max_z = fmaxf(facet->vertex[0].z, fmaxf(facet->vertex[1].z, facet->vertex[2].z));
+        float min_z, max_z;
+        this->its.facet_z_range(facet_idx, &min_z, &max_z);
         
         #ifdef SLIC3R_DEBUG
-        printf("\n==> FACET %d (%f,%f,%f - %f,%f,%f - %f,%f,%f):\n", facet_idx,
-            facet->vertex[0].x, facet->vertex[0].y, facet->vertex[0].z,
-            facet->vertex[1].x, facet->vertex[1].y, facet->vertex[1].z,
-            facet->vertex[2].x, facet->vertex[2].y, facet->vertex[2].z);
+        printf("\n==> FACET %d:\n", facet_idx);
         printf("z: min = %.2f, max = %.2f\n", min_z, max_z);
         #endif
         
         // find layer extents
         std::vector<float>::const_iterator min_layer, max_layer;
-        min_layer = std::lower_bound(z.begin(), z.end(), min_z); // first layer whose slice_z is >= min_z
-        max_layer = std::upper_bound(z.begin() + (min_layer - z.begin()), z.end(), max_z) - 1; // last layer whose slice_z is <= max_z
+        min_layer = std::lower_bound(scaled_z.begin(), scaled_z.end(), min_z); // first layer whose slice_z is >= min_z
+        max_layer = std::upper_bound(scaled_z.begin() + (min_layer - scaled_z.begin()), scaled_z.end(), max_z) - 1; // last layer whose slice_z is <= max_z
         #ifdef SLIC3R_DEBUG
-        printf("layers: min = %d, max = %d\n", (int)(min_layer - z.begin()), (int)(max_layer - z.begin()));
+        printf("layers: min = %d, max = %d\n", (int)(min_layer - scaled_z.begin()), (int)(max_layer - scaled_z.begin()));
         #endif
         
         for (std::vector<float>::const_iterator it = min_layer; it != max_layer + 1; ++it) {
-            std::vector<float>::size_type layer_idx = it - z.begin();
-            this->slice_facet(*it / SCALING_FACTOR, *facet, facet_idx, min_z, max_z, &lines[layer_idx]);
+            std::vector<float>::size_type layer_idx = it - scaled_z.begin();
+            this->slice_facet(*it, facet_idx, min_z, max_z, &lines[layer_idx]);
         }
     }
     
-    // v_scaled_shared could be freed here
-    
     // build loops
     layers->resize(z.size());
     for (std::vector<IntersectionLines>::iterator it = lines.begin(); it != lines.end(); ++it) {
@@ -428,52 +1040,51 @@ TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<ExPolygons>*
 }
 
 void
-TriangleMeshSlicer::slice_facet(float slice_z, const stl_facet &facet, const int &facet_idx, const float &min_z, const float &max_z, std::vector<IntersectionLine>* lines) const
+TriangleMeshSlicer::slice_facet(float slice_z, const int &facet_idx, const float &min_z, const float &max_z, std::vector<IntersectionLine>* lines) const
 {
     std::vector<IntersectionPoint> points;
     std::vector< std::vector<IntersectionPoint>::size_type > points_on_layer;
     bool found_horizontal_edge = false;
     
+    const int* facet = &this->its.indices[facet_idx*3];
+    const std::vector<float> &vx = this->its.x;
+    const std::vector<float> &vy = this->its.y;
+    const std::vector<float> &vz = this->its.z;
+    
     /* reorder vertices so that the first one is the one with lowest Z
        this is needed to get all intersection lines in a consistent order
        (external on the right of the line) */
     int i = 0;
-    if (facet.vertex[1].z == min_z) {
+    if (vz[facet[1]] == min_z) {
         // vertex 1 has lowest Z
         i = 1;
-    } else if (facet.vertex[2].z == min_z) {
+    } else if (vz[facet[2]] == min_z) {
         // vertex 2 has lowest Z
         i = 2;
     }
     for (int j = i; (j-i) < 3; j++) {  // loop through facet edges
-        int edge_id = this->facets_edges[facet_idx][j % 3];
-        int a_id = this->mesh->stl.v_indices[facet_idx].vertex[j % 3];
-        int b_id = this->mesh->stl.v_indices[facet_idx].vertex[(j+1) % 3];
-        stl_vertex* a = &this->v_scaled_shared[a_id];
-        stl_vertex* b = &this->v_scaled_shared[b_id];
+        int edge_id = this->facets_edges[facet_idx*3 + j % 3];
+        int a_id = facet[j % 3];
+        int b_id = facet[(j+1) % 3];
         
-        if (a->z == b->z && a->z == slice_z) {
+        if (vz[a_id] == vz[b_id] && vz[a_id] == slice_z) {
             // edge is horizontal and belongs to the current layer
             
             /* We assume that this method is never being called for horizontal
                facets, so no other edge is going to be on this layer. */
-            stl_vertex* v0 = &this->v_scaled_shared[ this->mesh->stl.v_indices[facet_idx].vertex[0] ];
-            stl_vertex* v1 = &this->v_scaled_shared[ this->mesh->stl.v_indices[facet_idx].vertex[1] ];
-            stl_vertex* v2 = &this->v_scaled_shared[ this->mesh->stl.v_indices[facet_idx].vertex[2] ];
             IntersectionLine line;
             if (min_z == max_z) {
                 line.edge_type = feHorizontal;
-            } else if (v0->z < slice_z || v1->z < slice_z || v2->z < slice_z) {
+            } else if (vz[facet[0]] < slice_z || vz[facet[1]] < slice_z || vz[facet[2]] < slice_z) {
                 line.edge_type = feTop;
-                std::swap(a, b);
                 std::swap(a_id, b_id);
             } else {
                 line.edge_type = feBottom;
             }
-            line.a.x    = a->x;
-            line.a.y    = a->y;
-            line.b.x    = b->x;
-            line.b.y    = b->y;
+            line.a.x    = vx[a_id];
+            line.a.y    = vy[a_id];
+            line.b.x    = vx[b_id];
+            line.b.y    = vy[b_id];
             line.a_id   = a_id;
             line.b_id   = b_id;
             lines->push_back(line);
@@ -484,26 +1095,26 @@ TriangleMeshSlicer::slice_facet(float slice_z, const stl_facet &facet, const int
             // because we won't find anything interesting
             
             if (line.edge_type != feHorizontal) return;
-        } else if (a->z == slice_z) {
+        } else if (vz[a_id] == slice_z) {
             IntersectionPoint point;
-            point.x         = a->x;
-            point.y         = a->y;
+            point.x         = vx[a_id];
+            point.y         = vy[a_id];
             point.point_id  = a_id;
             points.push_back(point);
             points_on_layer.push_back(points.size()-1);
-        } else if (b->z == slice_z) {
+        } else if (vz[b_id] == slice_z) {
             IntersectionPoint point;
-            point.x         = b->x;
-            point.y         = b->y;
+            point.x         = vx[b_id];
+            point.y         = vy[b_id];
             point.point_id  = b_id;
             points.push_back(point);
             points_on_layer.push_back(points.size()-1);
-        } else if ((a->z < slice_z && b->z > slice_z) || (b->z < slice_z && a->z > slice_z)) {
+        } else if ((vz[a_id] < slice_z && vz[b_id] > slice_z) || (vz[b_id] < slice_z && vz[a_id] > slice_z)) {
             // edge intersects the current layer; calculate intersection
             
             IntersectionPoint point;
-            point.x         = b->x + (a->x - b->x) * (slice_z - b->z) / (a->z - b->z);
-            point.y         = b->y + (a->y - b->y) * (slice_z - b->z) / (a->z - b->z);
+            point.x         = vx[b_id] + (vx[a_id] - vx[b_id]) * (slice_z - vz[b_id]) / (vz[a_id] - vz[b_id]);
+            point.y         = vy[b_id] + (vy[a_id] - vy[b_id]) * (slice_z - vz[b_id]) / (vz[a_id] - vz[b_id]);
             point.edge_id   = edge_id;
             points.push_back(point);
         }
@@ -765,7 +1376,11 @@ TriangleMeshSlicer::cut(float z, TriangleMesh* upper, TriangleMesh* lower)
         float max_z = fmaxf(facet->vertex[0].z, fmaxf(facet->vertex[1].z, facet->vertex[2].z));
         
         // intersect facet with cutting plane
-        this->slice_facet(scaled_z, *facet, facet_idx, min_z, max_z, &lines);
+        {
+            float scaled_min_z, scaled_max_z;
+            this->its.facet_z_range(facet_idx, &scaled_min_z, &scaled_max_z);
+            this->slice_facet(scaled_z, facet_idx, scaled_min_z, scaled_max_z, &lines);
+        }
         
         if (min_z > z || (min_z == z && max_z > min_z)) {
             // facet is above the cut plane but does not belong to it
@@ -841,15 +1456,14 @@ TriangleMeshSlicer::cut(float z, TriangleMesh* upper, TriangleMesh* lower)
     */
 }
 
-TriangleMeshSlicer::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh), v_scaled_shared(NULL)
+TriangleMeshSlicer::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh), its(_mesh)
 {
     // build a table to map a facet_idx to its three edge indices
-    this->mesh->require_shared_vertices();
     typedef std::pair<int,int>              t_edge;
     typedef std::vector<t_edge>             t_edges;  // edge_idx => a_id,b_id
     typedef std::map<t_edge,int>            t_edges_map;  // a_id,b_id => edge_idx
     
-    this->facets_edges.resize(this->mesh->stl.stats.number_of_facets);
+    this->facets_edges.resize(this->its.indices.size());
     
     {
         t_edges edges;
@@ -857,10 +1471,9 @@ TriangleMeshSlicer::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh), v_sca
         edges.reserve(this->mesh->stl.stats.number_of_facets * 3);  // number of edges = number of facets * 3
         t_edges_map edges_map;
         for (int facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; facet_idx++) {
-            this->facets_edges[facet_idx].resize(3);
             for (int i = 0; i <= 2; i++) {
-                int a_id = this->mesh->stl.v_indices[facet_idx].vertex[i];
-                int b_id = this->mesh->stl.v_indices[facet_idx].vertex[(i+1) % 3];
+                int a_id = this->its.indices[facet_idx*3 + i];
+                int b_id = this->its.indices[facet_idx*3 + (i+1) % 3];
                 
                 int edge_idx;
                 t_edges_map::const_iterator my_edge = edges_map.find(std::make_pair(b_id,a_id));
@@ -881,7 +1494,7 @@ TriangleMeshSlicer::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh), v_sca
                         edges_map[ edges[edge_idx] ] = edge_idx;
                     }
                 }
-                this->facets_edges[facet_idx][i] = edge_idx;
+                this->facets_edges[facet_idx*3 + i] = edge_idx;
                 
                 #ifdef SLIC3R_DEBUG
                 printf("  [facet %d, edge %d] a_id = %d, b_id = %d   --> edge %d\n", facet_idx, i, a_id, b_id, edge_idx);
@@ -890,19 +1503,8 @@ TriangleMeshSlicer::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh), v_sca
         }
     }
     
-    // clone shared vertices coordinates and scale them
-    this->v_scaled_shared = (stl_vertex*)calloc(this->mesh->stl.stats.shared_vertices, sizeof(stl_vertex));
-    std::copy(this->mesh->stl.v_shared, this->mesh->stl.v_shared + this->mesh->stl.stats.shared_vertices, this->v_scaled_shared);
-    for (int i = 0; i < this->mesh->stl.stats.shared_vertices; i++) {
-        this->v_scaled_shared[i].x /= SCALING_FACTOR;
-        this->v_scaled_shared[i].y /= SCALING_FACTOR;
-        this->v_scaled_shared[i].z /= SCALING_FACTOR;
-    }
-}
-
-TriangleMeshSlicer::~TriangleMeshSlicer()
-{
-    if (this->v_scaled_shared != NULL) free(this->v_scaled_shared);
+    // scale vertices coordinates
+    this->its.scale(1 / SCALING_FACTOR);
 }
 
 }
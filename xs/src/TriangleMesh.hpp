@@ -13,6 +13,8 @@ namespace Slic3r {
 
 class TriangleMesh;
 class TriangleMeshSlicer;
+class IndexedTriangleSet;
+class TriangleMeshTransform;
 typedef std::vector<TriangleMesh*> TriangleMeshPtrs;
 
 class TriangleMesh
@@ -31,6 +33,7 @@ class TriangleMesh
     void translate(float x, float y, float z);
     void align_to_origin();
     void rotate(double angle, Point* center);
+    void transform(const TriangleMeshTransform &transform, bool normals = true);
     TriangleMeshPtrs split() const;
     void merge(const TriangleMesh* mesh);
     void horizontal_projection(ExPolygons &retval) const;
@@ -47,6 +50,99 @@ class TriangleMesh
     private:
     void require_shared_vertices();
     friend class TriangleMeshSlicer;
+    friend class IndexedTriangleSet;
+};
+
+/* Affine 3D transformation stored as a 3x4 matrix (linear part followed by
+   translation). scale(), translate() and rotate_z() append an operation, so
+   they apply in the order they were called. apply() transforms vertex
+   arrays with SSE/AVX when the compiler targets them, and returns the
+   bounding box of the result computed in the same pass. */
+class TriangleMeshTransform
+{
+    public:
+    double matrix[3][4];
+    
+    TriangleMeshTransform();
+    void scale(double x, double y, double z);
+    void translate(double x, double y, double z);
+    void rotate_z(double angle);
+    double determinant() const;
+    void apply(float* x, float* y, float* z, size_t count, BoundingBoxf3* bb = NULL) const;
+    void apply(stl_vertex* vertices, size_t count, BoundingBoxf3* bb = NULL) const;
+    void apply(stl_facet* facets, size_t count, bool normals, BoundingBoxf3* bb = NULL) const;
+    
+    private:
+    void append(const double m[3][4]);
+};
+
+/* Compact indexed copy of a mesh: shared vertex coordinates are stored as
+   three separate arrays and each facet as three vertex indices. Normals are
+   not stored but computed on demand. This takes 12 bytes per vertex and 12
+   per facet instead of the 50 bytes of an stl_facet plus the admesh
+   shared-vertex tables, and lets transforms run over contiguous arrays. */
+class IndexedTriangleSet
+{
+    public:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<int> indices;   // vertex indices, three per facet
+    
+    IndexedTriangleSet() {};
+    IndexedTriangleSet(TriangleMesh* mesh);
+    size_t facets_count() const;
+    size_t vertices_count() const;
+    void scale(double factor);
+    void translate(float x, float y, float z);
+    void rotate_z(double angle);
+    void transform(const TriangleMeshTransform &transform, BoundingBoxf3* bb = NULL);
+    void facet_z_range(size_t facet_idx, float* min_z, float* max_z) const;
+    void facet_normal(size_t facet_idx, stl_normal* normal) const;
+    void bounding_box(BoundingBoxf3* bb) const;
+};
+
+/* The placement of a mesh copy: rotation around Z (in degrees) and
+   scaling around origin, followed by translation (in unscaled coordinates). */
+class TriangleMeshInstance
+{
+    public:
+    double rotation;
+    double scaling_factor;
+    Pointf offset;
+    TriangleMeshInstance(double _rotation = 0, double _scaling_factor = 1, Pointf _offset = Pointf())
+        : rotation(_rotation), scaling_factor(_scaling_factor), offset(_offset) {};
+    void transform(Polygon* polygon) const;
+    void transform(ExPolygon* expolygon) const;
+};
+
+/* Answers bounding box, convex hull and projection queries about the copies
+   of one or more meshes without transforming or merging their facets: the
+   convex hull, Z extents and (optionally) horizontal projection of the raw
+   meshes are computed once, and each copy only transforms those. */
+class TriangleMeshView
+{
+    public:
+    std::vector<TriangleMeshInstance> instances;
+    
+    TriangleMeshView(bool _with_projection = false);
+    void add_mesh(TriangleMesh* mesh);
+    void add_instance(const TriangleMeshInstance &instance);
+    void clear_instances();
+    void raw_convex_hull(Polygon* hull) const;
+    void raw_bounding_box(BoundingBoxf3* bb) const;
+    void instance_convex_hull(size_t instance_idx, Polygon* hull) const;
+    void instance_bounding_box(size_t instance_idx, BoundingBoxf3* bb) const;
+    void instance_projection(size_t instance_idx, ExPolygons* projection) const;
+    void convex_hull(Polygon* hull) const;
+    void bounding_box(BoundingBoxf3* bb) const;
+    
+    private:
+    bool with_projection;
+    bool empty;
+    Polygon hull;               // scaled convex hull of the raw meshes
+    coordf_t min_z, max_z;      // unscaled Z extents of the raw meshes
+    ExPolygons projection;      // scaled horizontal projection of the raw meshes
 };
 
 enum FacetEdgeType { feNone, feTop, feBottom, feHorizontal };
@@ -80,16 +176,14 @@ class TriangleMeshSlicer
     public:
     TriangleMesh* mesh;
     TriangleMeshSlicer(TriangleMesh* _mesh);
-    ~TriangleMeshSlicer();
     void slice(const std::vector<float> &z, std::vector<Polygons>* layers);
     void slice(const std::vector<float> &z, std::vector<ExPolygons>* layers);
-    void slice_facet(float slice_z, const stl_facet &facet, const int &facet_idx, const float &min_z, const float &max_z, std::vector<IntersectionLine>* lines) const;
+    void slice_facet(float slice_z, const int &facet_idx, const float &min_z, const float &max_z, std::vector<IntersectionLine>* lines) const;
     void cut(float z, TriangleMesh* upper, TriangleMesh* lower);
     
     private:
-    typedef std::vector< std::vector<int> > t_facets_edges;
-    t_facets_edges facets_edges;
-    stl_vertex* v_scaled_shared;
+    std::vector<int> facets_edges;  // edge indices, three per facet
+    IndexedTriangleSet its;         // scaled copy of the mesh
     void make_loops(std::vector<IntersectionLine> &lines, Polygons* loops);
     void make_expolygons(const Polygons &loops, ExPolygons* slices);
     void make_expolygons(std::vector<IntersectionLine> &lines, ExPolygons* slices);
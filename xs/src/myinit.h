@@ -36,4 +36,15 @@ using namespace Slic3r;
 void confess_at(const char *file, int line, const char *func, const char *pat, ...);
 /* End implementation of CONFESS("foo"): */
 
+#ifdef SLIC3RXS
+namespace Slic3r {
+/* Copies the items of a Perl handle to a native collection (like
+   Slic3r::Polygon::Collection) straight into a vector, without building a Perl
+   value for each item. Overloaded next to the item types that have such
+   collections; returns false for any other value. */
+template <class T>
+bool from_SV_collection(SV* sv, T* items) { return false; }
+}
+#endif
+
 #endif
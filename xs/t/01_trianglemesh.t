@@ -3,8 +3,10 @@
 use strict;
 use warnings;
 
+use File::Temp qw(tempdir);
+use List::Util qw(max);
 use Slic3r::XS;
-use Test::More tests => 46;
+use Test::More tests => 60;
 
 is Slic3r::TriangleMesh::hello_world(), 'Hello world!',
     'hello world';
@@ -55,6 +57,23 @@ my $cube = {
     $m->rotate(45, Slic3r::Point->new(20,20));
     ok abs($m->size->[0] - sqrt(2)*40) < 1E-4, 'rotate';
     
+    {
+        my $m2 = Slic3r::TriangleMesh->new;
+        $m2->ReadFromPerl($cube->{vertices}, $cube->{facets});
+        $m2->repair;
+        my $m3 = $m2->clone;
+        $m2->rotate(30, Slic3r::Point->new(0,0));
+        $m2->scale(1.5);
+        $m2->translate(10,5,2);
+        $m3->transform(30, 1.5, 10, 5, 2);
+        my $max_diff = 0;
+        foreach my $i (0..$#{$m2->vertices}) {
+            $max_diff = max($max_diff, map abs($m2->vertices->[$i][$_] - $m3->vertices->[$i][$_]), 0..2);
+        }
+        ok $max_diff < 1E-4, 'transform is equivalent to rotate, scale and translate';
+        ok abs($m3->stats->{volume} - (1.5*20)**3) < 1E-2, 'transform updates volume';
+    }
+    
     {
         my $meshes = $m->split;
         is scalar(@$meshes), 1, 'split';
@@ -99,6 +118,23 @@ my $cube = {
     is $slices->[0][0]->area, $slices->[1][0]->area, 'slicing a tangent plane includes its area';
 }
 
+{
+    my $m = Slic3r::TriangleMesh->new;
+    $m->ReadFromPerl($cube->{vertices}, $cube->{facets});
+    $m->repair;
+    my $cache_dir = tempdir(CLEANUP => 1);
+    my $pp = sub { [ map [ map $_->pp, @$_ ], @{$_[0]} ] };
+    my $expected = $pp->($m->slice([ 2, 10, 18 ]));
+    is_deeply $pp->($m->slice([ 2, 10, 18 ], $cache_dir)), $expected, 'slicing with an empty cache';
+    my @entries = glob "$cache_dir/*.slices";
+    is scalar(@entries), 1, 'sliced layers are stored in the cache';
+    is_deeply $pp->($m->slice([ 2, 10, 18 ], $cache_dir)), $expected, 'layers loaded from the cache';
+    
+    $m->translate(1, 0, 0);
+    $m->slice([ 2, 10, 18 ], $cache_dir);
+    is scalar(@{[ glob "$cache_dir/*.slices" ]}), 2, 'a different mesh gets its own cache entry';
+}
+
 {
     my $m = Slic3r::TriangleMesh->new;
     $m->ReadFromPerl($cube->{vertices}, $cube->{facets});
@@ -121,4 +157,32 @@ my $cube = {
     }
 }
 
+{
+    my $m = Slic3r::TriangleMesh->new;
+    $m->ReadFromPerl($cube->{vertices}, $cube->{facets});
+    $m->repair;
+    my $view = Slic3r::TriangleMesh::View->new(1);
+    $view->add_mesh($m);
+    $view->add_instance(90, 2, 100, 50);
+    $view->add_instance(0, 1, 0, 0);
+    is $view->instances_count, 2, 'view instances_count';
+    
+    my $m2 = $m->clone;
+    $m2->rotate(90, Slic3r::Point->new(0,0));
+    $m2->scale(2);
+    $m2->translate(100, 50, 0);
+    my $extents = sub { my $bb = shift; [ map sprintf('%.4f', $bb->$_), qw(x_min y_min z_min x_max y_max z_max) ] };
+    is_deeply $extents->($view->instance_bounding_box(0)), $extents->($m2->bounding_box),
+        'view instance_bounding_box matches the transformed mesh';
+    is_deeply [ map $view->bounding_box->$_, qw(x_min y_min x_max y_max) ],
+        [ 0, 0, 100, 90 ], 'view bounding_box covers all instances';
+    ok abs($view->instance_convex_hull(0)->area - $m2->convex_hull->area) < 1, 'view instance_convex_hull';
+    is scalar(@{$view->instance_projection(1)}), 1, 'view instance_projection';
+    is_deeply $m->vertices, $cube->{vertices}, 'view does not alter the mesh';
+    is_deeply [ map $view->raw_bounding_box->$_, qw(x_min y_min z_min x_max y_max z_max) ],
+        [ 0, 0, 0, 20, 20, 20 ], 'view raw_bounding_box';
+    $view->clear_instances;
+    is $view->instances_count, 0, 'view clear_instances';
+}
+
 __END__
@@ -4,7 +4,7 @@ use strict;
 use warnings;
 
 use Slic3r::XS;
-use Test::More tests => 21;
+use Test::More tests => 24;
 
 use constant PI => 4 * atan2(1, 1);
 
@@ -42,6 +42,16 @@ isa_ok $expolygon->[0][0], 'Slic3r::Point::Ref', 'expolygon point is blessed';
 
 is_deeply $expolygon->clone->pp, [$square, $hole_in_square], 'clone';
 
+{
+    my $data = $expolygon->serialize;
+    is_deeply(Slic3r::ExPolygon->deserialize($data)->pp, [$square, $hole_in_square], 'serialize roundtrip');
+    ok !eval { Slic3r::ExPolygon->deserialize(substr $data, 0, -1) }, 'truncated serialized data is rejected';
+    
+    my $collection = Slic3r::ExPolygon::Collection->new($expolygon, $expolygon->clone);
+    is_deeply(Slic3r::ExPolygon::Collection->deserialize($collection->serialize)->pp, $collection->pp,
+        'serialize collection roundtrip');
+}
+
 is $expolygon->area, 100*100-20*20, 'area';
 
 {
@@ -4,7 +4,7 @@ use strict;
 use warnings;
 
 use Slic3r::XS;
-use Test::More tests => 15;
+use Test::More tests => 20;
 
 my $square = [  # ccw
     [100, 100],
@@ -38,6 +38,18 @@ is $surface->surface_type, Slic3r::Surface::S_TYPE_BOTTOM, 'modify surface_type'
 $surface->bridge_angle(30);
 is $surface->bridge_angle, 30, 'bridge_angle';
 
+{
+    my $surface2 = Slic3r::Surface->deserialize($surface->serialize);
+    is_deeply [ map $surface2->$_, qw(surface_type bridge_angle thickness thickness_layers extra_perimeters) ],
+        [ map $surface->$_, qw(surface_type bridge_angle thickness thickness_layers extra_perimeters) ],
+        'serialize roundtrip';
+    
+    my $collection = Slic3r::Surface::Collection->new($surface, $surface2);
+    my $collection2 = Slic3r::Surface::Collection->deserialize($collection->serialize);
+    is_deeply [ map $_->expolygon->pp, @$collection2 ], [ map $_->expolygon->pp, @$collection ],
+        'serialize collection roundtrip';
+}
+
 $surface->extra_perimeters(2);
 is $surface->extra_perimeters, 2, 'extra_perimeters';
 
@@ -73,4 +85,23 @@ is $surface->extra_perimeters, 2, 'extra_perimeters';
     is scalar(@{$collection->group}), 2, 'group() returns correct number of groups';
 }
 
+{
+    my $slice = Slic3r::ExPolygon->new([ [0,0], [10_000_000,0], [10_000_000,10_000_000], [0,10_000_000] ]);
+    my $half  = Slic3r::ExPolygon->new([ [0,0], [5_000_000,0], [5_000_000,10_000_000], [0,10_000_000] ]);
+    my $collection = Slic3r::Surface::Collection->new(
+        Slic3r::Surface->new(expolygon => $slice, surface_type => Slic3r::Surface::S_TYPE_INTERNAL),
+    );
+    $collection->detect_type(
+        Slic3r::ExPolygon::Collection->new($half),
+        Slic3r::ExPolygon::Collection->new($slice),
+        50_000,
+    );
+    is scalar(@{$collection->filter_by_type(Slic3r::Surface::S_TYPE_BOTTOM)}), 0, 'detect_type: no bottom surfaces';
+    is_deeply [ map $_->expolygon->area, @{$collection->filter_by_type(Slic3r::Surface::S_TYPE_TOP)} ],
+        [ $half->area ], 'detect_type: top surface';
+    
+    $collection->detect_type(undef, Slic3r::ExPolygon::Collection->new($half), 50_000);
+    is scalar(@$collection), 2, 'detect_type: no upper layer';
+}
+
 __END__
@@ -4,7 +4,7 @@ use strict;
 use warnings;
 
 use Slic3r::XS;
-use Test::More tests => 14;
+use Test::More tests => 16;
 
 my $points = [
     [100, 100],
@@ -43,6 +43,13 @@ isa_ok $collection->[3], 'Slic3r::ExtrusionLoop::Ref', 'correct object returned
 
 is scalar(@{$collection->[1]}), 1, 'appended collection was duplicated';
 
+{
+    my $collection2 = Slic3r::ExtrusionPath::Collection->deserialize($collection->serialize);
+    is_deeply [ map ref($_), @$collection2 ], [ map ref($_), @$collection ], 'serialize roundtrip';
+    is_deeply [ $collection2->[3]->role, $collection2->[3]->polygon->pp ],
+        [ $loop->role, $loop->polygon->pp ], 'serialize roundtrip preserves entities';
+}
+
 {
     my $collection_loop = $collection->[3];
     $collection_loop->polygon->scale(2);
@@ -4,7 +4,7 @@ use strict;
 use warnings;
 
 use Slic3r::XS;
-use Test::More tests => 91;
+use Test::More tests => 103;
 
 foreach my $config (Slic3r::Config->new, Slic3r::Config::Full->new) {
     $config->set('layer_height', 0.3);
@@ -128,4 +128,36 @@ foreach my $config (Slic3r::Config->new, Slic3r::Config::Full->new) {
     is $config->get('fill_pattern'), 'line', 'no interferences between DynamicConfig objects';
 }
 
+{
+    my $config = Slic3r::Config::Full->new;
+    $config->set('layer_height', 0.25);
+    $config->set('perimeters', 4);
+    $config->set('fill_pattern', 'concentric');
+    ok abs($config->layer_height - 0.25) < 1e-4, 'native accessor for float option';
+    is $config->perimeters, 4, 'native accessor for int option';
+    is $config->fill_pattern, 'concentric', 'native accessor for enum option';
+    is_deeply $config->nozzle_diameter, $config->get('nozzle_diameter'), 'native accessor for vector option';
+    ok !Slic3r::Config::PrintObject->can('perimeters'), 'no native accessor for options of other classes';
+}
+
+{
+    my $config = Slic3r::Config->new;
+    $config->set('layer_height', 0.123456789);
+    $config->set('fill_pattern', 'honeycomb');
+    my $config2 = Slic3r::Config::Full->new;
+    $config2->apply_dynamic($config);
+    is $config2->layer_height, 0.123456789, 'apply_dynamic preserves full float precision';
+    is $config2->fill_pattern, 'honeycomb', 'apply_dynamic converts generic enums';
+    
+    my $region = Slic3r::Config::PrintRegion->new;
+    my $region2 = Slic3r::Config::PrintRegion->new;
+    ok $region->equals($region2), 'equals';
+    $region2->set('perimeters', 7);
+    $region2->set('infill_every_layers', 3);
+    is_deeply $region->diff($region2), [qw(infill_every_layers perimeters)], 'diff returns sorted changed keys';
+    ok !$region->equals($region2), 'not equals';
+    is_deeply $config2->diff($config), [], 'diff between static and dynamic config';
+    is_deeply $region->diff($config), [], 'diff ignores keys missing from the other config';
+}
+
 __END__
@@ -0,0 +1,65 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 13;
+
+{
+    my $estimator = Slic3r::GCode::TimeEstimator->new;
+    $estimator->append("G1 X50 F2500\nG1 X100 E1 F3000\nG1 E4 F400");
+    ok abs($estimator->time - (50/2500*60 + 50/3000*60 + 3/400*60)) < 1e-6, 'time without acceleration';
+
+    $estimator->slow_down(0.5, 0);
+    ok abs($estimator->time - (50/2500*60 + 50/1500*60 + 3/400*60)) < 1e-6, 'time after slowdown';
+
+    my $gcode = $estimator->flush("", "");
+    is $gcode, "G1 X50 F2500\nG1 X100 E1 F1500.000\nG1 E4 F400", 'only extrusion moves are slowed down';
+    ok abs($estimator->total_time - (50/2500*60 + 50/1500*60 + 3/400*60)) < 1e-6, 'total time includes flushed G-code';
+    is $estimator->time, 0, 'buffer is empty after flush';
+}
+
+{
+    my $estimator = Slic3r::GCode::TimeEstimator->new;
+    $estimator->append("G1 X10 E1 F3000\n");
+    $estimator->slow_down(0.1, 600);
+    like $estimator->flush("", ""), qr/F600\.000/, 'slowdown does not go below the minimum feedrate';
+}
+
+{
+    my $estimator = Slic3r::GCode::TimeEstimator->new;
+    $estimator->append(";_BRIDGE_FAN_START\nG1 X10 E1 F3000\n;_BRIDGE_FAN_END\nG1 X20 E2 F3000 ;_WIPE\n");
+    $estimator->slow_down(0.5, 0);
+    my $gcode = $estimator->flush("M106 S255\n", "M107\n");
+    is $gcode, "M106 S255\nG1 X10 E1 F3000\nM107\nG1 X20 E2 F3000 \n", 'bridge and wipe moves are not slowed down, markers are replaced';
+}
+
+{
+    my $estimator = Slic3r::GCode::TimeEstimator->new;
+    $estimator->set_default_acceleration(1000);
+    $estimator->append("G1 X100 F6000\n");
+    ok $estimator->time > 100/100, 'acceleration makes moves slower';
+
+    $estimator->reset;
+    $estimator->append("M204 S1000000\nG1 X100 F6000\n");
+    ok abs($estimator->time - 1) < 1e-2, 'M204 overrides the default acceleration';
+}
+
+{
+    my $estimator = Slic3r::GCode::TimeEstimator->new;
+    $estimator->append("G4 P1500\nG1 X50 F3000\nG4 S2\n");
+    ok abs($estimator->time - (1.5 + 50/3000*60 + 2)) < 1e-6, 'dwells are included in time';
+    $estimator->slow_down(0.5, 0);
+    ok abs($estimator->time - (1.5 + 50/3000*60 + 2)) < 1e-6, 'dwells are not slowed down';
+}
+
+{
+    my $t = Slic3r::GCode::TimeEstimator::trapezoid_time(100, 0, 100, 0, 1000);
+    ok abs($t - (0.1 + 0.1 + 90/100)) < 1e-6, 'trapezoid time';
+
+    $t = Slic3r::GCode::TimeEstimator::trapezoid_time(10, 0, 100, 0, 1000);
+    ok abs($t - 2*sqrt(10/1000)) < 1e-6, 'triangle time';
+}
+
+__END__
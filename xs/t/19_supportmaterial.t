@@ -0,0 +1,60 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 13;
+
+my $square = Slic3r::Polygon->new([0,0], [10_000_000,0], [10_000_000,10_000_000], [0,10_000_000]);
+my $area = sub { my $a = 0; $a += $_->area for @{$_[0]}; $a };
+
+{
+    my $generator = Slic3r::Print::SupportMaterial::Generator->new([0.4, 0.8, 1.2], 2, 500_000, 500_000);
+    is $generator->layer_count, 3, 'layer_count';
+    $generator->set_contact(2, [$square]);
+    $generator->generate;
+    ok abs($area->($generator->interface(1)) - $square->area) < 1, 'contact is propagated to interface layer';
+    is scalar(@{$generator->interface(0)}), 0, 'interface does not exceed the number of interface layers';
+    is scalar(@{$generator->base(1)}), 0, 'no base below contact when interface layers are enough';
+    ok abs($area->($generator->base(0)) - $square->area) < 1, 'interface is propagated to base layer';
+}
+
+{
+    my $generator = Slic3r::Print::SupportMaterial::Generator->new([0.4, 0.8, 1.2], 1, 500_000, 500_000);
+    $generator->set_contact(2, [$square]);
+    my $object = Slic3r::Polygon->new([0,0], [5_000_000,0], [5_000_000,10_000_000], [0,10_000_000]);
+    $generator->add_object_layer(0.4, 0.4, [$object]);
+    $generator->generate;
+    ok abs($area->($generator->base(1)) - $square->area) < 1, 'contact is propagated to base with a single interface layer';
+    ok abs($area->($generator->base(0)) - 4_500_000 * 10_000_000) < 1, 'base is clipped with object';
+}
+
+{
+    my $lower = $square;
+    my $upper = Slic3r::Polygon->new([-1_000_000,-1_000_000], [11_000_000,-1_000_000], [11_000_000,11_000_000], [-1_000_000,11_000_000]);
+    my $detector = Slic3r::Print::SupportMaterial::ContactDetector->new(1_500_000, 500_000);
+    $detector->add_layer($_) for [$lower], [$lower], [$upper];
+    $detector->detect_footprint(0);
+    $detector->detect(1, [$lower], 500_000, 0, 0);
+    $detector->detect(2, [$upper], 500_000, 0, 0);
+    ok abs($area->($detector->contact(0)) - 13_000_000**2) < 1, 'footprint contact is grown by margin';
+    is scalar(@{$detector->contact(1)}), 0, 'no contact without overhangs';
+    ok abs($area->($detector->overhang(2)) - (11_500_000**2 - 10_000_000**2)) < 1, 'overhang detected';
+    ok $area->($detector->contact(2)) > $area->($detector->overhang(2)), 'contact area extends overhang';
+}
+
+{
+    my $lower = $square;
+    my $upper = Slic3r::Polygon->new([-1_000_000,-1_000_000], [11_000_000,-1_000_000], [11_000_000,11_000_000], [-1_000_000,11_000_000]);
+    my $detector = Slic3r::Print::SupportMaterial::ContactDetector->new(1_500_000, 500_000);
+    $detector->add_layer($_) for [$lower], [$lower], [$upper];
+    $detector->add_footprint(0);
+    $detector->add_region(1, [$lower], 500_000, 0, 0);
+    $detector->add_region(2, [$upper], 500_000, 0, 0);
+    $detector->detect_layers(Slic3r::ThreadPool->new(2));
+    ok abs($area->($detector->contact(0)) - 13_000_000**2) < 1, 'footprint taken on the thread pool';
+    ok abs($area->($detector->overhang(2)) - (11_500_000**2 - 10_000_000**2)) < 1, 'overhang detected on the thread pool';
+}
+
+__END__
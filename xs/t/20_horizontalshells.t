@@ -0,0 +1,51 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 4;
+
+my $square = Slic3r::ExPolygon->new([ [0,0], [10_000_000,0], [10_000_000,10_000_000], [0,10_000_000] ]);
+
+my $make_layers = sub {
+    my @types = @_;
+    return map {
+        my $type = $_;
+        [ map Slic3r::Surface::Collection->new(
+            Slic3r::Surface->new(expolygon => $square, surface_type => $type),
+        ), 1..2 ];  # [ slices, fill_surfaces ]
+    } @types;
+};
+
+{
+    my @layers = $make_layers->(
+        Slic3r::Surface::S_TYPE_INTERNAL,
+        Slic3r::Surface::S_TYPE_INTERNAL,
+        Slic3r::Surface::S_TYPE_TOP,
+    );
+    my $shells = Slic3r::Print::Object::HorizontalShells->new(2, 0, 0, 0);
+    $shells->add_layer(@$_, 500_000, 500_000) for @layers;
+    is $shells->layer_count, 3, 'layer_count';
+    $shells->process;
+    
+    is_deeply [ map $_->surface_type, @{$layers[1][1]} ], [ Slic3r::Surface::S_TYPE_INTERNALSOLID ],
+        'top surface is propagated to the layer below';
+    is_deeply [ map $_->surface_type, @{$layers[0][1]} ], [ Slic3r::Surface::S_TYPE_INTERNAL ],
+        'top surface is not propagated beyond top_solid_layers';
+}
+
+{
+    my @layers = $make_layers->(
+        Slic3r::Surface::S_TYPE_INTERNAL,
+        Slic3r::Surface::S_TYPE_INTERNAL,
+    );
+    my $shells = Slic3r::Print::Object::HorizontalShells->new(0, 0, 2, 0);
+    $shells->add_layer(@$_, 500_000, 500_000) for @layers;
+    $shells->process;
+    is_deeply [ map { $_->[1][0]->surface_type } @layers ],
+        [ Slic3r::Surface::S_TYPE_INTERNALSOLID, Slic3r::Surface::S_TYPE_INTERNAL ],
+        'solid_infill_every_layers';
+}
+
+__END__
@@ -0,0 +1,39 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 5;
+
+use constant PI => 4 * atan2(1, 1);
+
+my $rect = sub {
+    my ($x1, $y1, $x2, $y2) = map $_ * 1_000_000, @_;
+    return Slic3r::ExPolygon->new([ [$x1,$y1], [$x2,$y1], [$x2,$y2], [$x1,$y2] ]);
+};
+my $bridge = $rect->(0, 0, 20, 10);
+
+{
+    my $lower = Slic3r::ExPolygon::Collection->new($rect->(-5, -5, 1, 15), $rect->(19, -5, 25, 15));
+    my $bd = Slic3r::BridgeDetector->new($bridge, $lower, 500_000, 500_000);
+    ok $bd->detect_angle, 'angle detected between two supports';
+    ok abs($bd->angle) < 1e-6, 'bridge runs between the two supports';
+}
+
+{
+    my $lower = Slic3r::ExPolygon::Collection->new(
+        $rect->(-5, -5, 25, 1), $rect->(-5, 9, 25, 15), $rect->(-5, 4, -0.1, 6),
+    );
+    my $bd = Slic3r::BridgeDetector->new($bridge, $lower, 500_000, 500_000);
+    ok $bd->detect_angle, 'angle detected with three supports';
+    ok abs($bd->angle - PI/2) < 1e-6, 'angle sweep prefers the most anchored direction';
+}
+
+{
+    my $lower = Slic3r::ExPolygon::Collection->new($rect->(30, 30, 40, 40));
+    my $bd = Slic3r::BridgeDetector->new($bridge, $lower, 500_000, 500_000);
+    ok !$bd->detect_angle, 'no angle without supports';
+}
+
+__END__
@@ -0,0 +1,34 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 5;
+
+my $rect = sub {
+    my ($x1, $y1, $x2, $y2) = map $_ * 1_000_000, @_;
+    return Slic3r::ExPolygon->new([ [$x1,$y1], [$x2,$y1], [$x2,$y2], [$x1,$y2] ]);
+};
+
+{
+    my $lower = Slic3r::Surface::Collection->new(
+        Slic3r::Surface->new(expolygon => $rect->(0, 0, 10, 10), surface_type => Slic3r::Surface::S_TYPE_INTERNAL),
+    );
+    my $upper = Slic3r::Surface::Collection->new(
+        Slic3r::Surface->new(expolygon => $rect->(0, 0, 20, 10), surface_type => Slic3r::Surface::S_TYPE_INTERNAL),
+        Slic3r::Surface->new(expolygon => $rect->(0, 0, 10, 10), surface_type => Slic3r::Surface::S_TYPE_TOP),
+    );
+    my $combiner = Slic3r::Print::Object::InfillCombiner->new(1000, 500_000);
+    $combiner->add_layer($lower, 0.2);
+    $combiner->add_layer($upper, 0.2);
+    is $combiner->layer_count, 2, 'layer_count';
+    ok $combiner->combine, 'infill combined';
+    
+    is scalar(@{$lower->filter_by_type(Slic3r::Surface::S_TYPE_INTERNAL)}), 0, 'combined infill removed from lower layer';
+    my ($thick) = grep $_->thickness_layers == 2, @{$upper->filter_by_type(Slic3r::Surface::S_TYPE_INTERNAL)};
+    ok $thick && abs($thick->thickness - 0.4) < 1e-6, 'combined infill applied to upper layer with adjusted depth';
+    is scalar(@{$upper->filter_by_type(Slic3r::Surface::S_TYPE_TOP)}), 1, 'other surface types are preserved';
+}
+
+__END__
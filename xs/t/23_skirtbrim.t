@@ -0,0 +1,37 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 5;
+
+my $square = Slic3r::ExPolygon->new([ [0,0], [10_000_000,0], [10_000_000,10_000_000], [0,10_000_000] ]);
+my @copies = (Slic3r::Point->new(0, 0), Slic3r::Point->new(20_000_000, 0));
+
+{
+    my $skirt_brim = Slic3r::Print::SkirtBrim->new;
+    my $skirt = Slic3r::ExtrusionPath::Collection->new;
+    ok !$skirt_brim->make_skirt($skirt, 1, 6_000_000, 500_000, 0.1, 0, []), 'no skirt without objects';
+    
+    $skirt_brim->add_skirt_slices(Slic3r::ExPolygon::Collection->new($square));
+    $skirt_brim->add_skirt_copies([ @copies ]);
+    $skirt_brim->make_skirt($skirt, 2, 6_000_000, 500_000, 0.1, 0, []);
+    is scalar(@$skirt), 2, 'number of skirt loops';
+    ok $skirt->[0]->polygon->length > $skirt->[1]->polygon->length, 'skirt loops are ordered from outside to inside';
+    
+    $skirt->clear;
+    $skirt_brim->make_skirt($skirt, 1, 6_000_000, 500_000, 0.1, 100, [0.1]);
+    ok scalar(@$skirt) > 1, 'min_skirt_length adds skirt loops';
+}
+
+{
+    my $skirt_brim = Slic3r::Print::SkirtBrim->new;
+    $skirt_brim->add_brim_slices(Slic3r::ExPolygon::Collection->new($square));
+    $skirt_brim->add_brim_copies([ @copies ]);
+    my $brim = Slic3r::ExtrusionPath::Collection->new;
+    $skirt_brim->make_brim($brim, 3, 500_000, 0.1);
+    is scalar(@$brim), 6, 'brim loops are generated around each copy';
+}
+
+__END__
@@ -0,0 +1,58 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 7;
+
+my $pool = Slic3r::ThreadPool->new(1);
+my $square = Slic3r::Polygon->new([0,0], [10_000_000,0], [10_000_000,10_000_000], [0,10_000_000]);
+
+{
+    my $arranger = Slic3r::Geometry::Arranger->new(2_000_000);
+    $arranger->add_part($square) for 1..4;
+    ok $arranger->arrange($pool), 'arrange';
+    is $arranger->part_count, 4, 'part_count';
+    
+    my @positions = map $arranger->position($_)->pp, 0..3;
+    is_deeply [ sort { $a->[0] <=> $b->[0] || $a->[1] <=> $b->[1] } @positions ],
+        [ [0,0], [0,12_000_000], [12_000_000,0], [12_000_000,12_000_000] ],
+        'parts are packed in a square keeping the requested distance';
+}
+
+{
+    my $arranger = Slic3r::Geometry::Arranger->new(2_000_000);
+    $arranger->set_bed(Slic3r::Geometry::BoundingBox->new_from_points(
+        [ Slic3r::Point->new(0,0), Slic3r::Point->new(25_000_000, 15_000_000) ],
+    ));
+    $arranger->add_part($square) for 1..2;
+    ok $arranger->arrange($pool), 'parts fit the bed';
+    $arranger->add_part($square);
+    ok !$arranger->arrange($pool), 'parts exceeding the bed are detected';
+}
+
+{
+    my $bar = Slic3r::Polygon->new([0,0], [30_000_000,0], [30_000_000,5_000_000], [0,5_000_000]);
+    my $arranger = Slic3r::Geometry::Arranger->new(0, 4);
+    $arranger->set_bed(Slic3r::Geometry::BoundingBox->new_from_points(
+        [ Slic3r::Point->new(0,0), Slic3r::Point->new(10_000_000, 40_000_000) ],
+    ));
+    $arranger->add_part($bar);
+    ok $arranger->arrange($pool) && abs($arranger->rotation(0) - 3.14159265/2) % 3.14159265 < 1e-6,
+        'parts are rotated to fit the bed';
+}
+
+{
+    my $triangle = Slic3r::Polygon->new([0,0], [10_000_000,0], [3_000_000,7_000_000]);
+    my $layout = sub {
+        my ($threads) = @_;
+        my $arranger = Slic3r::Geometry::Arranger->new(1_000_000, 4);
+        $arranger->add_part($_ % 2 ? $square : $triangle) for 1..12;
+        $arranger->arrange(Slic3r::ThreadPool->new($threads));
+        return [ map { [ @{$arranger->position($_)->pp}, $arranger->rotation($_) ] } 0..11 ];
+    };
+    is_deeply $layout->(4), $layout->(1), 'layout does not depend on the number of threads';
+}
+
+__END__
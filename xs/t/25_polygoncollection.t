@@ -0,0 +1,56 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 11;
+
+my $square = [  # ccw
+    [200, 100],
+    [200, 200],
+    [100, 200],
+    [100, 100],
+];
+my $hole_in_square = [  # cw
+    [160, 140],
+    [140, 140],
+    [140, 160],
+    [160, 160],
+];
+
+my $collection = Slic3r::Polygon::Collection->new($square, $hole_in_square);
+is $collection->count, 2, 'count';
+is_deeply $collection->pp, [ $square, $hole_in_square ], 'pp roundtrip';
+isa_ok $collection->[0], 'Slic3r::Polygon::Ref', 'collection items are returned by reference';
+
+{
+    my $offset = $collection->offset(5);
+    isa_ok $offset, 'Slic3r::Polygon::Collection', 'offset';
+    is_deeply $offset->pp, [ map $_->pp, @{Slic3r::Geometry::Clipper::offset([ $square, $hole_in_square ], 5)} ],
+        'offset matches the Clipper function';
+    is_deeply [ map $_->pp, @{Slic3r::Geometry::Clipper::offset($collection, 5)} ], $offset->pp,
+        'Clipper functions accept collections';
+}
+
+{
+    my $diff = $collection->offset(10)->diff_ex($collection);
+    isa_ok $diff, 'Slic3r::ExPolygon::Collection', 'diff_ex';
+    is_deeply [ map $_->pp, @$diff ],
+        [ map $_->pp, @{Slic3r::Geometry::Clipper::diff_ex(Slic3r::Geometry::Clipper::offset([ $square, $hole_in_square ], 10), [ $square, $hole_in_square ])} ],
+        'diff_ex matches the Clipper function';
+    is scalar(@{Slic3r::Polygon::Collection->new(@{$diff->[0]})->diff($diff)}), 0,
+        'ExPolygon collections are accepted as polygons';
+}
+
+{
+    my $contours = Slic3r::Polygon::Collection->new;
+    my $holes = Slic3r::Polygon::Collection->new;
+    $collection->split_by_orientation($contours, $holes);
+    is_deeply [ $contours->pp, $holes->pp ], [ [$square], [$hole_in_square] ], 'split_by_orientation';
+    
+    $contours->append($holes, $square);
+    is $contours->count, 3, 'append collection and polygon';
+}
+
+__END__
@@ -0,0 +1,77 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 13;
+
+my $square = [  # ccw
+    [100, 100],
+    [200, 100],
+    [200, 200],
+    [100, 200],
+];
+my $small_square = [  # ccw
+    [120, 120],
+    [180, 120],
+    [180, 180],
+    [120, 180],
+];
+
+my $object = Slic3r::Print::Object::Native->new;
+for my $i (0..2) {
+    my $layer = $object->add_layer($i, 0.4, 0.4*($i+1), 0.4*$i + 0.2);
+    my $layerm = $layer->add_region;
+    foreach my $collection ($layerm->slices, $layerm->fill_surfaces) {
+        $collection->append(Slic3r::Surface->new(
+            expolygon       => Slic3r::ExPolygon->new($i == 2 ? $small_square : $square),
+            surface_type    => Slic3r::Surface::S_TYPE_INTERNAL,
+        ));
+    }
+}
+is $object->layer_count, 3, 'add_layer';
+is $object->get_layer(1)->print_z, 0.8, 'layer attributes';
+isa_ok $object->get_layer(0)->slices, 'Slic3r::ExPolygon::Collection::Ref', 'slices';
+isa_ok $object->get_layer(0)->get_region(0)->slices, 'Slic3r::Surface::Collection::Ref', 'region slices';
+isa_ok $object->get_layer(0)->get_region(0)->perimeters, 'Slic3r::ExtrusionPath::Collection::Ref', 'perimeters';
+
+{
+    my $layer = $object->get_layer(0);
+    $layer->make_slices;
+    is_deeply [ map $_->area, @{$layer->slices} ], [ 100*100 ], 'make_slices';
+    
+    $layer->id(5);
+    is $object->get_layer(0)->id, 5, 'id is stored natively';
+    $layer->id(0);
+}
+
+{
+    $object->get_layer($_)->get_region(0)->backup_slices for 0..2;
+    
+    my $pool = Slic3r::ThreadPool->new(2);
+    $object->make_slices($pool);
+    $object->detect_surfaces_type(0, [ 1, 1, 1 ], $pool);
+    my @types = map { my $layerm = $object->get_layer($_)->get_region(0); [ sort map $_->surface_type, @{$layerm->fill_surfaces} ] } 0..2;
+    is_deeply $types[0], [ Slic3r::Surface::S_TYPE_BOTTOM ], 'bottom surface detected on the first layer';
+    is scalar(grep $_ == Slic3r::Surface::S_TYPE_TOP, @{$types[1]}), 1,
+        'top surface detected where the upper layer is smaller';
+    
+    my $layerm = $object->get_layer(1)->get_region(0);
+    $layerm->restore_slices;
+    is_deeply [ map [ $_->surface_type, $_->expolygon->area ], @{$layerm->slices} ],
+        [ [ Slic3r::Surface::S_TYPE_INTERNAL, 100*100 ] ], 'restore_slices';
+}
+
+{
+    $object->delete_layer(1);
+    is_deeply [ map $object->get_layer($_)->print_z, 0..1 ], [ 0.4, 1.2 ], 'delete_layer';
+}
+
+{
+    my $layer = $object->add_support_layer(0, 0.4, 0.4, -1);
+    isa_ok $layer->support_fills, 'Slic3r::ExtrusionPath::Collection::Ref', 'support_fills';
+    is $object->support_layer_count, 1, 'add_support_layer';
+}
+
+__END__
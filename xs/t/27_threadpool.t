@@ -0,0 +1,73 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 9;
+
+my $rect = sub {
+    my ($x1, $y1, $x2, $y2) = map $_ * 1_000_000, @_;
+    return Slic3r::ExPolygon->new([ [$x1,$y1], [$x2,$y1], [$x2,$y2], [$x1,$y2] ]);
+};
+
+is(Slic3r::ThreadPool->new(4)->size, 4, 'size');
+is(Slic3r::ThreadPool->new(0)->size, 1, 'at least the calling thread works');
+
+{
+    # many groups, so that threads steal from each other
+    my @groups = map {
+        my $lower = Slic3r::Surface::Collection->new(
+            Slic3r::Surface->new(expolygon => $rect->(0, 0, 10, 10), surface_type => Slic3r::Surface::S_TYPE_INTERNAL),
+        );
+        my $upper = Slic3r::Surface::Collection->new(
+            Slic3r::Surface->new(expolygon => $rect->(0, 0, 20, 10), surface_type => Slic3r::Surface::S_TYPE_INTERNAL),
+        );
+        [ $lower, $upper ];
+    } 1..50;
+    my @combiners = map {
+        my $combiner = Slic3r::Print::Object::InfillCombiner->new(1000, 500_000);
+        $combiner->add_layer($_, 0.2) for @$_;
+        $combiner;
+    } @groups;
+    
+    my $pool = Slic3r::ThreadPool->new(4);
+    is $pool->combine_infill(@combiners), 50, 'all groups combined';
+    is scalar(grep @{$_->[0]->filter_by_type(Slic3r::Surface::S_TYPE_INTERNAL)}, @groups), 0,
+        'combined infill removed from every lower layer';
+    is $pool->combine_infill, 0, 'empty batch';
+}
+
+{
+    my $slices = Slic3r::Surface::Collection->new(
+        Slic3r::Surface->new(expolygon => $rect->(0, 0, 10, 10), surface_type => Slic3r::Surface::S_TYPE_TOP),
+    );
+    my $fill_surfaces = Slic3r::Surface::Collection->new(
+        Slic3r::Surface->new(expolygon => $rect->(0, 0, 10, 10), surface_type => Slic3r::Surface::S_TYPE_TOP),
+    );
+    my $lower_slices = Slic3r::Surface::Collection->new(
+        Slic3r::Surface->new(expolygon => $rect->(0, 0, 10, 10), surface_type => Slic3r::Surface::S_TYPE_INTERNAL),
+    );
+    my $lower_fill_surfaces = Slic3r::Surface::Collection->new(
+        Slic3r::Surface->new(expolygon => $rect->(0, 0, 10, 10), surface_type => Slic3r::Surface::S_TYPE_INTERNAL),
+    );
+    my $shells = Slic3r::Print::Object::HorizontalShells->new(2, 0, 0, 0);
+    $shells->add_layer($lower_slices, $lower_fill_surfaces, 500_000, 500_000);
+    $shells->add_layer($slices, $fill_surfaces, 500_000, 500_000);
+    Slic3r::ThreadPool->new(2)->process_horizontal_shells($shells);
+    is scalar(@{$lower_fill_surfaces->filter_by_type(Slic3r::Surface::S_TYPE_INTERNALSOLID)}), 1,
+        'shells propagated';
+}
+
+{
+    my $bridge = $rect->(0, 0, 20, 10);
+    my @detectors = map Slic3r::BridgeDetector->new($bridge, $_, 500_000, 500_000),
+        Slic3r::ExPolygon::Collection->new($rect->(-5, -5, 1, 15), $rect->(19, -5, 25, 15)),
+        Slic3r::ExPolygon::Collection->new($rect->(30, 30, 40, 40));
+    my $angles = Slic3r::ThreadPool->new(2)->detect_bridge_angles(@detectors);
+    ok abs($angles->[0]) < 1e-6, 'bridge angle detected';
+    ok !defined $angles->[1], 'undef when no angle is detected';
+    is_deeply(Slic3r::ThreadPool->new(2)->detect_bridge_angles, [], 'no detectors');
+}
+
+__END__
@@ -0,0 +1,61 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 8;
+
+my $square = [  # ccw
+    [100, 100],
+    [200, 100],
+    [200, 200],
+    [100, 200],
+];
+my $hole = [  # cw
+    [120, 120],
+    [120, 180],
+    [180, 180],
+    [180, 120],
+];
+
+{
+    my $before = Slic3r::Profiler::Sample->new;
+    my $x = 0;
+    $x += sqrt($_) for 1..200_000;
+    my $after = Slic3r::Profiler::Sample->new;
+    ok $after->wall_time > $before->wall_time, 'wall time';
+    ok $after->cpu_time >= $before->cpu_time, 'cpu time';
+    ok $after->peak_rss >= $before->peak_rss, 'peak rss never decreases';
+}
+
+{
+    my $path = Slic3r::ExtrusionPath->new(
+        polyline => Slic3r::Polyline->new(@$square),
+        role     => Slic3r::ExtrusionPath::EXTR_ROLE_FILL,
+        mm3_per_mm => 1,
+    );
+    my $object = Slic3r::Print::Object::Native->new;
+    for my $i (0..1) {
+        my $layerm = $object->add_layer($i, 0.4, 0.4*($i+1), 0.4*$i + 0.2)->add_region;
+        $layerm->slices->append(Slic3r::Surface->new(
+            expolygon       => Slic3r::ExPolygon->new($square, $hole),
+            surface_type    => Slic3r::Surface::S_TYPE_INTERNAL,
+        ));
+        $layerm->fills->append(Slic3r::ExtrusionPath::Collection->new($path, $path));
+        $layerm->perimeters->append($path);
+    }
+    $object->add_support_layer(0, 0.4, 0.4, 0.2)->support_fills->append($path);
+    
+    my $counts = Slic3r::Profiler::Counts->new;
+    $counts->add_object($object);
+    is $counts->layers, 3, 'layers and support layers';
+    is $counts->polygons, 4, 'contours and holes';
+    is $counts->points, 16, 'points';
+    is $counts->paths, 7, 'paths in nested collections';
+    
+    $counts->add_collection(Slic3r::ExtrusionPath::Collection->new($path));
+    is $counts->paths, 8, 'collection';
+}
+
+__END__
@@ -0,0 +1,57 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 6;
+
+my $l_shape = [  # ccw, concave at 100,100
+    [0, 0],
+    [200, 0],
+    [200, 100],
+    [100, 100],
+    [100, 200],
+    [0, 200],
+];
+
+my $object = Slic3r::Print::Object::Native->new;
+for my $i (0..1) {
+    my $layer = $object->add_layer($i, 0.4, 0.4*($i+1), 0.4*$i + 0.2);
+    my $layerm = $layer->add_region;
+    # first layer loop is clockwise, as extrude_loop() gets holes
+    $layerm->perimeters->append(Slic3r::ExtrusionLoop->new(
+        polygon     => Slic3r::Polygon->new($i == 0 ? reverse @$l_shape : @$l_shape),
+        role        => Slic3r::ExtrusionPath::EXTR_ROLE_EXTERNAL_PERIMETER,
+        mm3_per_mm  => 1,
+    ));
+    # the right side of the second layer is an overhang
+    $layerm->slices->append(Slic3r::Surface->new(
+        expolygon       => Slic3r::ExPolygon->new([ [150,-50], [250,-50], [250,150], [150,150] ]),
+        surface_type    => Slic3r::Surface::S_TYPE_BOTTOM,
+    )) if $i == 1;
+}
+my @loops = map $object->get_layer($_)->get_region(0)->perimeters->[0], 0..1;
+my $pool = Slic3r::ThreadPool->new(2);
+
+my $candidates = sub {
+    my ($concave_points, $non_overhang, $loop) = @_;
+    my $seams = Slic3r::GCode::Seams->new($concave_points, $non_overhang);
+    $seams->add_layer($object->get_layer($_)) for 0..1;
+    $seams->process($pool);
+    my $points = $seams->candidates($loop);
+    return $points ? [ map $_->pp, @$points ] : undef;
+};
+
+is_deeply $candidates->(1, 0, $loops[0]), [ [100, 100] ], 'concave point of a clockwise loop';
+is_deeply $candidates->(0, 0, $loops[0]), $l_shape, 'all points when no option is set';
+is_deeply $candidates->(0, 1, $loops[1]), [ @$l_shape[0,3,4,5] ], 'overhanging points are skipped';
+is_deeply $candidates->(1, 1, $loops[1]), [ [100, 100] ], 'overhanging concave point is kept if it is the only one';
+is_deeply $candidates->(0, 1, $loops[0]), $l_shape, 'first layer has no overhangs';
+
+{
+    my $loop = $loops[0]->clone;
+    is $candidates->(1, 1, $loop), undef, 'no candidates for loops not in the batch';
+}
+
+__END__
@@ -0,0 +1,67 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Slic3r::XS;
+use Test::More tests => 7;
+
+my $rect = sub {
+    my ($x1, $y1, $x2, $y2) = map $_ * 1_000_000, @_;
+    return Slic3r::ExPolygon->new([ [$x1,$y1], [$x2,$y1], [$x2,$y2], [$x1,$y2] ]);
+};
+
+# two pillars on the first layer, bridged by the second one
+my $make_object = sub {
+    my $object = Slic3r::Print::Object::Native->new;
+    for my $i (0..3) {
+        my $layer = $object->add_layer($i, 0.4, 0.4*($i+1), 0.4*$i + 0.2);
+        my $layerm = $layer->add_region;
+        my @expolygons = $i == 0 ? ($rect->(0, 0, 4, 10), $rect->(16, 0, 20, 10)) : ($rect->(0, 0, 20, 10));
+        foreach my $collection ($layerm->slices, $layerm->fill_surfaces) {
+            $collection->append(map Slic3r::Surface->new(
+                expolygon       => $_,
+                surface_type    => Slic3r::Surface::S_TYPE_INTERNAL,
+            ), @expolygons);
+        }
+        $layer->make_slices;
+    }
+    return $object;
+};
+
+my $prepare = sub {
+    my ($threads, %params) = @_;
+    my $object = $make_object->();
+    my $preparer = Slic3r::Print::Object::InfillPreparer->new(1_000_000);
+    $preparer->add_region($params{top_solid_layers} // 1, 2, 0, 1, 0);
+    $preparer->add_layer(0, $object->get_layer($_)->get_region(0), 500_000, 500_000, 500_000) for 0..3;
+    $preparer->process(Slic3r::ThreadPool->new($threads));
+    
+    # [ type, area, bridge angle ] of the fill surfaces of each layer
+    return [ map {
+        my $layerm = $object->get_layer($_)->get_region(0);
+        [ sort { $a->[0] <=> $b->[0] || $a->[1] <=> $b->[1] }
+            map [ $_->surface_type, $_->expolygon->area, $_->bridge_angle ], @{$layerm->fill_surfaces} ];
+    } 0..3 ];
+};
+
+my $surfaces = $prepare->(1);
+my @types = map [ map $_->[0], @$_ ], @$surfaces;
+is_deeply $types[0], [ (Slic3r::Surface::S_TYPE_BOTTOM) x 2 ], 'pillars are bottom surfaces';
+is_deeply [ map $_->[2], grep $_->[0] == Slic3r::Surface::S_TYPE_BOTTOM, @{$surfaces->[1]} ], [ 90 ],
+    'bridge angle detected across the pillars';
+ok scalar(grep $_ == Slic3r::Surface::S_TYPE_INTERNALSOLID, @{$types[2]}), 'bottom shell propagated';
+is_deeply $types[3], [ Slic3r::Surface::S_TYPE_TOP ], 'top surface';
+
+is_deeply $prepare->(3), $surfaces, 'same surfaces when the graph runs on several threads';
+is scalar(grep $_->[0] == Slic3r::Surface::S_TYPE_TOP, map @$_, @{$prepare->(3, top_solid_layers => 0)}), 0,
+    'no top surfaces without top solid layers';
+
+{
+    my $preparer = Slic3r::Print::Object::InfillPreparer->new(1_000_000);
+    my $object = $make_object->();
+    eval { $preparer->add_layer(0, $object->get_layer(0)->get_region(0), 1, 1, 1) };
+    like $@, qr/no such region/, 'layers can only be added to existing regions';
+}
+
+__END__